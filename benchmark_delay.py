@@ -106,6 +106,9 @@ def main(num_tests=5):
             initial_telemetry = crsf.get_telemetry()
             initial_value = initial_telemetry['channels'][0] if initial_telemetry.get('channels') and len(initial_telemetry['channels']) > 0 else None
             
+            # Счётчик обновлений до отправки: публикации после него не будут пропущены
+            counter = crsf.get_update_counter()
+            
             # Засекаем время отправки
             send_time = time.time()
             
@@ -115,21 +118,25 @@ def main(num_tests=5):
             
             print(f"    Время отправки: {send_time:.6f} сек")
             
-            # Ждем появления значения в телеметрии
+            # Ждем появления значения в телеметрии: блокирующее ожидание публикации
+            # (futex в сегменте), без опроса с паузами
             max_wait_time = 1.0  # Максимальное время ожидания 1 секунда
-            check_interval = 0.001  # Проверяем каждую миллисекунду
+            deadline = time.monotonic() + max_wait_time
             receive_time = None
-            iterations = 0
-            max_iterations = int(max_wait_time / check_interval)
             current_value = None
             
-            while iterations < max_iterations:
+            while True:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    break
+                new_counter = crsf.wait_for_update(timeout=remaining, since=counter)
+                if new_counter is None:
+                    break
+                counter = new_counter
                 telemetry = crsf.get_telemetry()
                 
                 # Проверяем, что список каналов не пустой
                 if not telemetry.get('channels') or len(telemetry['channels']) == 0:
-                    time.sleep(check_interval)
-                    iterations += 1
                     continue
                 
                 current_value = telemetry['channels'][0]
@@ -137,9 +144,6 @@ def main(num_tests=5):
                 if current_value == test_value:
                     receive_time = time.time()
                     break
-                
-                time.sleep(check_interval)
-                iterations += 1
             
             if receive_time:
                 delay = (receive_time - send_time) * 1000  # Конвертируем в миллисекунды
@@ -181,12 +185,23 @@ def main(num_tests=5):
             
             print("\n  Примечание:")
             print("    Задержка включает:")
-            print("    - Запись команды в файл /tmp/crsf_command.txt")
-            print("    - Чтение файла основным приложением")
+            print("    - Постановку команды в кольцо команд /dev/shm/crsf_commands")
+            print("    - Выборку кольца главным циклом")
             print("    - Установку канала в CrsfSerial")
             print("    - Отправку пакета каналов (если включено)")
-            print("    - Запись телеметрии в файл /tmp/crsf_telemetry.dat")
-            print("    - Чтение файла Python оберткой")
+            print("    - Публикацию телеметрии в разделяемой памяти /dev/shm/crsf_telemetry")
+            print("    - Чтение снимка Python оберткой")
+
+            # Разбивка внутри crsf_io_rpi: команда -> write() в UART
+            lat = crsf.get_telemetry().get('latency', {})
+            if lat.get('samples'):
+                print("\n  Задержка внутри crsf_io_rpi (перцентили по всем командам):")
+                print(f"    Команда -> UART:   p50 {lat['totalP50Us'] / 1000:.2f} мс, "
+                      f"p90 {lat['totalP90Us'] / 1000:.2f} мс, p99 {lat['totalP99Us'] / 1000:.2f} мс, "
+                      f"max {lat['totalMaxUs'] / 1000:.2f} мс")
+                print(f"    Кольцо команд:     p50 {lat['ipcP50Us'] / 1000:.2f} мс, p99 {lat['ipcP99Us'] / 1000:.2f} мс")
+                print(f"    Ожидание тика:     p50 {lat['queueP50Us'] / 1000:.2f} мс, p99 {lat['queueP99Us'] / 1000:.2f} мс")
+                print(f"    Кадр + write():    p50 {lat['writeP50Us'] / 1000:.2f} мс, p99 {lat['writeP99Us'] / 1000:.2f} мс")
         else:
             print("\n  ✗ Бенчмарк не выполнен: ни один тест не завершился успешно")
         
@@ -7,6 +7,76 @@
 
 #define CRSF_BAUD 420000     // скорость CRSF
 
+// Период отправки RC-каналов в микросекундах (1000..20000, т.е. 1000..50 Гц).
+// Должен совпадать с частотой пакетов радиолинка: ELRS 250 Гц = 4000, 500 Гц = 2000.
+// Переопределяется при запуске: --rc-rate <Гц> или --rc-period-us <мкс>
+#define CRSF_RC_PERIOD_US 10000
+
+// Реалтайм-профиль главного цикла (RX/TX). Включается при запуске:
+// --rt-priority <1..99> (SCHED_FIFO), --rt-cpu <n> (привязка к CPU), --mlock (mlockall)
+#define CRSF_RT_STACK_PREFAULT (256 * 1024)       // байт стека, затрагиваемых заранее
+#define CRSF_RT_HEAP_RESERVE (4 * 1024 * 1024)    // байт кучи, удерживаемых после mlockall
+
+// Сегмент разделяемой памяти со снимком телеметрии (shm_open, /dev/shm/crsf_telemetry).
+// Снимок публикуется на каждый разобранный кадр, статистика — раз в CRSF_TELEMETRY_STATS_MS
+#define CRSF_TELEMETRY_SHM_NAME "/crsf_telemetry"
+#define CRSF_TELEMETRY_STATS_MS 20
+
+// История телеметрии (/dev/shm/crsf_telemetry_history): снимок на каждый разобранный кадр.
+// Размер — степень двойки; 1024 записи — несколько секунд при полном потоке телеметрии
+#define CRSF_TELEMETRY_HISTORY_SHM_NAME "/crsf_telemetry_history"
+#define CRSF_TELEMETRY_HISTORY_SIZE 1024u
+
+// Метрики стека CRSF (/dev/shm/crsf_metrics) для /metrics веб-сервера телеметрии:
+// счётчики разбора, очереди, планировщик и гистограммы задержки, обновляются раз в CRSF_METRICS_MS
+#define CRSF_METRICS_SHM_NAME "/crsf_metrics"
+#define CRSF_METRICS_MS 1000
+
+// Кольцо команд в разделяемой памяти (/dev/shm/crsf_commands): setChannel/setChannels/send/mode.
+// Размер — степень двойки; при полном кольце писатель получает отказ
+#define CRSF_COMMAND_SHM_NAME "/crsf_commands"
+#define CRSF_COMMAND_RING_SIZE 256u
+// Группа процессов-писателей команд под другими пользователями (права 0660), "" — только
+// владелец (0600)
+#define CRSF_COMMAND_GROUP ""
+
+// Веб-сервер телеметрии (telemetry_server.cpp): подсистема crsf_io_rpi на своём потоке с epoll,
+// keep-alive. Читает только сегменты телеметрии, команды отправляет через кольцо команд.
+// Порт переопределяется при запуске: --http-port <порт>, 0 — сервер выключен.
+// Соединения сверх лимита получают 503.
+// Управляющие запросы (/api/command, /api/channels) без аутентификации, поэтому сервер слушает
+// только loopback; --http-bind <адрес> (например 0.0.0.0) открывает его в сеть — тогда
+// управлять аппаратом может любой, кто достучится до порта. Тот же адрес у UDP-сокета
+#define TELEMETRY_SERVER_PORT 8081
+#define TELEMETRY_SERVER_BIND "127.0.0.1"
+#define TELEMETRY_SERVER_UPDATE_MS 50
+// История /api/telemetry/history: агрегаты (min/max/avg) по корзинам TELEMETRY_PYRAMID_BASE_MS,
+// каждый следующий уровень крупнее в TELEMETRY_PYRAMID_FACTOR раз, у уровня — CAPACITY корзин.
+// 100 мс x 4^n, 600 корзин: 1 мин, 4 мин, 16 мин, 64 мин, 4.3 ч
+#define TELEMETRY_PYRAMID_BASE_MS 100
+#define TELEMETRY_PYRAMID_FACTOR 4
+#define TELEMETRY_PYRAMID_LEVELS 5
+#define TELEMETRY_PYRAMID_CAPACITY 600
+#define TELEMETRY_SERVER_MAX_CONNECTIONS 64
+// Лимит частоты запросов на соединение (token bucket): запросов в секунду и запас для всплеска.
+// Сверх лимита — 429 с Retry-After. 0 — без ограничения. Страница опрашивает раз в
+// TELEMETRY_SERVER_UPDATE_MS, лимит с запасом выше
+#define TELEMETRY_SERVER_RATE_LIMIT 100
+#define TELEMETRY_SERVER_RATE_BURST 200
+// Медленный клиент: выходной буфер больше MAX_OUTPUT или запись без продвижения дольше
+// WRITE_TIMEOUT_MS — соединение закрывается
+#define TELEMETRY_SERVER_MAX_OUTPUT 2097152
+#define TELEMETRY_SERVER_WRITE_TIMEOUT_MS 10000
+// UDP порт бинарной телеметрии веб-сервера (запрос — датаграмма, ответ — пакет снимка), 0 — выключен.
+// Включается явно и слушает адрес веб-сервера: ответ не длиннее запроса, чтобы порт
+// нельзя было использовать для усиления трафика с подменой адреса
+#define TELEMETRY_UDP_PORT 0
+
+// Рассылка телеметрии по UDP из crsf_io_rpi: датаграмма на каждый кадр (пакет telemetry_wire).
+// Адресаты задаются при запуске: --udp <адрес:порт> (unicast или multicast, можно несколько).
+// TTL multicast-датаграмм: 1 — только локальная сеть, --udp-ttl <n> переопределяет
+#define TELEMETRY_FANOUT_TTL 1
+
 // Пути к последовательным портам Raspberry Pi для CRSF
 // Обычно: "/dev/ttyAMA0" (PL011) и "/dev/ttyS0" (miniUART)
 #define CRSF_PORT_PRIMARY "/dev/ttyAMA0"
@@ -11,6 +11,17 @@ static CrsfSerial crsf_1(crsfPort1, CRSF_BAUD);
 static CrsfSerial crsf_2(crsfPort2, CRSF_BAUD);
 static CrsfSerial *crsf = &crsf_1;
 
+// Ограничение выборки за один вызов loop_ch(): 64 * 32 байта с запасом
+// покрывают 20 мс (50 Гц) потока на 420000 бод
+static const int CRSF_RX_DRAIN_CHUNKS = 64;
+
+// Трассировка задержки: время приёма и отметка клиента последней команды
+// по каждому каналу, ещё не ушедшей в UART (0 — команды не было). Трассируются только
+// команды с отметкой (кольцо команд): внутренние записи каналов не искажают перцентили
+static CrsfLatencyTrace latencyTrace;
+static uint64_t channelIngestNs[CRSF_NUM_CHANNELS];
+static uint64_t channelOriginNs[CRSF_NUM_CHANNELS];
+
 //БЕСПОЛЕЗНО: функция вызывается, но ничего не делает (LED закомментирован)
 /*static void crsfLinkUp()
 {
@@ -29,13 +40,61 @@ static void crsfLinkDown()
 }
 
 void crsfSetChannel(unsigned int ch, int value)
+{
+  crsfSetChannelStamped(ch, value, 0);
+}
+
+void crsfSetChannelStamped(unsigned int ch, int value, uint64_t originNs)
 {
   crsf->setChannel(ch, value); // Используем указатель на активный порт
+  if (ch >= 1 && ch <= CRSF_NUM_CHANNELS) {
+    // Значение, перезаписанное до отправки, в UART не попадёт — учитываем последнюю команду;
+    // запись без отметки отменяет измерение ожидающей команды
+    channelIngestNs[ch - 1] = originNs != 0 ? rpi_nanos() : 0;
+    channelOriginNs[ch - 1] = originNs;
+  }
 }
 
 void crsfSendChannels()
 {
+  uint64_t buildNs = rpi_nanos();
   crsf->packetChannelsSend(); // Используем указатель на активный порт
+  uint64_t writtenNs = rpi_nanos();
+
+  latencyTrace.write.record(writtenNs - buildNs);
+  for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+    uint64_t ingestNs = channelIngestNs[i];
+    if (ingestNs == 0) continue;
+    uint64_t originNs = channelOriginNs[i];
+    // Отметка клиента из будущего (другие часы) не учитывается
+    if (originNs <= ingestNs) {
+      latencyTrace.ipc.record(ingestNs - originNs);
+    } else {
+      originNs = ingestNs;
+    }
+    latencyTrace.queue.record(buildNs - ingestNs);
+    latencyTrace.total.record(writtenNs - originNs);
+    channelIngestNs[i] = 0;
+  }
+}
+
+void crsfSetFrameHandler(void (*handler)(const crsf_header_t* frame))
+{
+  crsf_1.onFrameDecoded = handler;
+  crsf_2.onFrameDecoded = handler;
+}
+
+const CrsfLatencyTrace& crsfGetLatencyTrace()
+{
+  return latencyTrace;
+}
+
+void crsfResetLatencyTrace()
+{
+  latencyTrace.ipc.reset();
+  latencyTrace.queue.reset();
+  latencyTrace.write.reset();
+  latencyTrace.total.reset();
 }
 
 // Экспортируем как extern "C" для загрузки через ctypes
@@ -44,15 +103,26 @@ extern "C" void* crsfGetActive()
   return (void*)crsf; // Возвращаем указатель на активный CRSF объект
 }
 
+bool crsfTakeOpenTxSync(uint32_t& intervalNs, int32_t& offsetNs)
+{
+  static uint32_t lastSyncCount = 0;
+  uint32_t count = crsf->getSyncCount();
+  if (count == lastSyncCount) return false;
+  lastSyncCount = count;
+  intervalNs = crsf->getSyncIntervalNs();
+  offsetNs = crsf->getSyncOffsetNs();
+  return true;
+}
+
 void loop_ch()
 {
   
    // ОТКЛЮЧЕНО: ПЕРЕКЛЮЧЕНИЕ ПОРТОВ
   // Если от полетника не было НИКАКИХ данных более 30 секунд (30000 мс)
-  // И если связь вообще когда-либо была (_lastReceive != 0)
+  // И если связь вообще когда-либо была (getLastReceiveNs() != 0)
   // И прошло не менее 5 секунд с последнего переключения (стабилизация)
   /*
-  if ((crsf->_lastReceive != 0) && (newTime - crsf->_lastReceive > 30000) && 
+  if ((crsf->getLastReceiveNs() != 0) && (rpi_nanos() - crsf->getLastReceiveNs() > 30000000000ull) && 
       (newTime - lastPortSwitchTime > 5000))
   {
       lastPortSwitchTime = newTime; // Запоминаем время переключения
@@ -67,8 +137,11 @@ void loop_ch()
   }
   */
 
-  // Вызываем обработчик текущего активного порта
-  crsf->loop();
+  // Вызываем обработчик текущего активного порта и выбираем всё,
+  // что накопилось в UART с прошлого тика планировщика
+  for (int i = 0; i < CRSF_RX_DRAIN_CHUNKS; ++i) {
+    if (crsf->loop() < CrsfSerial::CRSF_RX_CHUNK) break;
+  }
 }
 
 void crsfInitRecv()
@@ -102,7 +175,15 @@ void crsfInitRecv() {}
 void crsfInitSend() {}
 void loop_ch() {}
 void crsfSetChannel(unsigned int ch, int value) {}
+void crsfSetChannelStamped(unsigned int ch, int value, uint64_t originNs) {}
 void crsfSendChannels() {}
 void crsfTelemetrySend() {}
+bool crsfTakeOpenTxSync(uint32_t&, int32_t&) { return false; }
+
+void crsfSetFrameHandler(void (*handler)(const crsf_header_t* frame)) {}
+
+static CrsfLatencyTrace latencyTrace;
+const CrsfLatencyTrace& crsfGetLatencyTrace() { return latencyTrace; }
+void crsfResetLatencyTrace() {}
 
 #endif
@@ -4,14 +4,36 @@
 #include <cstdint>
 #include "../libs/rpi_hal.h"
 #include "../libs/SerialPort.h"
+#include "../libs/latency_histogram.h"
+#include "../libs/crsf/crsf_protocol.h"
 #include "../config.h"
 
+// Трассировка задержки команд каналов до записи RC-кадра в UART.
+// Команда с отметкой клиента rpi_nanos() получает ещё время приёма, измерение снимается,
+// когда кадр с её значением ушёл в write(). Записи без отметки не трассируются
+struct CrsfLatencyTrace {
+    LatencyHistogram ipc;    // отметка клиента -> приём командой основного цикла
+    LatencyHistogram queue;  // приём команды -> начало формирования RC-кадра
+    LatencyHistogram write;  // формирование кадра и write() в UART, одно измерение на кадр
+    LatencyHistogram total;  // отметка клиента (или приём, если часы разошлись) -> write() вернул управление
+};
+
 void crsfInitRecv();
 void crsfInitSend();
 void loop_ch();
 void crsfSetChannel(unsigned int ch, int value);
+// То же с отметкой времени клиента originNs (шкала rpi_nanos()). Задержка до UART измеряется
+// только для записей с отметкой; 0 — внутренняя запись, в гистограммы не попадает
+void crsfSetChannelStamped(unsigned int ch, int value, uint64_t originNs);
 void crsfSendChannels();
 void crsfTelemetrySend();
+// Забрать новый кадр синхронизации OPENTX_SYNC активного порта (true — если пришёл с прошлого вызова)
+bool crsfTakeOpenTxSync(uint32_t& intervalNs, int32_t& offsetNs);
+// Обработчик каждого разобранного кадра обоих портов (вызывается из loop_ch())
+void crsfSetFrameHandler(void (*handler)(const crsf_header_t* frame));
+// Гистограммы задержки команд (пишет главный цикл, читать можно из потока телеметрии)
+const CrsfLatencyTrace& crsfGetLatencyTrace();
+void crsfResetLatencyTrace();
 
 // Получить указатель на активный CRSF объект
 // Экспортируется как extern "C" для загрузки через ctypes
@@ -0,0 +1,286 @@
+#include "crsf_engine.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <csignal>
+#include <unistd.h>
+#include "crsf.h"
+#include "../libs/telemetry_shm.h"
+#include "../libs/telemetry_snapshot.h"
+#include "../libs/telemetry_history.h"
+#include "../libs/crsf_metrics.h"
+#include "../libs/crsf/CrsfSerial.h"
+
+// Режим работы задаётся командой CRSF_CMD_SET_MODE (по умолчанию ручной).
+// Пишет только поток движка, читать можно из любого потока
+static std::atomic<CrsfWorkMode> workMode(CRSF_MODE_MANUAL);
+static void (*tickHandler)() = nullptr;
+
+// Кольцо команд в разделяемой памяти (пишут Python обертка и другие процессы)
+static CommandRing commandRing;
+static uint64_t commandsApplied = 0;
+
+// Выполнить одну команду из кольца (значения проверяются здесь: писателям не доверяем)
+static void applyCommand(const CrsfCommand& cmd)
+{
+  switch (cmd.type) {
+  case CRSF_CMD_SET_CHANNEL:
+    if (cmd.channel >= 1 && cmd.channel <= 16 && cmd.value >= 1000 && cmd.value <= 2000) {
+      crsfSetChannelStamped(cmd.channel, cmd.value, cmd.originNs);
+    }
+    break;
+  case CRSF_CMD_SET_CHANNELS:
+    for (unsigned int i = 0; i < 16; i++) {
+      if ((cmd.mask & (1u << i)) && cmd.values[i] >= 1000 && cmd.values[i] <= 2000) {
+        crsfSetChannelStamped(i + 1, cmd.values[i], cmd.originNs);
+      }
+    }
+    break;
+  case CRSF_CMD_SEND:
+    crsfSendChannels();
+    break;
+  case CRSF_CMD_SET_MODE:
+    if (cmd.value == CRSF_MODE_MANUAL || cmd.value == CRSF_MODE_JOYSTICK) {
+      workMode.store(static_cast<CrsfWorkMode>(cmd.value), std::memory_order_relaxed);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// Выбрать команды, накопившиеся с прошлого тика (не больше ёмкости кольца за раз).
+// Возвращает количество выполненных команд
+static uint32_t drainCommands()
+{
+  CrsfCommand cmd;
+  uint32_t n = 0;
+  while (n < CRSF_COMMAND_RING_SIZE && commandRing.pop(cmd)) {
+    applyCommand(cmd);
+    commandRing.markApplied(cmd.seq);
+    n++;
+  }
+  commandsApplied += n;
+  return n;
+}
+
+static TelemetryShm telemetryShm;
+// История: снимок на каждый кадр для читателей, которым нужны все кадры, а не последний
+static TelemetryHistory telemetryHistory;
+// Снимок телеметрии в разделяемой памяти CRSF_TELEMETRY_SHM_NAME (схема — libs/telemetry_snapshot.h)
+static TelemetrySnapshot telemetrySnapshot;
+static const RcScheduler* telemetryScheduler = nullptr;
+static uint64_t telemetryStatsNs = 0;  // время последнего обновления статистики в снимке
+
+// Данные, меняющиеся с каждым кадром от полётника, и режим работы главного цикла
+static void fillFrameTelemetry(TelemetrySnapshot& shared)
+{
+  shared.workMode = static_cast<uint8_t>(workMode.load(std::memory_order_relaxed));
+  CrsfSerial* crsf = static_cast<CrsfSerial*>(crsfGetActive());
+  if (crsf == nullptr) return;
+  telemetryFillFrame(shared, *crsf);
+}
+
+// Статистика планировщика и задержек: считается дольше, обновляется раз в CRSF_TELEMETRY_STATS_MS
+static void fillStatsTelemetry(TelemetrySnapshot& shared)
+{
+  if (telemetryScheduler) {
+    const RcSchedulerStats& rcStats = telemetryScheduler->getStats();
+    shared.rcPeriodUs = telemetryScheduler->getPeriodUs();
+    shared.rcTicks = rcStats.ticks;
+    shared.rcOverruns = rcStats.overruns;
+    shared.rcJitterAvgUs = rcStats.ticks ? static_cast<uint32_t>(rcStats.jitterSumNs / rcStats.ticks / 1000u) : 0;
+    shared.rcJitterMaxUs = static_cast<uint32_t>(rcStats.jitterMaxNs / 1000);
+    shared.rcSyncActive = rcStats.syncActive ? 1 : 0;
+    shared.rcSyncOffsetUs = static_cast<int32_t>(rcStats.syncOffsetNs / 1000);
+  }
+
+  // Задержка команд до записи в UART
+  const CrsfLatencyTrace& lat = crsfGetLatencyTrace();
+  auto pctUs = [](const LatencyHistogram& h, double p) {
+    return static_cast<uint32_t>(h.percentileNs(p) / 1000u);
+  };
+  shared.latSamples = lat.total.count();
+  shared.latTotalP50Us = pctUs(lat.total, 50.0);
+  shared.latTotalP90Us = pctUs(lat.total, 90.0);
+  shared.latTotalP99Us = pctUs(lat.total, 99.0);
+  shared.latTotalMaxUs = static_cast<uint32_t>(lat.total.maxNs() / 1000u);
+  shared.latIpcP50Us = pctUs(lat.ipc, 50.0);
+  shared.latIpcP99Us = pctUs(lat.ipc, 99.0);
+  shared.latQueueP50Us = pctUs(lat.queue, 50.0);
+  shared.latQueueP99Us = pctUs(lat.queue, 99.0);
+  shared.latWriteP50Us = pctUs(lat.write, 50.0);
+  shared.latWriteP99Us = pctUs(lat.write, 99.0);
+}
+
+// Метрики для /metrics: публикуются редко (раз в CRSF_METRICS_MS), считаются здесь же
+static TelemetryShm metricsShm;
+static CrsfMetrics metrics;
+static LatencyHistogram rcJitter;  // опоздание каждого тика планировщика
+static uint64_t metricsNs = 0;
+
+static void fillMetricsHistogram(CrsfMetricsHistogram& out, const LatencyHistogram& h)
+{
+  uint64_t boundsNs[CRSF_METRICS_BUCKETS];
+  for (unsigned i = 0; i < CRSF_METRICS_BUCKETS; ++i) boundsNs[i] = CRSF_METRICS_BOUNDS_US[i] * 1000ull;
+  h.cumulativeCounts(boundsNs, CRSF_METRICS_BUCKETS, out.cumulative);
+  out.count = h.count();
+  out.sumNs = h.sumNs();
+}
+
+static void publishMetrics(uint64_t nowNs)
+{
+  if (!metricsShm.isOpen() || nowNs - metricsNs < CRSF_METRICS_MS * 1000000ull) return;
+  metricsNs = nowNs;
+
+  CrsfSerial* crsf = static_cast<CrsfSerial*>(crsfGetActive());
+  if (crsf) {
+    const CrsfParserStats& parser = crsf->getParserStats();
+    metrics.rxBytes = parser.bytes;
+    metrics.rxFrames = parser.frames;
+    metrics.crcErrors = parser.crcErrors;
+    metrics.resyncs = parser.resyncs;
+    for (unsigned t = 0; t < 256; ++t) metrics.framesByType[t] = parser.framesByType[t];
+    metrics.txQueueBytes = crsf->getTxQueueBytes();
+  } else {
+    metrics.txQueueBytes = -1;
+  }
+  metrics.commandQueueDepth = commandRing.depth();
+  metrics.commandsApplied = commandsApplied;
+  metrics.commandsRejected = commandRing.rejected();
+
+  if (telemetryScheduler) {
+    const RcSchedulerStats& rcStats = telemetryScheduler->getStats();
+    metrics.rcPeriodUs = telemetryScheduler->getPeriodUs();
+    metrics.rcTicks = rcStats.ticks;
+    metrics.rcOverruns = rcStats.overruns;
+  }
+  fillMetricsHistogram(metrics.rcJitter, rcJitter);
+
+  const CrsfLatencyTrace& lat = crsfGetLatencyTrace();
+  fillMetricsHistogram(metrics.latIpc, lat.ipc);
+  fillMetricsHistogram(metrics.latQueue, lat.queue);
+  fillMetricsHistogram(metrics.latWrite, lat.write);
+  fillMetricsHistogram(metrics.latTotal, lat.total);
+
+  metricsShm.publish(&metrics, 0, nowNs);
+}
+
+// Публикация на каждый разобранный кадр (вызывается из loop_ch() главного цикла)
+static void onTelemetryFrame(const crsf_header_t* frame)
+{
+  fillFrameTelemetry(telemetrySnapshot);
+  uint64_t nowNs = rpi_nanos();
+  telemetryHistory.append(telemetrySnapshot, frame->type, nowNs);
+  telemetryShm.publish(&telemetrySnapshot, frame->type, nowNs);
+}
+
+// Периодическая публикация: статистика и состояние связи при отсутствии кадров
+static void publishTelemetryStats(uint64_t nowNs)
+{
+  if (nowNs - telemetryStatsNs < CRSF_TELEMETRY_STATS_MS * 1000000ull) return;
+  telemetryStatsNs = nowNs;
+  fillFrameTelemetry(telemetrySnapshot);
+  fillStatsTelemetry(telemetrySnapshot);
+  telemetryShm.publish(&telemetrySnapshot, 0, nowNs);
+}
+
+// Публикация сразу после выполнения команд: ждущие клиенты видят новые каналы без
+// задержки до следующего кадра или периодической публикации
+static void publishTelemetryCommands(uint64_t nowNs)
+{
+  fillFrameTelemetry(telemetrySnapshot);
+  telemetryShm.publish(&telemetrySnapshot, 0, nowNs);
+}
+
+void crsfEngineInit(RcScheduler& scheduler)
+{
+  // Кольцо команд: создаётся заново при каждом запуске, старые команды не выполняются
+  if (commandRing.create(CRSF_COMMAND_SHM_NAME, CRSF_COMMAND_RING_SIZE, CRSF_COMMAND_GROUP)) {
+    printf("✓ Кольцо команд в разделяемой памяти %s (%u слотов)\n", CRSF_COMMAND_SHM_NAME, CRSF_COMMAND_RING_SIZE);
+  } else {
+    printf("Предупреждение: не удалось создать кольцо команд %s\n", CRSF_COMMAND_SHM_NAME);
+  }
+
+  // Снимок телеметрии в разделяемой памяти: публикуется на каждый разобранный кадр
+  // и раз в CRSF_TELEMETRY_STATS_MS для статистики
+  telemetryScheduler = &scheduler;
+  if (telemetryHistory.create(CRSF_TELEMETRY_HISTORY_SHM_NAME, CRSF_TELEMETRY_HISTORY_SIZE)) {
+    printf("✓ История телеметрии %s (%u кадров)\n", CRSF_TELEMETRY_HISTORY_SHM_NAME, CRSF_TELEMETRY_HISTORY_SIZE);
+  } else {
+    printf("Предупреждение: не удалось создать историю телеметрии %s\n", CRSF_TELEMETRY_HISTORY_SHM_NAME);
+  }
+  if (telemetryShm.create(CRSF_TELEMETRY_SHM_NAME, sizeof(TelemetrySnapshot), TELEMETRY_SCHEMA_HASH)) {
+    crsfSetFrameHandler(&onTelemetryFrame);
+    printf("✓ Телеметрия публикуется в разделяемой памяти %s\n", CRSF_TELEMETRY_SHM_NAME);
+  } else {
+    printf("Предупреждение: не удалось создать сегмент телеметрии %s\n", CRSF_TELEMETRY_SHM_NAME);
+  }
+  if (!metricsShm.create(CRSF_METRICS_SHM_NAME, sizeof(CrsfMetrics), CRSF_METRICS_VERSION)) {
+    printf("Предупреждение: не удалось создать сегмент метрик %s\n", CRSF_METRICS_SHM_NAME);
+  }
+}
+
+void crsfEngineTick(RcScheduler& scheduler)
+{
+  int64_t lateNs = scheduler.getStats().jitterLastNs;
+  rcJitter.record(lateNs > 0 ? static_cast<uint64_t>(lateNs) : 0);
+
+#if USE_CRSF_RECV == true
+  loop_ch();
+
+  // Фазовая подстройка под слоты RF по кадрам OPENTX_SYNC от TX-модуля
+  uint32_t syncIntervalNs;
+  int32_t syncOffsetNs;
+  if (crsfTakeOpenTxSync(syncIntervalNs, syncOffsetNs)) {
+    scheduler.applySync(syncIntervalNs, syncOffsetNs, rpi_nanos());
+  }
+#else
+  (void)scheduler;
+#endif
+
+  publishTelemetryStats(rpi_nanos());
+  publishMetrics(rpi_nanos());
+
+  // Команды от Python обертки: кольцо в разделяемой памяти, без системных вызовов
+  if (drainCommands() > 0) {
+    publishTelemetryCommands(rpi_nanos());
+  }
+
+#if USE_CRSF_SEND == true
+  if (tickHandler) tickHandler();
+
+  // Отправляем RC-каналы на каждом тике планировщика
+  crsfSendChannels();
+#endif
+}
+
+void crsfEngineRun(RcScheduler& scheduler, const std::atomic<bool>& stop)
+{
+  // Один проход на тик планировщика (абсолютные дедлайны)
+  scheduler.start();
+  while (!stop.load(std::memory_order_relaxed)) {
+    scheduler.waitNext();
+    crsfEngineTick(scheduler);
+  }
+}
+
+void crsfEngineSetTickHandler(void (*handler)())
+{
+  tickHandler = handler;
+}
+
+CrsfWorkMode crsfEngineWorkMode()
+{
+  return workMode.load(std::memory_order_relaxed);
+}
+
+bool crsfEngineOwnedElsewhere()
+{
+  CommandRing ring;
+  if (!ring.open(CRSF_COMMAND_SHM_NAME)) return false;
+  pid_t pid = static_cast<pid_t>(ring.readerPid());
+  if (pid <= 0 || pid == getpid()) return false;
+  // kill(pid, 0): процесс существует (EPERM — существует, но под другим пользователем)
+  return kill(pid, 0) == 0 || errno == EPERM;
+}
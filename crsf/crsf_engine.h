@@ -0,0 +1,29 @@
+#ifndef CRSF_CRSF_ENGINE_H
+#define CRSF_CRSF_ENGINE_H
+
+#include <atomic>
+#include "../libs/rc_scheduler.h"
+#include "../libs/command_ring.h"
+
+// Движок CRSF: приём кадров, команды из кольца, публикация телеметрии и отправка RC-кадров
+// на каждом тике RcScheduler. Работает в главном цикле crsf_io_rpi или на отдельном
+// потоке внутри модуля crsf_native (Python без отдельного процесса).
+// Порты открываются заранее через crsfInitRecv()/crsfInitSend()
+
+// Создать кольцо команд, снимок и историю телеметрии в разделяемой памяти и подключить
+// публикацию кадров. Статистика scheduler попадает в снимок
+void crsfEngineInit(RcScheduler& scheduler);
+// Один тик: приём, подстройка по OPENTX_SYNC, команды, публикация, обработчик тика, отправка RC
+void crsfEngineTick(RcScheduler& scheduler);
+// Цикл на вызывающем потоке: scheduler.start(), затем waitNext() и тик, пока stop == false
+void crsfEngineRun(RcScheduler& scheduler, const std::atomic<bool>& stop);
+
+// Обработчик перед отправкой RC-кадра (в crsf_io_rpi — оси джойстика)
+void crsfEngineSetTickHandler(void (*handler)());
+// Режим работы, заданный командой CRSF_CMD_SET_MODE (по умолчанию ручной)
+CrsfWorkMode crsfEngineWorkMode();
+
+// Кольцом команд владеет другой живой процесс (например, уже запущен crsf_io_rpi)
+bool crsfEngineOwnedElsewhere();
+
+#endif
@@ -576,19 +576,31 @@ class CRSFRealtimeInterface:
             messagebox.showerror("Ошибка", f"Ошибка установки режима: {e}")
     
     def data_update_worker(self):
-        """Поток обновления данных"""
+        """Поток обновления данных: ждёт публикации телеметрии, а не опрашивает по таймеру"""
+        counter = None
         while self.is_running:
+            started = time.monotonic()
             try:
                 if self.crsf.is_initialized:
+                    # Блокируется до нового снимка (GIL отпущен); таймаут — чтобы заметить остановку
+                    # и показать потерю связи, если основное приложение перестало публиковать
+                    new_counter = self.crsf.wait_for_update(timeout=0.5, since=counter)
+                    if new_counter is not None:
+                        counter = new_counter
                     data = self.crsf.get_telemetry()
                     self.data_queue.put(data)
                 else:
                     self.data_queue.put(None)  # Ошибка
+                    time.sleep(self.update_interval / 1000.0)
             except Exception as e:
                 print(f"Ошибка получения данных: {e}")
                 self.data_queue.put(None)
+                time.sleep(self.update_interval / 1000.0)
             
-            time.sleep(self.update_interval / 1000.0)
+            # Интерфейсу не нужна частота кадров CRSF: не чаще update_interval
+            remaining = self.update_interval / 1000.0 - (time.monotonic() - started)
+            if remaining > 0:
+                time.sleep(remaining)
     
     def start_data_update(self):
         """Запуск обновления интерфейса"""
@@ -185,11 +185,11 @@ def main():
         crsf.set_channel(4, 1750)
         print("    ✓ CH4 = 1750")
         
-        # Отправляем каналы (команды записываются в файл)
-        # Основное приложение читает файл /tmp/crsf_command.txt и обрабатывает команды
+        # Отправляем каналы (команды ставятся в кольцо команд в разделяемой памяти)
+        # Основное приложение выбирает кольцо /dev/shm/crsf_commands на каждом тике
         print("\n  Отправляем каналы...")
         crsf.send_channels()
-        print("  ✓ Команды отправлены (записаны в файл)")
+        print("  ✓ Команды отправлены (поставлены в кольцо команд)")
         
         # Подождем, чтобы основное приложение успело обработать команды
         # Основное приложение обрабатывает команды в главном цикле (~10 мс)
@@ -22,9 +22,7 @@ bool SerialPort::open() {
         return false; // не удалось открыть устройство
     }
 
-    // Сбрасываем флаг O_NONBLOCK после открытия
-    int flags = fcntl(_fd, F_GETFL, 0);
-    if (flags >= 0) fcntl(_fd, F_SETFL, flags & ~O_NONBLOCK);
+    // O_NONBLOCK оставляем: темп цикла задаёт RcScheduler, чтение не должно ждать данных
 
     if (!configureTermios2(_baud)) {
         close();
@@ -54,9 +52,9 @@ bool SerialPort::configureTermios2(uint32_t baud) {
     tio2.c_ispeed = baud;
     tio2.c_ospeed = baud;
 
-    // Минимум один байт, таймаут ~10мс
+    // Без ожидания: read() сразу возвращает то, что уже есть в буфере драйвера
     tio2.c_cc[VMIN] = 0;
-    tio2.c_cc[VTIME] = 1;
+    tio2.c_cc[VTIME] = 0;
 
     if (ioctl(_fd, TCSETS2, &tio2) < 0) return false;
 
@@ -92,4 +90,10 @@ void SerialPort::flush() {
     ioctl(_fd, TCFLSH, TCIOFLUSH);
 }
 
+int SerialPort::outputQueueBytes() const {
+    int bytes = 0;
+    if (_fd < 0 || ioctl(_fd, TIOCOUTQ, &bytes) < 0) return -1;
+    return bytes;
+}
+
 
@@ -17,12 +17,14 @@ public:
     virtual bool open();
     virtual void close();
 
-    // Неблокирующее чтение/запись (по умолчанию блокирующее с таймаутами через termios)
+    // Неблокирующее чтение/запись (порт открыт с O_NONBLOCK, VMIN=0/VTIME=0)
     virtual int readByte(uint8_t &b);
     virtual int write(const uint8_t *buf, size_t len);
     virtual int writeByte(uint8_t b);
 
     virtual void flush();
+    // Байт в выходной очереди драйвера (ioctl TIOCOUTQ), -1 — порт закрыт или ошибка
+    int outputQueueBytes() const;
 
 private:
     std::string _path;
@@ -0,0 +1,95 @@
+#include "channel_command.h"
+
+#include <cstring>
+
+static bool validChannel(uint32_t value)
+{
+    return value >= CHANNEL_COMMAND_MIN_US && value <= CHANNEL_COMMAND_MAX_US;
+}
+
+bool channelCommandParseBinary(const void* data, size_t len, CrsfCommand* cmd)
+{
+    if (len == 0 || len % 2 != 0 || len > 32) return false;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    CrsfCommand out = {};
+    out.type = CRSF_CMD_SET_CHANNELS;
+    for (size_t i = 0; i < len / 2; ++i) {
+        uint16_t value = static_cast<uint16_t>(p[2 * i] | (p[2 * i + 1] << 8));
+        if (value == 0) continue;
+        if (!validChannel(value)) return false;
+        out.mask |= static_cast<uint16_t>(1u << i);
+        out.values[i] = value;
+    }
+    if (out.mask == 0) return false;
+    *cmd = out;
+    return true;
+}
+
+// Курсор разбора JSON: пробелы пропускаются перед каждой лексемой
+struct JsonCursor {
+    const char* p;
+    const char* end;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    }
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+    bool consumeWord(const char* word) {
+        skipSpace();
+        size_t n = strlen(word);
+        if (static_cast<size_t>(end - p) < n || memcmp(p, word, n) != 0) return false;
+        p += n;
+        return true;
+    }
+    // Целое без знака, дробной части и ведущих нулей, не длиннее 5 цифр
+    bool number(uint32_t* out) {
+        skipSpace();
+        if (p >= end || *p < '1' || *p > '9') return false;
+        uint32_t v = 0;
+        int digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (++digits > 5) return false;
+            v = v * 10 + static_cast<uint32_t>(*p - '0');
+            ++p;
+        }
+        if (p < end && (*p == '.' || *p == 'e' || *p == 'E')) return false;
+        *out = v;
+        return true;
+    }
+};
+
+bool channelCommandParseJson(const char* data, size_t len, CrsfCommand* cmd)
+{
+    JsonCursor json = {data, data + len};
+    if (!json.consume('{') || !json.consumeWord("\"channels\"") || !json.consume(':') || !json.consume('[')) {
+        return false;
+    }
+
+    CrsfCommand out = {};
+    out.type = CRSF_CMD_SET_CHANNELS;
+    if (!json.consume(']')) {
+        for (unsigned int i = 0;; ++i) {
+            if (i >= 16) return false;
+            if (!json.consumeWord("null")) {
+                uint32_t value = 0;
+                if (!json.number(&value) || !validChannel(value)) return false;
+                out.mask |= static_cast<uint16_t>(1u << i);
+                out.values[i] = static_cast<uint16_t>(value);
+            }
+            if (json.consume(']')) break;
+            if (!json.consume(',')) return false;
+        }
+    }
+    if (!json.consume('}')) return false;
+    json.skipSpace();
+    if (json.p != json.end || out.mask == 0) return false;
+    *cmd = out;
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Разбор тела запроса пакетной установки каналов (POST /api/channels веб-сервера телеметрии)
+// в одну команду CRSF_CMD_SET_CHANNELS: все каналы применяются главным циклом на одном тике.
+// Разбор строгий и без исключений: любое лишнее или неверное значение — отказ всего запроса,
+// частично команда не применяется.
+//   Бинарное тело: N значений uint16 little-endian (N = 1..16) для каналов 1..N, 0 — не менять
+//   JSON: {"channels":[1500,1500,null,...]} — до 16 значений, null — не менять
+// Значения каналов — CHANNEL_COMMAND_MIN_US..CHANNEL_COMMAND_MAX_US
+
+#include <cstddef>
+#include <cstdint>
+#include "command_ring.h"
+
+static constexpr uint16_t CHANNEL_COMMAND_MIN_US = 1000;
+static constexpr uint16_t CHANNEL_COMMAND_MAX_US = 2000;
+
+// false — неверная длина, значение вне диапазона или ни одного заданного канала
+bool channelCommandParseBinary(const void* data, size_t len, CrsfCommand* cmd);
+// false — не тот формат JSON, больше 16 значений, значение вне диапазона или все null
+bool channelCommandParseJson(const char* data, size_t len, CrsfCommand* cmd);
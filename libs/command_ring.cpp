@@ -0,0 +1,193 @@
+#include "command_ring.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <grp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Слоты лежат на отдельных кэш-линиях после заголовка
+static size_t slotsOffset()
+{
+    return (sizeof(CommandRingHeader) + 63u) & ~static_cast<size_t>(63u);
+}
+
+CommandRing::CommandRing()
+    : _base(nullptr), _size(0), _hdr(nullptr), _slots(nullptr), _mask(0)
+{
+}
+
+CommandRing::~CommandRing()
+{
+    close();
+}
+
+bool CommandRing::create(const char* name, uint32_t capacity, const char* group)
+{
+    close();
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return false;
+    bool shared = group && group[0] != '\0';
+    const struct group* gr = shared ? getgrnam(group) : nullptr;
+    if (shared && !gr) return false;
+
+    // Команды управляют каналами RC: писать может только владелец или заданная группа.
+    // Права выставляются явно и у сегмента, оставшегося от прошлого запуска
+    int fd = shm_open(name, O_CREAT | O_RDWR, shared ? 0660 : 0600);
+    if (fd < 0) return false;
+    if ((shared && fchown(fd, static_cast<uid_t>(-1), gr->gr_gid) < 0) || fchmod(fd, shared ? 0660 : 0600) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = slotsOffset() + static_cast<size_t>(capacity) * sizeof(CommandRingSlot);
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    _base = base;
+    _size = size;
+    _hdr = static_cast<CommandRingHeader*>(base);
+    _slots = reinterpret_cast<CommandRingSlot*>(static_cast<uint8_t*>(base) + slotsOffset());
+    _mask = capacity - 1;
+
+    // Команды, оставшиеся от прошлого запуска, не выполняем: кольцо начинается заново,
+    // но номера команд продолжаются, чтобы писатели не спутали старый appliedSeq с новым
+    _hdr->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t start = _hdr->enqueuePos.load(std::memory_order_relaxed);
+    for (uint64_t pos = start; pos < start + capacity; ++pos) {
+        CommandRingSlot& slot = _slots[pos & _mask];
+        memset(&slot.cmd, 0, sizeof(CrsfCommand));
+        slot.turn.store(pos, std::memory_order_relaxed);
+    }
+    _hdr->version = VERSION;
+    _hdr->slotSize = static_cast<uint16_t>(sizeof(CommandRingSlot));
+    _hdr->capacity = capacity;
+    _hdr->readerPid = static_cast<uint32_t>(getpid());
+    _hdr->dequeuePos.store(start, std::memory_order_relaxed);
+    _hdr->appliedSeq.store(start, std::memory_order_relaxed);
+    _hdr->rejected.store(0, std::memory_order_relaxed);
+    _hdr->enqueuePos.store(start, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _hdr->magic = MAGIC;
+    return true;
+}
+
+bool CommandRing::open(const char* name)
+{
+    close();
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(CommandRingHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    CommandRingHeader* hdr = static_cast<CommandRingHeader*>(base);
+    uint32_t capacity = hdr->capacity;
+    if (hdr->magic != MAGIC || hdr->version != VERSION || hdr->slotSize != sizeof(CommandRingSlot) ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        slotsOffset() + static_cast<size_t>(capacity) * sizeof(CommandRingSlot) > size) {
+        munmap(base, size);
+        return false;
+    }
+
+    _base = base;
+    _size = size;
+    _hdr = hdr;
+    _slots = reinterpret_cast<CommandRingSlot*>(static_cast<uint8_t*>(base) + slotsOffset());
+    _mask = capacity - 1;
+    return true;
+}
+
+void CommandRing::close()
+{
+    if (_base) {
+        munmap(_base, _size);
+    }
+    _base = nullptr;
+    _size = 0;
+    _hdr = nullptr;
+    _slots = nullptr;
+    _mask = 0;
+}
+
+int64_t CommandRing::push(const CrsfCommand& cmd)
+{
+    if (!_hdr) return -1;
+    uint64_t pos = _hdr->enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        CommandRingSlot& slot = _slots[pos & _mask];
+        uint64_t turn = slot.turn.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(turn - pos);
+        if (diff == 0) {
+            // Слот свободен для позиции pos: занимаем позицию
+            if (_hdr->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.cmd = cmd;
+                slot.cmd.seq = pos;
+                slot.turn.store(pos + 1, std::memory_order_release);
+                return static_cast<int64_t>(pos);
+            }
+            // pos обновлён compare_exchange_weak — пробуем снова
+        } else if (diff < 0) {
+            // Читатель ещё не освободил слот: кольцо полно
+            _hdr->rejected.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        } else {
+            pos = _hdr->enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool CommandRing::pop(CrsfCommand& cmd)
+{
+    if (!_hdr) return false;
+    uint64_t pos = _hdr->dequeuePos.load(std::memory_order_relaxed);
+    CommandRingSlot& slot = _slots[pos & _mask];
+    if (slot.turn.load(std::memory_order_acquire) != pos + 1) {
+        return false; // пусто (или писатель ещё заполняет слот)
+    }
+    cmd = slot.cmd;
+    slot.turn.store(pos + _mask + 1, std::memory_order_release);
+    _hdr->dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void CommandRing::markApplied(uint64_t seq)
+{
+    if (_hdr) _hdr->appliedSeq.store(seq + 1, std::memory_order_release);
+}
+
+uint64_t CommandRing::appliedSeq() const
+{
+    return _hdr ? _hdr->appliedSeq.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t CommandRing::depth() const
+{
+    if (!_hdr) return 0;
+    uint64_t enq = _hdr->enqueuePos.load(std::memory_order_relaxed);
+    uint64_t deq = _hdr->dequeuePos.load(std::memory_order_relaxed);
+    return enq > deq ? enq - deq : 0;
+}
+
+uint64_t CommandRing::rejected() const
+{
+    return _hdr ? _hdr->rejected.load(std::memory_order_relaxed) : 0;
+}
+
+bool CommandRing::unlink(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// Кольцо команд в разделяемой памяти (shm_open/mmap): много писателей, один читатель
+// Писатели — Python обертка и другие процессы, читатель — главный цикл crsf_io_rpi.
+// Записи фиксированного размера, ограниченная очередь Вьюкова: у каждого слота свой
+// счётчик хода, поэтому чтение и запись не требуют блокировок и системных вызовов
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "кольцо команд в shm требует lock-free atomic");
+
+// Типы команд
+enum CrsfCommandType : uint8_t {
+    CRSF_CMD_SET_CHANNEL = 1,   // channel, value
+    CRSF_CMD_SET_CHANNELS = 2,  // mask (бит i — канал i+1), values[]
+    CRSF_CMD_SEND = 3,          // отправить RC-кадр немедленно
+    CRSF_CMD_SET_MODE = 4,      // value: CRSF_MODE_MANUAL / CRSF_MODE_JOYSTICK
+};
+
+enum CrsfWorkMode : int32_t {
+    CRSF_MODE_MANUAL = 0,
+    CRSF_MODE_JOYSTICK = 1,
+};
+
+// Команда (полезная часть слота)
+struct CrsfCommand {
+    uint8_t type;         // CrsfCommandType
+    uint8_t channel;      // CRSF_CMD_SET_CHANNEL: 1..16
+    uint16_t mask;        // CRSF_CMD_SET_CHANNELS: какие каналы заданы
+    int32_t value;        // CRSF_CMD_SET_CHANNEL / CRSF_CMD_SET_MODE
+    uint64_t seq;         // порядковый номер команды (заполняет кольцо)
+    uint64_t originNs;    // отметка клиента rpi_nanos() для трассировки задержки
+    uint16_t values[16];  // CRSF_CMD_SET_CHANNELS: значения каналов, мкс
+};
+
+// Слот кольца: счётчик хода и команда, одна кэш-линия
+struct alignas(64) CommandRingSlot {
+    std::atomic<uint64_t> turn;
+    CrsfCommand cmd;
+};
+static_assert(sizeof(CommandRingSlot) == 64, "слот кольца команд — одна кэш-линия");
+
+// Заголовок сегмента. Слоты начинаются сразу после заголовка
+struct CommandRingHeader {
+    uint32_t magic;      // CommandRing::MAGIC — сегмент инициализирован
+    uint16_t version;    // версия формата
+    uint16_t slotSize;   // sizeof(CommandRingSlot)
+    uint32_t capacity;   // количество слотов, степень двойки
+    uint32_t readerPid;  // pid читателя
+
+    alignas(64) std::atomic<uint64_t> enqueuePos;   // писатели: следующая позиция записи
+    alignas(64) std::atomic<uint64_t> dequeuePos;   // читатель: следующая позиция чтения
+    std::atomic<uint64_t> appliedSeq;               // номер последней выполненной команды + 1
+    alignas(64) std::atomic<uint64_t> rejected;     // отказы писателям при полном кольце
+};
+
+class CommandRing {
+public:
+    static constexpr uint32_t MAGIC = 0x444D4352;  // "RCMD"
+    static constexpr uint16_t VERSION = 1;
+
+    CommandRing();
+    ~CommandRing();
+    CommandRing(const CommandRing&) = delete;
+    CommandRing& operator=(const CommandRing&) = delete;
+
+    // Читатель: создать (или сбросить) сегмент name на capacity слотов (степень двойки).
+    // Права 0600 — команды ставит только владелец; group — имя группы писателей (права 0660).
+    // false — сегмент не создан или группы нет
+    bool create(const char* name, uint32_t capacity, const char* group = nullptr);
+    // Писатель: открыть существующий сегмент
+    bool open(const char* name);
+    void close();
+    bool isOpen() const { return _hdr != nullptr; }
+
+    // Поставить команду; возвращает её номер (cmd.seq) или -1, если кольцо полно / не открыто
+    int64_t push(const CrsfCommand& cmd);
+    // Забрать следующую команду (только читатель); false — кольцо пусто
+    bool pop(CrsfCommand& cmd);
+    // Отметить команду выполненной (только читатель)
+    void markApplied(uint64_t seq);
+
+    // Номер последней выполненной команды + 1 (писатель может дождаться своей команды)
+    uint64_t appliedSeq() const;
+    // Команд в очереди (приблизительно, для статистики)
+    uint64_t depth() const;
+    uint64_t rejected() const;
+    uint32_t capacity() const { return _hdr ? _hdr->capacity : 0; }
+    // pid читателя, создавшего кольцо
+    uint32_t readerPid() const { return _hdr ? _hdr->readerPid : 0; }
+
+    static bool unlink(const char* name);
+
+private:
+    void* _base;
+    size_t _size;
+    CommandRingHeader* _hdr;
+    CommandRingSlot* _slots;
+    uint64_t _mask;
+};
@@ -4,32 +4,37 @@
 
 // Конструктор под Raspberry Pi: SerialPort уже открыт с нужной скоростью
 CrsfSerial::CrsfSerial(SerialPort& port, uint32_t baud) :
-    _port(port), _crc(0xd5), _baud(baud),
-    _lastReceive(0), _lastChannelsPacket(0), _linkIsUp(false),
+    onLinkUp(nullptr), onLinkDown(nullptr), onPacketChannels(nullptr), onFrameDecoded(nullptr),
+    _port(port), _rxBufPos(0), _crc(0xd5),
     _batteryVoltage(0.0), _batteryCurrent(0.0), _batteryCapacity(0.0), _batteryRemaining(0),
     _attitudeRoll(0.0), _attitudePitch(0.0), _attitudeYaw(0.0),
-    _rawAttitudeBytes{0, 0, 0}
+    _rawAttitudeBytes{0, 0, 0},
+    _baud(baud), _lastReceiveNs(0), _lastChannelsPacketNs(0), _linkIsUp(false),
+    _syncCount(0), _syncIntervalNs(0), _syncOffsetNs(0),
+    _parserStats()
 {
     // Ничего дополнительно не делаем: открытие и настройка порта снаружи
 }
 
 // Call from main loop to update
-void CrsfSerial::loop()
+unsigned int CrsfSerial::loop()
 {
-    handleSerialIn();
+    return handleSerialIn();
 }
 
-void CrsfSerial::handleSerialIn()
+unsigned int CrsfSerial::handleSerialIn()
 {
-    // Читаем не более 32 байт за раз, чтобы не блокировать основной цикл
-    for (int i = 0; i < 32; ++i) { 
+    // Читаем не более CRSF_RX_CHUNK байт за раз, чтобы не блокировать основной цикл
+    unsigned int count = 0;
+    for (; count < CRSF_RX_CHUNK; ++count) {
         uint8_t b;
         int r = _port.readByte(b);
         if (r <= 0) {
             break; // Прерываем, если в порту больше нет данных
         }
 
-        _lastReceive = rpi_millis();
+        _lastReceiveNs = rpi_nanos();
+        _parserStats.bytes++;
         _rxBuf[_rxBufPos++] = b;
         handleByteReceived();
 
@@ -40,6 +45,7 @@ void CrsfSerial::handleSerialIn()
 
     checkPacketTimeout();
     checkLinkDown();
+    return count;
 }
 
 void CrsfSerial::handleByteReceived()
@@ -52,6 +58,7 @@ void CrsfSerial::handleByteReceived()
             // Sanity check the declared length isn't outside Type + X{1,CRSF_MAX_PAYLOAD_LEN} + CRC
             // assumes there never will be a CRSF message that just has a type and no data (X)
             if (len < 3 || len >(CRSF_MAX_PAYLOAD_LEN + 2)) {
+                _parserStats.resyncs++;
                 shiftRxBuffer(1);
                 reprocess = true;
             }
@@ -65,6 +72,7 @@ void CrsfSerial::handleByteReceived()
                     reprocess = true;
                 } else {
                     // Отбрасываем ВЕСЬ битый пакет, а не один байт
+                    _parserStats.crcErrors++;
                     shiftRxBuffer(len + 2);
                     reprocess = true;
                 }
@@ -76,15 +84,17 @@ void CrsfSerial::handleByteReceived()
 void CrsfSerial::checkPacketTimeout()
 {
     // If we haven't received data in a long time, flush the buffer a byte at a time (to trigger shiftyByte)
-    if (_rxBufPos > 0 && rpi_millis() - _lastReceive > CRSF_PACKET_TIMEOUT_MS)
+    if (_rxBufPos > 0 && rpi_nanos() - _lastReceiveNs > CRSF_PACKET_TIMEOUT_NS) {
+        _parserStats.resyncs++;
         while (_rxBufPos)
             shiftRxBuffer(1);
+    }
 }
 
 void CrsfSerial::checkLinkDown()
 {
     // Проверяем общее время последнего получения ЛЮБЫХ данных, а не только RC-каналов
-    if (_linkIsUp && rpi_millis() - _lastReceive > CRSF_FAILSAFE_STAGE1_MS) {
+    if (_linkIsUp && rpi_nanos() - _lastReceiveNs > CRSF_FAILSAFE_STAGE1_NS) {
         if (onLinkDown)
             onLinkDown();
         _linkIsUp = false;
@@ -94,6 +104,8 @@ void CrsfSerial::checkLinkDown()
 void CrsfSerial::processPacketIn(uint8_t len)
 {
     const crsf_header_t* hdr = (crsf_header_t*)_rxBuf;
+    _parserStats.frames++;
+    _parserStats.framesByType[hdr->type]++;
     if (hdr->device_addr == CRSF_ADDRESS_FLIGHT_CONTROLLER) {
         switch (hdr->type) {
         case CRSF_FRAMETYPE_GPS:
@@ -120,6 +132,15 @@ void CrsfSerial::processPacketIn(uint8_t len)
         break;
         }
     } // CRSF_ADDRESS_FLIGHT_CONTROLLER
+    else if (hdr->device_addr == CRSF_ADDRESS_RADIO_TRANSMITTER) {
+        // Кадры TX-модуля, адресованные "пульту" (нам)
+        if (hdr->type == CRSF_FRAMETYPE_RADIO_ID) {
+            packetRadioId(hdr);
+        }
+    }
+
+    if (onFrameDecoded)
+        onFrameDecoded(hdr);
 }
 
 // Shift the bytes in the RxBuf down by cnt bytes
@@ -177,7 +198,7 @@ void CrsfSerial::packetChannelsPacked(const crsf_header_t* p)
     if (!_linkIsUp && onLinkUp)
         onLinkUp();
     _linkIsUp = true;
-    _lastChannelsPacket = rpi_millis();
+    _lastChannelsPacketNs = rpi_nanos();
 
     //БЕСПОЛЕЗНО: onPacketChannels никогда не устанавливается, так как packetChannels удалена
     if (onPacketChannels)
@@ -221,6 +242,26 @@ void CrsfSerial::packetGps(const crsf_header_t* p)
     //    onPacketGps(&_gpsSensor);
 }
 
+void CrsfSerial::packetRadioId(const crsf_header_t* p)
+{
+    // frame_size = type + payload + crc
+    if (p->frame_size < CRSF_FRAME_RADIO_ID_SYNC_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC)
+        return;
+    const crsf_opentx_sync_t* sync = (const crsf_opentx_sync_t*)p->data;
+    if (sync->subtype != CRSF_FRAMETYPE_OPENTX_SYNC)
+        return;
+
+    // Единицы кадра — 0.1 мкс, переводим в наносекунды
+    uint32_t rate = be32toh(sync->rate);
+    int32_t offset = (int32_t)be32toh((uint32_t)sync->offset);
+    // Отбрасываем заведомо неверные значения (> 1 с), чтобы не переполнить нс
+    if (rate > 10000000u || offset > 10000000 || offset < -10000000)
+        return;
+    _syncIntervalNs = rate * 100u;
+    _syncOffsetNs = offset * 100;
+    _syncCount++;
+}
+
 void CrsfSerial::write(uint8_t b)
 {
     _port.writeByte(b);
@@ -253,7 +294,7 @@ void CrsfSerial::queuePacket(uint8_t addr, uint8_t type, const void* payload, ui
     // buf[len + 4] = 0x45;
     // buf[3] = 0x03;
     // Busywait until the serial port seems free
-    //while (rpi_millis() - _lastReceive < 2)
+    //while (rpi_nanos() - _lastReceiveNs < 2000000)
     //    loop();
     // for (int i = 0; i < 25; i++) {
     //     buf[i] = 0;
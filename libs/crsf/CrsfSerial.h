@@ -10,6 +10,15 @@
 //БЕСПОЛЕЗНО: enum определен, но нигде не используется
 //enum eFailsafeAction { fsaNoPulses, fsaHold };
 
+// Статистика разбора входящего потока (счётчики с создания объекта)
+struct CrsfParserStats {
+    uint64_t bytes;              // принятые байты
+    uint64_t frames;             // кадры с верным CRC
+    uint64_t crcErrors;          // отброшенные кадры с неверным CRC
+    uint64_t resyncs;            // сдвиги в поиске начала кадра: неверная длина или таймаут пакета
+    uint32_t framesByType[256];  // кадры с верным CRC по типу
+};
+
 // Реализация CRSF поверх SerialPort (Raspberry Pi)
 class CrsfSerial
 {
@@ -17,11 +26,15 @@ public:
 // Packet timeout where buffer is flushed if no data is received in this time
 static const unsigned int CRSF_PACKET_TIMEOUT_MS = 100;
 static const unsigned int CRSF_FAILSAFE_STAGE1_MS = 120000;  // 2 минуты вместо 60 секунд для стабильной работы
-uint32_t _lastReceive; // время последнего приёма (мс), rpi_millis()
+// Максимум байт, читаемых из порта за один вызов loop()
+static const unsigned int CRSF_RX_CHUNK = 32;
+static constexpr uint64_t CRSF_PACKET_TIMEOUT_NS = CRSF_PACKET_TIMEOUT_MS * 1000000ull;
+static constexpr uint64_t CRSF_FAILSAFE_STAGE1_NS = CRSF_FAILSAFE_STAGE1_MS * 1000000ull;
 
 // Конструктор: принимает ссылку на SerialPort и скорость
 CrsfSerial(SerialPort& port, uint32_t baud = CRSF_BAUDRATE);
-void loop();
+// Возвращает количество прочитанных байт (CRSF_RX_CHUNK — в порту могут остаться данные)
+unsigned int loop();
 void write(uint8_t b);
 void write(const uint8_t* buf, size_t len);
 void queuePacket(uint8_t addr, uint8_t type, const void* payload, uint8_t len);
@@ -63,6 +76,20 @@ void setChannel(unsigned int ch, int value)
     int16_t getRawAttitudeYaw() const { return _rawAttitudeBytes[2]; }
     
     bool isLinkUp() const { return _linkIsUp; }
+    // Время последнего принятого байта / пакета каналов, нс rpi_nanos() (0 — ещё не было)
+    uint64_t getLastReceiveNs() const { return _lastReceiveNs; }
+    uint64_t getLastChannelsPacketNs() const { return _lastChannelsPacketNs; }
+
+    // Синхронизация темпа RC-кадров от TX-модуля (RADIO_ID / OPENTX_SYNC)
+    // Счётчик увеличивается на каждый принятый кадр синхронизации
+    uint32_t getSyncCount() const { return _syncCount; }
+    uint32_t getSyncIntervalNs() const { return _syncIntervalNs; }
+
+    // Статистика разбора (для /metrics веб-сервера телеметрии)
+    const CrsfParserStats& getParserStats() const { return _parserStats; }
+    // Байт в выходной очереди UART, -1 — неизвестно
+    int getTxQueueBytes() const { return _port.outputQueueBytes(); }
+    int32_t getSyncOffsetNs() const { return _syncOffsetNs; }
     //БЕСПОЛЕЗНО: функции определены, но нигде не вызываются
     //bool getPassthroughMode() const { return _passthroughMode; }
     //void setPassthroughMode(bool val, unsigned int baud = 0);
@@ -71,6 +98,8 @@ void setChannel(unsigned int ch, int value)
     void (*onLinkUp)();
     void (*onLinkDown)();
     void (*onPacketChannels)();
+    // Вызывается после разбора каждого кадра с верным CRC (frame действителен только во время вызова)
+    void (*onFrameDecoded)(const crsf_header_t* frame);
     //БЕСПОЛЕЗНО: указатели на функции устанавливаются, но никогда не вызываются
     //void (*onShiftyByte)(uint8_t b);
     //void (*onPacketLinkStatistics)(crsfLinkStatistics_t* ls);
@@ -103,11 +132,12 @@ private:
     int16_t _rawAttitudeBytes[3];  // [0]=pitch, [1]=roll, [2]=yaw (порядок изменен!)
     
     uint32_t _baud;
-    uint32_t _lastChannelsPacket;
+    uint64_t _lastReceiveNs;
+    uint64_t _lastChannelsPacketNs;
     bool _linkIsUp;
     int _channels[CRSF_NUM_CHANNELS];
 
-    void handleSerialIn();
+    unsigned int handleSerialIn();
     void handleByteReceived();
     void shiftRxBuffer(uint8_t cnt);
     void processPacketIn(uint8_t len);
@@ -118,4 +148,11 @@ private:
     void packetChannelsPacked(const crsf_header_t* p);
     void packetLinkStatistics(const crsf_header_t* p);
     void packetGps(const crsf_header_t* p);
+    void packetRadioId(const crsf_header_t* p);
+
+    uint32_t _syncCount;
+    uint32_t _syncIntervalNs;
+    int32_t _syncOffsetNs;
+
+    CrsfParserStats _parserStats;
 };
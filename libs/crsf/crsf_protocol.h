@@ -34,6 +34,7 @@ enum {
     CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE = 10,
     CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE = 22, // 11 bits per channel * 16 channels = 22 bytes.
     CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE = 6,
+    CRSF_FRAME_RADIO_ID_SYNC_PAYLOAD_SIZE = 11, // dest + origin + subtype + rate(4) + offset(4)
 };
 
 typedef enum
@@ -118,6 +119,17 @@ typedef struct crsfPayloadLinkstatistics_s
     int8_t downlink_SNR;
 } crsfLinkStatistics_t;
 
+// Подкадр OPENTX_SYNC внутри расширенного кадра RADIO_ID (TX-модуль -> пульт)
+// Модуль сообщает интервал RC-пакетов и сдвиг фазы, чтобы RC-кадр приходил перед слотом RF
+typedef struct crsf_opentx_sync_s
+{
+    uint8_t dest_addr;   // CRSF_ADDRESS_RADIO_TRANSMITTER
+    uint8_t origin_addr; // CRSF_ADDRESS_CRSF_TRANSMITTER
+    uint8_t subtype;     // CRSF_FRAMETYPE_OPENTX_SYNC
+    uint32_t rate;       // интервал RC-пакетов, 0.1 мкс, big endian
+    int32_t offset;      // сдвиг фазы, 0.1 мкс, big endian (>0 — кадры приходят слишком рано)
+} PACKED crsf_opentx_sync_t;
+
 typedef struct crsf_sensor_gps_s
 {
     int32_t latitude;   // degree / 10,000,000 big endian
@@ -0,0 +1,52 @@
+#pragma once
+
+// Метрики стека CRSF для /metrics веб-сервера телеметрии (формат Prometheus)
+// Движок публикует структуру раз в CRSF_METRICS_MS в сегмент CRSF_METRICS_SHM_NAME
+// (TelemetryShm с хешем схемы CRSF_METRICS_VERSION): счётчики разбора, очереди,
+// планировщик RC-отправки и гистограммы задержки команд с фиксированными границами
+
+#include <cstddef>
+#include <cstdint>
+
+// Меняйте при любом изменении CrsfMetrics: читатель другой версии сегмент не откроет
+static constexpr uint64_t CRSF_METRICS_VERSION = 1;
+
+// Границы корзин гистограмм, мкс (корзина +Inf — count)
+static constexpr uint32_t CRSF_METRICS_BOUNDS_US[] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+};
+static constexpr unsigned CRSF_METRICS_BUCKETS = sizeof(CRSF_METRICS_BOUNDS_US) / sizeof(CRSF_METRICS_BOUNDS_US[0]);
+
+struct CrsfMetricsHistogram {
+    uint64_t cumulative[CRSF_METRICS_BUCKETS];  // измерений не больше границы
+    uint64_t count;
+    uint64_t sumNs;
+};
+
+struct CrsfMetrics {
+    // Разбор входящего потока (CrsfParserStats)
+    uint64_t rxBytes;
+    uint64_t rxFrames;
+    uint64_t crcErrors;
+    uint64_t resyncs;
+    uint64_t framesByType[256];
+
+    // Очереди: байты в выходной очереди UART (-1 — неизвестно), команды в кольце
+    int64_t txQueueBytes;
+    uint64_t commandQueueDepth;
+    uint64_t commandsApplied;
+    uint64_t commandsRejected;   // отказы писателям при полном кольце
+
+    // Планировщик RC-отправки
+    uint32_t rcPeriodUs;
+    uint32_t reserved;
+    uint64_t rcTicks;
+    uint64_t rcOverruns;
+    CrsfMetricsHistogram rcJitter;  // опоздание тика относительно дедлайна
+
+    // Задержка команда -> UART по этапам (CrsfLatencyTrace)
+    CrsfMetricsHistogram latIpc;
+    CrsfMetricsHistogram latQueue;
+    CrsfMetricsHistogram latWrite;
+    CrsfMetricsHistogram latTotal;
+};
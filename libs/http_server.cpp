@@ -0,0 +1,599 @@
+#include "http_server.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "rpi_hal.h"
+
+static const char HTTP_503[] =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+const std::string* HttpRequest::header(const char* name) const
+{
+    for (const auto& h : headers) {
+        if (h.first == name) return &h.second;
+    }
+    return nullptr;
+}
+
+static bool equalsIgnoreCase(const std::string& s, const char* word)
+{
+    size_t n = strlen(word);
+    if (s.size() != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        char c = s[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != word[i]) return false;
+    }
+    return true;
+}
+
+static std::string trim(const char* begin, const char* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return std::string(begin, end);
+}
+
+long httpParseRequest(const char* data, size_t len, HttpRequest& out)
+{
+    // Конец заголовков
+    size_t scan = len < HTTP_MAX_HEADER_SIZE ? len : HTTP_MAX_HEADER_SIZE;
+    const char* end = nullptr;
+    for (size_t i = 3; i < scan; ++i) {
+        if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+            end = data + i - 3;
+            break;
+        }
+    }
+    if (!end) return len >= HTTP_MAX_HEADER_SIZE ? -1 : 0;
+    size_t headerLen = static_cast<size_t>(end - data) + 4;
+
+    // Строка запроса: МЕТОД SP цель SP HTTP/1.x
+    const char* line = data;
+    const char* lineEnd = static_cast<const char*>(memchr(line, '\r', static_cast<size_t>(end - line) + 1));
+    const char* sp1 = static_cast<const char*>(memchr(line, ' ', static_cast<size_t>(lineEnd - line)));
+    if (!sp1 || sp1 == line) return -1;
+    const char* target = sp1 + 1;
+    const char* sp2 = static_cast<const char*>(memchr(target, ' ', static_cast<size_t>(lineEnd - target)));
+    if (!sp2 || sp2 == target || *target != '/') return -1;
+    if (lineEnd - (sp2 + 1) != 8 || memcmp(sp2 + 1, "HTTP/1.", 7) != 0 ||
+        (sp2[8] != '0' && sp2[8] != '1')) {
+        return -1;
+    }
+
+    out.method.assign(line, sp1);
+    const char* q = static_cast<const char*>(memchr(target, '?', static_cast<size_t>(sp2 - target)));
+    out.path.assign(target, q ? q : sp2);
+    if (q) {
+        out.query.assign(q + 1, sp2);
+    } else {
+        out.query.clear();
+    }
+    out.versionMinor = sp2[8] - '0';
+    out.headers.clear();
+    out.body.clear();
+
+    // Заголовки
+    const char* p = lineEnd + 2;
+    while (p < end + 2) {
+        const char* eol = static_cast<const char*>(memchr(p, '\r', static_cast<size_t>(end + 2 - p)));
+        if (!eol || eol == p) break;
+        const char* colon = static_cast<const char*>(memchr(p, ':', static_cast<size_t>(eol - p)));
+        if (!colon || colon == p) return -1;
+        std::string name(p, colon);
+        for (char& c : name) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        out.headers.emplace_back(std::move(name), trim(colon + 1, eol));
+        p = eol + 2;
+    }
+
+    const std::string* connection = out.header("connection");
+    if (out.versionMinor >= 1) {
+        out.keepAlive = !(connection && equalsIgnoreCase(*connection, "close"));
+    } else {
+        out.keepAlive = connection && equalsIgnoreCase(*connection, "keep-alive");
+    }
+
+    // Тело: только Content-Length (chunked не поддерживается)
+    if (out.header("transfer-encoding")) return -1;
+    size_t bodyLen = 0;
+    if (const std::string* cl = out.header("content-length")) {
+        char* numEnd = nullptr;
+        unsigned long v = strtoul(cl->c_str(), &numEnd, 10);
+        if (cl->empty() || *numEnd != '\0' || v > HTTP_MAX_BODY_SIZE) return -1;
+        bodyLen = v;
+    }
+    if (len < headerLen + bodyLen) return 0;
+    out.body.assign(data + headerLen, bodyLen);
+    return static_cast<long>(headerLen + bodyLen);
+}
+
+const char* httpStatusText(int status)
+{
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default:  return "Unknown";
+    }
+}
+
+HttpServer::HttpServer()
+    : _listen(-1), _epoll(-1), _port(0), _maxConnections(DEFAULT_MAX_CONNECTIONS),
+      _idleTimeoutMs(DEFAULT_IDLE_TIMEOUT_MS), _writeTimeoutMs(DEFAULT_WRITE_TIMEOUT_MS),
+      _maxOutput(DEFAULT_MAX_OUTPUT), _rateLimit(0), _rateBurst(0), _slowClosed(0), _rateLimited(0),
+      _lastIdleCheckNs(0), _handler(nullptr),
+      _closeHandler(nullptr), _context(nullptr)
+{
+}
+
+HttpServer::~HttpServer()
+{
+    stop();
+}
+
+bool HttpServer::start(int port, Handler handler, void* context, int maxConnections, const char* bindAddress)
+{
+    stop();
+    if (!handler || maxConnections <= 0 || !bindAddress) return false;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bindAddress, &addr.sin_addr) != 1) return false;
+
+    _listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listen < 0) return false;
+    int opt = 1;
+    setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    socklen_t addrLen = sizeof(addr);
+    if (bind(_listen, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(_listen, SOMAXCONN) < 0 ||
+        getsockname(_listen, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) < 0) {
+        stop();
+        return false;
+    }
+    _port = ntohs(addr.sin_port);
+
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = _listen;
+    if (_epoll < 0 || epoll_ctl(_epoll, EPOLL_CTL_ADD, _listen, &ev) < 0) {
+        stop();
+        return false;
+    }
+
+    _handler = handler;
+    _context = context;
+    _maxConnections = maxConnections;
+    _lastIdleCheckNs = rpi_nanos();
+    return true;
+}
+
+void HttpServer::setRateLimit(uint32_t requestsPerSec, uint32_t burst)
+{
+    _rateLimit = requestsPerSec;
+    _rateBurst = burst > 0 ? burst : requestsPerSec;
+}
+
+void HttpServer::stop()
+{
+    while (!_connections.empty()) {
+        closeClient(_connections.begin()->first);
+    }
+    _closing.clear();
+    _watched.clear();
+    if (_epoll >= 0) close(_epoll);
+    if (_listen >= 0) close(_listen);
+    _epoll = -1;
+    _listen = -1;
+    _port = 0;
+}
+
+void HttpServer::poll(int timeoutMs)
+{
+    if (_epoll < 0) return;
+
+    struct epoll_event events[64];
+    int n = epoll_wait(_epoll, events, 64, timeoutMs);
+    for (int i = 0; i < n; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == _listen) {
+            acceptClients();
+            continue;
+        }
+        bool watched = false;
+        for (size_t w = 0; w < _watched.size(); ++w) {
+            if (_watched[w].first == fd) {
+                _watched[w].second(fd, _context);
+                watched = true;
+                break;
+            }
+        }
+        if (watched) continue;
+        auto it = _connections.find(fd);
+        if (it == _connections.end()) continue;
+        Connection& c = it->second;
+        if (c.dropped) continue;  // уже в _closing
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            _closing.push_back(fd);  // закрываем после итерации: номер fd не переиспользуется в ней
+            continue;
+        }
+        if (events[i].events & EPOLLOUT) flush(fd, c);
+        if ((events[i].events & EPOLLIN) && c.wantRead && _connections.count(fd)) readClient(fd, c);
+    }
+
+    for (int fd : _closing) {
+        closeClient(fd);
+    }
+    _closing.clear();
+
+    uint64_t now = rpi_nanos();
+    if (now - _lastIdleCheckNs >= 1000000000ull) {
+        _lastIdleCheckNs = now;
+        closeIdle(now);
+    }
+}
+
+void HttpServer::acceptClients()
+{
+    for (;;) {
+        int fd = accept4(_listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN — очередь пуста
+
+        if (static_cast<int>(_connections.size()) >= _maxConnections) {
+            ssize_t sent = send(fd, HTTP_503, sizeof(HTTP_503) - 1, MSG_NOSIGNAL);
+            (void)sent;
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        Connection& c = _connections[fd];
+        c.lastActiveNs = rpi_nanos();
+        c.lastRefillNs = c.lastActiveNs;
+        c.tokens = _rateBurst;
+    }
+}
+
+void HttpServer::readClient(int fd, Connection& c)
+{
+    char buf[4096];
+    bool eof = false;
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            c.in.append(buf, static_cast<size_t>(n));
+            if (c.in.size() > HTTP_MAX_HEADER_SIZE + HTTP_MAX_BODY_SIZE) break;
+            continue;
+        }
+        if (n == 0) {
+            eof = true;  // клиент закончил передачу; ответы на уже пришедшие запросы досылаем
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            _closing.push_back(fd);
+            return;
+        }
+        break;
+    }
+    c.lastActiveNs = rpi_nanos();
+    processInput(fd, c);
+    if (eof) {
+        if (c.outSent == c.out.size()) {
+            _closing.push_back(fd);
+        } else {
+            c.closeAfterWrite = true;
+        }
+    }
+}
+
+void HttpServer::processInput(int fd, Connection& c)
+{
+    if (c.streaming) {
+        c.in.clear();  // потоковому клиенту отвечать больше нечем
+        flush(fd, c);
+        return;
+    }
+    HttpRequest request;
+    bool deferred = true;
+    while (deferred) {
+        size_t offset = 0;
+        bool incomplete = false;  // остаток — начало запроса, а не отложенные целые запросы
+        deferred = false;
+        while (!c.streaming && !c.closeAfterWrite && !c.dropped) {
+            if (c.out.size() - c.outSent >= MAX_PENDING_OUTPUT) {
+                deferred = true;
+                break;
+            }
+            long used = httpParseRequest(c.in.data() + offset, c.in.size() - offset, request);
+            if (used == 0) {
+                incomplete = true;
+                break;
+            }
+            if (used < 0) {
+                c.keepAlive = false;
+                respond(fd, 400, "text/plain", "Bad Request\n", 12);
+                offset = c.in.size();
+                break;
+            }
+            offset += static_cast<size_t>(used);
+            c.keepAlive = request.keepAlive;
+            if (_rateLimit > 0 && !takeToken(c, c.lastActiveNs)) {
+                _rateLimited++;
+                respond(fd, 429, "text/plain", "Too Many Requests\n", 18, "Retry-After: 1\r\n");
+                continue;
+            }
+            _handler(*this, fd, request, _context);
+        }
+        if (c.dropped) return;
+        c.in.erase(0, offset);
+        // 413 — только один запрос больше лимита; отложенные запросы ждут без чтения (см. updateEvents)
+        if (incomplete && c.in.size() >= HTTP_MAX_HEADER_SIZE + HTTP_MAX_BODY_SIZE && !c.closeAfterWrite) {
+            c.keepAlive = false;
+            respond(fd, 413, "text/plain", "Payload Too Large\n", 18);
+            c.in.clear();
+        }
+        flush(fd, c);
+        // Отложенные запросы: если ответы ушли сразу, EPOLLOUT не придёт — разбираем здесь
+        deferred = deferred && !c.dropped && !c.in.empty() && c.outSent == c.out.size();
+    }
+}
+
+void HttpServer::respond(int conn, int status, const char* contentType, const char* body, size_t bodyLen,
+                         const char* extraHeaders)
+{
+    auto it = _connections.find(conn);
+    if (it == _connections.end()) return;
+    Connection& c = it->second;
+
+    char head[256];
+    int n;
+    if (status == 304) {
+        // 304 не несёт тела: без Content-Type и Content-Length
+        n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 304 Not Modified\r\n"
+                     "Access-Control-Allow-Origin: *\r\n"
+                     "Connection: %s\r\n",
+                     c.keepAlive ? "keep-alive" : "close");
+        bodyLen = 0;
+    } else {
+        n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 %d %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %zu\r\n"
+                     "Access-Control-Allow-Origin: *\r\n"
+                     "Connection: %s\r\n",
+                     status, httpStatusText(status), contentType ? contentType : "text/plain",
+                     bodyLen, c.keepAlive ? "keep-alive" : "close");
+    }
+    size_t extraLen = extraHeaders ? strlen(extraHeaders) : 0;
+    if (!admitOutput(conn, c, static_cast<size_t>(n) + extraLen + 2 + bodyLen)) return;
+    c.out.append(head, static_cast<size_t>(n));
+    if (extraHeaders) c.out.append(extraHeaders);
+    c.out.append("\r\n", 2);
+    c.out.append(body, bodyLen);
+    if (!c.keepAlive) c.closeAfterWrite = true;
+}
+
+void HttpServer::beginStream(int conn, const char* contentType, const char* extraHeaders)
+{
+    auto it = _connections.find(conn);
+    if (it == _connections.end()) return;
+    Connection& c = it->second;
+
+    char head[256];
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: %s\r\n"
+                     "Cache-Control: no-cache\r\n"
+                     "Access-Control-Allow-Origin: *\r\n"
+                     "Connection: keep-alive\r\n",
+                     contentType ? contentType : "text/event-stream");
+    size_t extraLen = extraHeaders ? strlen(extraHeaders) : 0;
+    if (!admitOutput(conn, c, static_cast<size_t>(n) + extraLen + 2)) return;
+    c.out.append(head, static_cast<size_t>(n));
+    if (extraHeaders) c.out.append(extraHeaders);
+    c.out.append("\r\n", 2);
+    c.streaming = true;
+}
+
+bool HttpServer::sendStream(int conn, const char* data, size_t len)
+{
+    auto it = _connections.find(conn);
+    if (it == _connections.end() || !it->second.streaming) return false;
+    Connection& c = it->second;
+    if (!admitOutput(conn, c, len)) return false;
+    c.out.append(data, len);
+    c.lastActiveNs = rpi_nanos();
+    flush(conn, c);
+    return true;
+}
+
+size_t HttpServer::pendingOutput(int conn) const
+{
+    auto it = _connections.find(conn);
+    return it == _connections.end() ? 0 : it->second.out.size() - it->second.outSent;
+}
+
+bool HttpServer::admitOutput(int fd, Connection& c, size_t len)
+{
+    if (c.dropped) return false;
+    size_t pending = c.out.size() - c.outSent;
+    if (pending + len > _maxOutput) {
+        dropSlow(fd, c);
+        return false;
+    }
+    if (pending == 0) c.lastWriteNs = rpi_nanos();  // отсчёт зависшей записи — с первого байта
+    return true;
+}
+
+bool HttpServer::takeToken(Connection& c, uint64_t nowNs)
+{
+    if (nowNs > c.lastRefillNs) {
+        c.tokens += static_cast<double>(nowNs - c.lastRefillNs) * _rateLimit / 1e9;
+        if (c.tokens > _rateBurst) c.tokens = _rateBurst;
+        c.lastRefillNs = nowNs;
+    }
+    if (c.tokens < 1.0) return false;
+    c.tokens -= 1.0;
+    return true;
+}
+
+void HttpServer::dropSlow(int fd, Connection& c)
+{
+    // Память освобождается сразу, соединение закрывается в конце итерации poll
+    std::string().swap(c.out);
+    std::string().swap(c.in);
+    c.outSent = 0;
+    c.dropped = true;
+    _slowClosed++;
+    _closing.push_back(fd);
+}
+
+bool HttpServer::watchFd(int fd, FdHandler callback)
+{
+    if (_epoll < 0 || fd < 0 || !callback) return false;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &ev) < 0) return false;
+    _watched.emplace_back(fd, callback);
+    return true;
+}
+
+void HttpServer::unwatchFd(int fd)
+{
+    for (size_t w = 0; w < _watched.size(); ++w) {
+        if (_watched[w].first == fd) {
+            epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+            _watched.erase(_watched.begin() + static_cast<long>(w));
+            return;
+        }
+    }
+}
+
+void HttpServer::flush(int fd, Connection& c)
+{
+    if (c.dropped) return;
+    size_t sentBefore = c.outSent;
+    while (c.outSent < c.out.size()) {
+        ssize_t n = send(fd, c.out.data() + c.outSent, c.out.size() - c.outSent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.outSent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        _closing.push_back(fd);
+        return;
+    }
+
+    if (c.outSent != sentBefore) c.lastWriteNs = rpi_nanos();
+
+    if (c.outSent == c.out.size()) {
+        // Буфер после всплеска не держит память: большая ёмкость отдаётся
+        if (c.out.capacity() > MAX_PENDING_OUTPUT) {
+            std::string().swap(c.out);
+        } else {
+            c.out.clear();
+        }
+        c.outSent = 0;
+        if (c.closeAfterWrite) {
+            _closing.push_back(fd);
+            return;
+        }
+        // Буфер освободился — разбираем запросы, отложенные из-за объёма ответов
+        if (!c.in.empty() && c.wantWrite) {
+            updateEvents(fd, c);
+            processInput(fd, c);
+            return;
+        }
+    } else if (c.outSent >= MAX_PENDING_OUTPUT) {
+        // Отправленное начало буфера не копится за медленным клиентом
+        c.out.erase(0, c.outSent);
+        c.outSent = 0;
+    }
+    updateEvents(fd, c);
+}
+
+void HttpServer::updateEvents(int fd, Connection& c)
+{
+    bool wantWrite = c.outSent < c.out.size();
+    // Обратное давление: пока ответы копятся, новые запросы остаются в буферах сокета
+    bool wantRead = c.out.size() - c.outSent < MAX_PENDING_OUTPUT;
+    if (wantWrite == c.wantWrite && wantRead == c.wantRead) return;
+    c.wantWrite = wantWrite;
+    c.wantRead = wantRead;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = (wantRead ? static_cast<uint32_t>(EPOLLIN) : 0u) | (wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = fd;
+    epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void HttpServer::closeClient(int fd)
+{
+    auto it = _connections.find(fd);
+    if (it == _connections.end()) return;
+    if (_closeHandler) _closeHandler(*this, fd, _context);
+    epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    _connections.erase(it);
+}
+
+void HttpServer::closeIdle(uint64_t nowNs)
+{
+    uint64_t limitNs = static_cast<uint64_t>(_idleTimeoutMs) * 1000000ull;
+    uint64_t writeLimitNs = static_cast<uint64_t>(_writeTimeoutMs) * 1000000ull;
+    for (auto& entry : _connections) {
+        Connection& c = entry.second;
+        if (c.dropped) continue;
+        if (c.outSent < c.out.size() && nowNs > c.lastWriteNs && nowNs - c.lastWriteNs > writeLimitNs) {
+            // Клиент не забирает данные: потоковые соединения тоже закрываются
+            dropSlow(entry.first, c);
+        } else if (!c.streaming && c.outSent == c.out.size() && nowNs - c.lastActiveNs > limitNs) {
+            // Простой — нет ни запросов, ни неотправленных ответов (пока они уходят, чтение
+            // может быть приостановлено и lastActiveNs не обновляется)
+            _closing.push_back(entry.first);
+        }
+    }
+    for (int fd : _closing) {
+        closeClient(fd);
+    }
+    _closing.clear();
+}
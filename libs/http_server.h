@@ -0,0 +1,161 @@
+#pragma once
+
+// Однопоточный HTTP/1.1 сервер на epoll для веб-сервера телеметрии
+// Неблокирующие сокеты с TCP_NODELAY, keep-alive и конвейерные запросы (pipelining):
+// все запросы, пришедшие одним пакетом, разбираются и получают ответы по порядку.
+// Ответы копятся в выходном буфере соединения и уходят, когда сокет готов к записи.
+// Число соединений ограничено: лишние получают 503 и закрываются сразу.
+// Ресурсы на клиента ограничены: выходной буфер не больше maxOutput, неотправленные данные
+// без продвижения дольше writeTimeout закрывают соединение, запросы сверх лимита частоты
+// (token bucket на соединение) получают 429 без вызова обработчика.
+// Потоковые ответы (Server-Sent Events) и свои дескрипторы (eventfd) работают в том же цикле
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Разобранный запрос
+struct HttpRequest {
+    std::string method;
+    std::string path;    // путь без строки запроса
+    std::string query;   // после '?', без декодирования
+    int versionMinor;    // HTTP/1.x
+    bool keepAlive;      // соединение остаётся открытым после ответа
+    std::vector<std::pair<std::string, std::string>> headers;  // имена в нижнем регистре
+    std::string body;
+
+    // Значение заголовка (имя в нижнем регистре), nullptr — заголовка нет
+    const std::string* header(const char* name) const;
+};
+
+// Лимиты разбора
+static constexpr size_t HTTP_MAX_HEADER_SIZE = 8192;
+static constexpr size_t HTTP_MAX_BODY_SIZE = 65536;
+
+// Разобрать запрос из начала буфера.
+// >0 — длина запроса в байтах, 0 — запрос пришёл не целиком, -1 — ошибка (ответ 400)
+long httpParseRequest(const char* data, size_t len, HttpRequest& out);
+
+// Текст статуса для кода ответа
+const char* httpStatusText(int status);
+
+class HttpServer {
+public:
+    // Обработчик запроса: должен ответить через respond() до возврата
+    typedef void (*Handler)(HttpServer& server, int conn, const HttpRequest& request, void* context);
+    // Соединение закрывается (после этого conn недействителен)
+    typedef void (*CloseHandler)(HttpServer& server, int conn, void* context);
+    // Свой дескриптор готов к чтению
+    typedef void (*FdHandler)(int fd, void* context);
+
+    static constexpr int DEFAULT_MAX_CONNECTIONS = 64;
+    static constexpr uint32_t DEFAULT_IDLE_TIMEOUT_MS = 30000;
+    // Пока в выходном буфере больше этого, новые запросы соединения не разбираются и не читаются:
+    // клиент упирается в окно TCP, а не в 413
+    static constexpr size_t MAX_PENDING_OUTPUT = 262144;
+    // Выходной буфер больше этого — клиент не успевает забирать данные, соединение закрывается
+    static constexpr size_t DEFAULT_MAX_OUTPUT = 2097152;
+    // Неотправленные данные без продвижения дольше этого — соединение закрывается
+    static constexpr uint32_t DEFAULT_WRITE_TIMEOUT_MS = 10000;
+
+    HttpServer();
+    ~HttpServer();
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Слушать порт (0 — любой свободный, см. port()) на адресе IPv4 bindAddress
+    // (по умолчанию только loopback, "0.0.0.0" — все интерфейсы)
+    bool start(int port, Handler handler, void* context, int maxConnections = DEFAULT_MAX_CONNECTIONS,
+               const char* bindAddress = "127.0.0.1");
+    void stop();
+    bool isRunning() const { return _epoll >= 0; }
+    int port() const { return _port; }
+
+    // Одна итерация цикла: ждать событий не дольше timeoutMs и обработать их
+    void poll(int timeoutMs);
+
+    // Ответ на текущий запрос соединения conn. extraHeaders — готовые строки "Имя: значение\r\n"
+    void respond(int conn, int status, const char* contentType, const char* body, size_t bodyLen,
+                 const char* extraHeaders = nullptr);
+    void respond(int conn, int status, const char* contentType, const std::string& body,
+                 const char* extraHeaders = nullptr)
+    {
+        respond(conn, status, contentType, body.data(), body.size(), extraHeaders);
+    }
+
+    // Потоковый ответ: заголовки без Content-Length, дальше данные через sendStream().
+    // Новые запросы такого соединения не разбираются, таймаут простоя не действует
+    void beginStream(int conn, const char* contentType, const char* extraHeaders = nullptr);
+    // Дописать данные потокового ответа; false — соединения больше нет или буфер превысил
+    // maxOutput (соединение закрывается как медленное)
+    bool sendStream(int conn, const char* data, size_t len);
+    // Неотправленные байты соединения (0 — соединения нет или всё отправлено)
+    size_t pendingOutput(int conn) const;
+
+    void setCloseHandler(CloseHandler handler) { _closeHandler = handler; }
+    // Следить за своим дескриптором в том же epoll (EPOLLIN, callback с контекстом start())
+    bool watchFd(int fd, FdHandler callback);
+    void unwatchFd(int fd);
+
+    size_t connectionCount() const { return _connections.size(); }
+    void setIdleTimeoutMs(uint32_t ms) { _idleTimeoutMs = ms; }
+    void setWriteTimeoutMs(uint32_t ms) { _writeTimeoutMs = ms; }
+    void setMaxOutput(size_t bytes) { _maxOutput = bytes; }
+    // Запросов в секунду на соединение и запас для всплеска; 0 — без ограничения (по умолчанию)
+    void setRateLimit(uint32_t requestsPerSec, uint32_t burst);
+
+    // Соединения, закрытые из-за медленного клиента (переполнение буфера, зависшая запись)
+    uint64_t slowClientsClosed() const { return _slowClosed; }
+    // Запросы, получившие 429
+    uint64_t requestsRateLimited() const { return _rateLimited; }
+
+private:
+    struct Connection {
+        std::string in;           // принятые, ещё не разобранные байты
+        std::string out;          // ответы, ещё не отправленные
+        size_t outSent = 0;       // отправлено из out
+        bool keepAlive = true;    // keep-alive текущего запроса
+        bool closeAfterWrite = false;
+        bool wantWrite = false;   // подписка на EPOLLOUT
+        bool wantRead = true;     // подписка на EPOLLIN (снята, пока ответы не уходят)
+        bool streaming = false;   // потоковый ответ (beginStream)
+        bool dropped = false;     // закрывается: новые данные не принимаются
+        uint64_t lastActiveNs = 0;
+        uint64_t lastWriteNs = 0; // последнее продвижение отправки
+        double tokens = 0;        // запас запросов (token bucket)
+        uint64_t lastRefillNs = 0;
+    };
+
+    void acceptClients();
+    void readClient(int fd, Connection& c);
+    void processInput(int fd, Connection& c);
+    void flush(int fd, Connection& c);
+    bool admitOutput(int fd, Connection& c, size_t len);
+    bool takeToken(Connection& c, uint64_t nowNs);
+    void dropSlow(int fd, Connection& c);
+    void updateEvents(int fd, Connection& c);
+    void closeClient(int fd);
+    void closeIdle(uint64_t nowNs);
+
+    int _listen;
+    int _epoll;
+    int _port;
+    int _maxConnections;
+    uint32_t _idleTimeoutMs;
+    uint32_t _writeTimeoutMs;
+    size_t _maxOutput;
+    uint32_t _rateLimit;
+    uint32_t _rateBurst;
+    uint64_t _slowClosed;
+    uint64_t _rateLimited;
+    uint64_t _lastIdleCheckNs;
+    Handler _handler;
+    CloseHandler _closeHandler;
+    void* _context;
+    std::vector<std::pair<int, FdHandler>> _watched;
+    std::unordered_map<int, Connection> _connections;
+    std::vector<int> _closing;  // соединения к закрытию после текущей итерации
+};
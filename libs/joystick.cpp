@@ -1,91 +1,324 @@
 #include "joystick.h"
+#include <linux/input.h>
 #include <linux/joystick.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
-#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 
 namespace {
 int g_fd = -1;
-std::vector<int16_t> g_axes;
-std::vector<uint8_t> g_buttons;
+bool g_evdev = false;
+bool g_monotonic = false;  // отметки событий evdev в CLOCK_MONOTONIC
+
+// Текущие состояния: массивы фиксированного размера, в цикле опроса память не выделяется
+int16_t g_axes[JS_MAX_AXES];
+uint64_t g_axisNs[JS_MAX_AXES];
+uint8_t g_buttons[JS_MAX_BUTTONS];
+int g_numAxes = 0;
+int g_numButtons = 0;
+
+// evdev: код события -> номер оси/кнопки (-1 — не используется), диапазоны осей
+int8_t g_absIndex[ABS_CNT];
+int16_t g_keyIndex[KEY_CNT];
+struct input_absinfo g_absInfo[JS_MAX_AXES];
+uint16_t g_axisCode[JS_MAX_AXES];
+
+// Каналы 1-4: ось-источник, ось, по наличию которой канал пишется, инверсия
+struct ChannelMap {
+    int axis;
+    int presentAxis;
+    bool invert;
+};
+const ChannelMap g_channelMap[4] = {
+    {2, 0, false},  // Roll
+    {3, 1, true},   // Pitch
+    {1, 2, true},   // Throttle
+    {0, 3, false},  // Yaw
+};
+// Последняя запись каналов 1-4 (-1 — не записан) и отметка ядра оси на тот момент
+int g_channelUs[4] = {-1, -1, -1, -1};
+uint64_t g_channelNs[4];
+}
+
+static bool testBit(const uint8_t* bits, unsigned int bit)
+{
+    return (bits[bit / 8] >> (bit % 8)) & 1u;
+}
+
+static void resetState()
+{
+    memset(g_axes, 0, sizeof(g_axes));
+    memset(g_axisNs, 0, sizeof(g_axisNs));
+    memset(g_buttons, 0, sizeof(g_buttons));
+    memset(g_absIndex, -1, sizeof(g_absIndex));
+    for (int16_t& index : g_keyIndex) index = -1;
+    g_numAxes = 0;
+    g_numButtons = 0;
+    g_evdev = false;
+    g_monotonic = false;
+    js_reset_channels();
+}
+
+int16_t js_normalize_abs(int32_t value, int32_t min, int32_t max, int32_t flat)
+{
+    if (max <= min) return 0;
+    double center = (static_cast<double>(min) + max) / 2.0;
+    double half = (static_cast<double>(max) - min) / 2.0;
+    double d = value - center;
+    double magnitude = d < 0 ? -d : d;
+    double dead = flat > 0 ? flat : 0;
+    if (magnitude <= dead) return 0;
+    double range = half - dead;
+    double scaled = range > 0 ? (magnitude - dead) / range * 32767.0 : 32767.0;
+    if (scaled > 32767.0) scaled = 32767.0;
+    int16_t v = static_cast<int16_t>(scaled + 0.5);
+    return d < 0 ? static_cast<int16_t>(-v) : v;
+}
+
+// Состояния осей и кнопок из ядра: при открытии и после SYN_DROPPED (очередь событий переполнилась)
+static void evdevSync()
+{
+    for (int i = 0; i < g_numAxes; ++i) {
+        struct input_absinfo info;
+        if (ioctl(g_fd, EVIOCGABS(g_axisCode[i]), &info) < 0) continue;
+        g_absInfo[i] = info;
+        g_axes[i] = js_normalize_abs(info.value, info.minimum, info.maximum, info.flat);
+    }
+    uint8_t keys[KEY_CNT / 8 + 1] = {};
+    if (ioctl(g_fd, EVIOCGKEY(sizeof(keys)), keys) < 0) return;
+    for (unsigned int code = 0; code < KEY_CNT; ++code) {
+        if (g_keyIndex[code] >= 0) g_buttons[g_keyIndex[code]] = testBit(keys, code);
+    }
+}
+
+static bool evdevOpen()
+{
+    int version = 0;
+    if (ioctl(g_fd, EVIOCGVERSION, &version) < 0) return false;  // не evdev
+
+    uint8_t absBits[ABS_CNT / 8 + 1] = {};
+    uint8_t keyBits[KEY_CNT / 8 + 1] = {};
+    ioctl(g_fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits);
+    ioctl(g_fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits);
+
+    // Оси — в порядке кодов ABS_*, как у joydev
+    for (unsigned int code = 0; code < ABS_CNT && g_numAxes < JS_MAX_AXES; ++code) {
+        if (!testBit(absBits, code)) continue;
+        struct input_absinfo info;
+        if (ioctl(g_fd, EVIOCGABS(code), &info) < 0) continue;
+        g_absIndex[code] = static_cast<int8_t>(g_numAxes);
+        g_axisCode[g_numAxes] = static_cast<uint16_t>(code);
+        g_absInfo[g_numAxes] = info;
+        g_numAxes++;
+    }
+    // Кнопки — как у joydev: сначала BTN_JOYSTICK..KEY_MAX, затем BTN_MISC..BTN_JOYSTICK-1
+    for (unsigned int code = BTN_JOYSTICK; code < KEY_CNT && g_numButtons < JS_MAX_BUTTONS; ++code) {
+        if (testBit(keyBits, code)) g_keyIndex[code] = static_cast<int16_t>(g_numButtons++);
+    }
+    for (unsigned int code = BTN_MISC; code < BTN_JOYSTICK && g_numButtons < JS_MAX_BUTTONS; ++code) {
+        if (testBit(keyBits, code)) g_keyIndex[code] = static_cast<int16_t>(g_numButtons++);
+    }
+
+    // Отметки событий в той же шкале, что rpi_nanos()
+    int clockId = CLOCK_MONOTONIC;
+    g_monotonic = ioctl(g_fd, EVIOCSCLOCKID, &clockId) == 0;
+    g_evdev = true;
+    evdevSync();
+    return true;
+}
+
+// Устройство evdev похоже на джойстик: ось X и кнопка джойстика или геймпада (как у joydev)
+static bool looksLikeJoystick(int fd)
+{
+    uint8_t absBits[ABS_CNT / 8 + 1] = {};
+    uint8_t keyBits[KEY_CNT / 8 + 1] = {};
+    if (ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits) < 0) return false;
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0) return false;
+    return testBit(absBits, ABS_X) &&
+           (testBit(keyBits, BTN_JOYSTICK) || testBit(keyBits, BTN_GAMEPAD) || testBit(keyBits, BTN_TRIGGER_HAPPY));
+}
+
+static int findEvdevJoystick()
+{
+    char path[32];
+    for (int i = 0; i < 32; ++i) {
+        snprintf(path, sizeof(path), "/dev/input/event%d", i);
+        int fd = ::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) continue;
+        if (looksLikeJoystick(fd)) return fd;
+        ::close(fd);
+    }
+    return -1;
 }
 
 bool js_open(const char* path)
 {
     if (g_fd >= 0) return true;
-    g_fd = ::open(path, O_RDONLY | O_NONBLOCK);
+    resetState();
+    g_fd = path ? ::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC) : findEvdevJoystick();
+    if (g_fd < 0 && !path) g_fd = ::open("/dev/input/js0", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
     if (g_fd < 0) return false;
+    if (evdevOpen()) return true;
 
     // Жёстко не полагаемся на JSIOCGAXES/JSIOCGBUTTONS (не у всех есть),
-    // но попробуем получить из ioctl, иначе будем расширять динамически на лету
+    // иначе число осей/кнопок растёт по номерам из событий
     unsigned char na = 0, nb = 0;
-    if (ioctl(g_fd, JSIOCGAXES, &na) == 0 && na > 0) g_axes.assign(na, 0);
-    if (ioctl(g_fd, JSIOCGBUTTONS, &nb) == 0 && nb > 0) g_buttons.assign(nb, 0);
+    if (ioctl(g_fd, JSIOCGAXES, &na) == 0) g_numAxes = na < JS_MAX_AXES ? na : JS_MAX_AXES;
+    if (ioctl(g_fd, JSIOCGBUTTONS, &nb) == 0) g_numButtons = nb;
     return true;
 }
 
-//БЕСПОЛЕЗНО: функция определена, но нигде не вызывается
-/*
 void js_close()
 {
     if (g_fd >= 0) {
         ::close(g_fd);
         g_fd = -1;
     }
-    g_axes.clear();
-    g_buttons.clear();
+    resetState();
 }
-*/
 
-static void ensure_axis_size(size_t idx)
+int js_fd()
 {
-    if (g_axes.size() <= idx) g_axes.resize(idx + 1, 0);
+    return g_fd;
 }
 
-static void ensure_button_size(size_t idx)
+bool js_is_evdev()
 {
-    if (g_buttons.size() <= idx) g_buttons.resize(idx + 1, 0);
+    return g_evdev;
 }
 
-bool js_poll()
+static bool evdevPoll()
+{
+    bool processed = false;
+    struct input_event events[64];
+    for (;;) {
+        ssize_t r = ::read(g_fd, events, sizeof(events));
+        if (r < static_cast<ssize_t>(sizeof(events[0]))) break;  // нет данных
+        size_t n = static_cast<size_t>(r) / sizeof(events[0]);
+        processed = true;
+        for (size_t i = 0; i < n; ++i) {
+            const struct input_event& e = events[i];
+            if (e.type == EV_ABS && e.code < ABS_CNT && g_absIndex[e.code] >= 0) {
+                int idx = g_absIndex[e.code];
+                const struct input_absinfo& info = g_absInfo[idx];
+                g_axes[idx] = js_normalize_abs(e.value, info.minimum, info.maximum, info.flat);
+                if (g_monotonic) {
+                    g_axisNs[idx] = static_cast<uint64_t>(e.input_event_sec) * 1000000000ull +
+                                    static_cast<uint64_t>(e.input_event_usec) * 1000ull;
+                }
+            } else if (e.type == EV_KEY && e.code < KEY_CNT && g_keyIndex[e.code] >= 0) {
+                g_buttons[g_keyIndex[e.code]] = (e.value != 0);
+            } else if (e.type == EV_SYN && e.code == SYN_DROPPED) {
+                evdevSync();
+            }
+        }
+        if (n < sizeof(events) / sizeof(events[0])) break;
+    }
+    return processed;
+}
+
+static bool legacyPoll()
 {
-    if (g_fd < 0) return false;
     bool processed = false;
-    js_event e;
-    while (true) {
-        ssize_t r = ::read(g_fd, &e, sizeof(e));
-        if (r < (ssize_t)sizeof(e)) break; // нет данных
+    js_event events[64];
+    for (;;) {
+        ssize_t r = ::read(g_fd, events, sizeof(events));
+        if (r < static_cast<ssize_t>(sizeof(events[0]))) break;  // нет данных
+        size_t n = static_cast<size_t>(r) / sizeof(events[0]);
         processed = true;
-        uint8_t type = e.type & ~JS_EVENT_INIT;
-        if (type == JS_EVENT_AXIS) {
-            ensure_axis_size(e.number);
-            g_axes[e.number] = e.value;
-        } else if (type == JS_EVENT_BUTTON) {
-            ensure_button_size(e.number);
-            g_buttons[e.number] = (e.value != 0);
+        for (size_t i = 0; i < n; ++i) {
+            const js_event& e = events[i];
+            uint8_t type = e.type & ~JS_EVENT_INIT;
+            if (type == JS_EVENT_AXIS && e.number < JS_MAX_AXES) {
+                if (e.number >= g_numAxes) g_numAxes = e.number + 1;
+                g_axes[e.number] = e.value;
+            } else if (type == JS_EVENT_BUTTON) {
+                if (e.number >= g_numButtons) g_numButtons = e.number + 1;
+                g_buttons[e.number] = (e.value != 0);
+            }
         }
+        if (n < sizeof(events) / sizeof(events[0])) break;
     }
     return processed;
 }
 
+bool js_poll()
+{
+    if (g_fd < 0) return false;
+    return g_evdev ? evdevPoll() : legacyPoll();
+}
+
 bool js_get_axis(int index, int16_t& outValue)
 {
-    if (index < 0) return false;
-    size_t idx = static_cast<size_t>(index);
-    if (idx >= g_axes.size()) return false;
-    outValue = g_axes[idx];
+    if (index < 0 || index >= g_numAxes) return false;
+    outValue = g_axes[index];
+    return true;
+}
+
+uint64_t js_axis_time_ns(int index)
+{
+    if (index < 0 || index >= g_numAxes) return 0;
+    return g_axisNs[index];
+}
+
+bool js_get_button(int index, bool& outPressed)
+{
+    if (index < 0 || index >= g_numButtons) return false;
+    outPressed = g_buttons[index] != 0;
     return true;
 }
 
 int js_num_axes()
 {
-    return static_cast<int>(g_axes.size());
+    return g_numAxes;
 }
 
 int js_num_buttons()
 {
-    return static_cast<int>(g_buttons.size());
+    return g_numButtons;
+}
+
+// Ось [-32767..32767] в CRSF [1000..2000] мкс
+static int axisToUs(int16_t v)
+{
+    const float nf = (v >= 0) ? (static_cast<float>(v) / 32767.0f)
+                              : (static_cast<float>(v) / 32768.0f);
+    int us = static_cast<int>(1500.0f + nf * 500.0f + 0.5f);
+    if (us < 1000) us = 1000;
+    if (us > 2000) us = 2000;
+    return us;
 }
 
+int js_update_channels(JsChannelSetter set)
+{
+    if (!set) return 0;
+    int written = 0;
+    for (int i = 0; i < 4; ++i) {
+        const ChannelMap& map = g_channelMap[i];
+        if (map.presentAxis >= g_numAxes) continue;
+        int16_t v = 0;
+        js_get_axis(map.axis, v);
+        int us = axisToUs(map.invert ? static_cast<int16_t>(-v) : v);
+        uint64_t ns = js_axis_time_ns(map.axis);
+        if (us == g_channelUs[i] && ns == g_channelNs[i]) continue;
+        // Отметка — только у события после прошлой записи: старое уже измерено, а первая
+        // запись после сброса несёт состояние, а не свежее движение
+        uint64_t originNs = (g_channelUs[i] >= 0 && ns != g_channelNs[i]) ? ns : 0;
+        g_channelUs[i] = us;
+        g_channelNs[i] = ns;
+        set(static_cast<unsigned int>(i + 1), us, originNs);
+        written++;
+    }
+    return written;
+}
 
+void js_reset_channels()
+{
+    for (int i = 0; i < 4; ++i) {
+        g_channelUs[i] = -1;
+        g_channelNs[i] = 0;
+    }
+}
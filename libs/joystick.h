@@ -3,15 +3,28 @@
 #include <cstdint>
 #include <cstddef>
 
-// Простая обёртка над Linux joystick API (/dev/input/jsX)
-// Неблокирующее чтение событий, хранение текущих состояний осей/кнопок
+// Обёртка над джойстиком Linux: evdev (/dev/input/eventX) или старый joystick API (/dev/input/jsX)
+// Неблокирующее чтение событий пачкой, хранение текущих состояний осей/кнопок.
+// evdev: диапазоны осей из EVIOCGABS (min/max/flat) приводятся к [-32767..32767], у каждого
+// события сохраняется отметка ядра (CLOCK_MONOTONIC, шкала rpi_nanos()) — задержку стик -> кадр
+// можно измерить. Номера осей и кнопок — в порядке кодов, как у /dev/input/jsX того же устройства
 
-// Открыть джойстик. path по умолчанию "/dev/input/js0". Возвращает true при успехе
-bool js_open(const char* path = "/dev/input/js0");
+// Не больше осей и кнопок
+static constexpr int JS_MAX_AXES = 64;
+static constexpr int JS_MAX_BUTTONS = 512;
+
+// Открыть джойстик. path == nullptr — первое устройство evdev с осями и кнопками джойстика,
+// иначе /dev/input/js0. Тип API определяется по устройству. Возвращает true при успехе
+bool js_open(const char* path = nullptr);
 
-//БЕСПОЛЕЗНО: функция определена, но нигде не вызывается
 // Закрыть джойстик
-//void js_close();
+void js_close();
+
+// Дескриптор устройства для epoll (EPOLLIN — есть события), -1 — не открыт
+int js_fd();
+
+// true — открыт через evdev
+bool js_is_evdev();
 
 // Прочитать доступные события (неблокирующее). Возвращает true, если что-то обработано
 bool js_poll();
@@ -20,8 +33,29 @@ bool js_poll();
 // Возвращает true, если ось присутствует
 bool js_get_axis(int index, int16_t& outValue);
 
-// Получить количество известных осей/кнопок (по данным из событий)
+// Отметка ядра последнего события оси, нс в шкале rpi_nanos() (0 — неизвестна: старый API,
+// событий не было или ядро не поддерживает EVIOCSCLOCKID)
+uint64_t js_axis_time_ns(int index);
+
+// Получить текущее состояние кнопки. Возвращает true, если кнопка присутствует
+bool js_get_button(int index, bool& outPressed);
+
+// Получить количество известных осей/кнопок (evdev и JSIOCGAXES — сразу, иначе по событиям)
 int js_num_axes();
 int js_num_buttons();
 
+// Нормировка значения оси evdev из [min..max] в [-32767..32767]: центр диапазона — 0,
+// |отклонение| не больше flat — 0, за мёртвой зоной шкала начинается с 0
+int16_t js_normalize_abs(int32_t value, int32_t min, int32_t max, int32_t flat);
+
+// Запись канала RC: номер 1..16, мкс, отметка ядра события оси (0 — нет)
+typedef void (*JsChannelSetter)(unsigned int ch, int value, uint64_t originNs);
+
+// Оси в каналы 1-4 (roll, pitch, throttle, yaw), [1000..2000] мкс. Канал записывается, только
+// если его значение или отметка ядра оси изменились с прошлой записи: неподвижный стик не
+// перезаписывает команды других источников и не даёт пустых измерений задержки.
+// Отметка передаётся, только если событие оси новое. Возвращает число записанных каналов
+int js_update_channels(JsChannelSetter set);
 
+// Забыть записанные значения: следующий js_update_channels() запишет все каналы
+void js_reset_channels();
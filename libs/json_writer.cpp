@@ -0,0 +1,180 @@
+#include "json_writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+    : _buf(buffer), _cap(capacity), _len(0), _overflow(false), _depth(0), _afterKey(false)
+{
+    _first[0] = true;
+}
+
+void JsonWriter::reset()
+{
+    _len = 0;
+    _overflow = false;
+    _depth = 0;
+    _first[0] = true;
+    _afterKey = false;
+}
+
+void JsonWriter::put(char c)
+{
+    if (_len < _cap) {
+        _buf[_len++] = c;
+    } else {
+        _overflow = true;
+    }
+}
+
+void JsonWriter::put(const char* s, size_t n)
+{
+    if (n > _cap - _len) {
+        n = _cap - _len;
+        _overflow = true;
+    }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+}
+
+void JsonWriter::separator()
+{
+    if (_afterKey) {
+        _afterKey = false;
+        return;
+    }
+    if (!_first[_depth]) put(',');
+    _first[_depth] = false;
+}
+
+void JsonWriter::beginObject()
+{
+    separator();
+    put('{');
+    if (_depth + 1 < MAX_DEPTH) {
+        _first[++_depth] = true;
+    } else {
+        _overflow = true;
+    }
+}
+
+void JsonWriter::endObject()
+{
+    if (_depth > 0) _depth--;
+    put('}');
+}
+
+void JsonWriter::beginArray()
+{
+    separator();
+    put('[');
+    if (_depth + 1 < MAX_DEPTH) {
+        _first[++_depth] = true;
+    } else {
+        _overflow = true;
+    }
+}
+
+void JsonWriter::endArray()
+{
+    if (_depth > 0) _depth--;
+    put(']');
+}
+
+void JsonWriter::key(const char* name)
+{
+    separator();
+    put('"');
+    put(name, strlen(name));
+    put("\":", 2);
+    _afterKey = true;
+}
+
+void JsonWriter::uintValue(uint64_t value)
+{
+    separator();
+    char tmp[24];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    put(tmp, static_cast<size_t>(r.ptr - tmp));
+}
+
+void JsonWriter::intValue(int64_t value)
+{
+    separator();
+    char tmp[24];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    put(tmp, static_cast<size_t>(r.ptr - tmp));
+}
+
+void JsonWriter::doubleValue(double value)
+{
+    if (!std::isfinite(value)) {
+        nullValue();
+        return;
+    }
+    separator();
+    char tmp[32];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    put(tmp, static_cast<size_t>(r.ptr - tmp));
+}
+
+void JsonWriter::floatValue(float value)
+{
+    if (!std::isfinite(value)) {
+        nullValue();
+        return;
+    }
+    separator();
+    char tmp[32];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    put(tmp, static_cast<size_t>(r.ptr - tmp));
+}
+
+void JsonWriter::boolValue(bool value)
+{
+    separator();
+    if (value) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+}
+
+void JsonWriter::nullValue()
+{
+    separator();
+    put("null", 4);
+}
+
+void JsonWriter::stringValue(const char* value, size_t len)
+{
+    static const char HEX[] = "0123456789abcdef";
+    separator();
+    put('"');
+    size_t plain = 0;  // начало участка без экранирования
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        put(value + plain, i - plain);
+        plain = i + 1;
+        switch (c) {
+        case '"':  put("\\\"", 2); break;
+        case '\\': put("\\\\", 2); break;
+        case '\n': put("\\n", 2); break;
+        case '\r': put("\\r", 2); break;
+        case '\t': put("\\t", 2); break;
+        default: {
+            char esc[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0x0F]};
+            put(esc, 6);
+        }
+        }
+    }
+    put(value + plain, len - plain);
+    put('"');
+}
+
+void JsonWriter::stringValue(const char* value)
+{
+    stringValue(value, strlen(value));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Запись JSON в заранее выделенный буфер без выделений памяти
+// Числа пишутся через std::to_chars: формат не зависит от локали, double — кратчайшее
+// представление, которое читается обратно без потерь. Запятые между элементами расставляет
+// сам писатель. Если буфер кончился, запись обрезается и ok() возвращает false
+
+#include <cstddef>
+#include <cstdint>
+
+class JsonWriter {
+public:
+    static constexpr int MAX_DEPTH = 16;
+
+    JsonWriter(char* buffer, size_t capacity);
+
+    // Начать заново в том же буфере
+    void reset();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    // Ключ объекта (имя без экранирования: только идентификаторы)
+    void key(const char* name);
+
+    void uintValue(uint64_t value);
+    void intValue(int64_t value);
+    // NaN и бесконечность в JSON непредставимы — пишется null
+    void doubleValue(double value);
+    // float — кратчайшее представление float (12.6, а не 12.600000381469727)
+    void floatValue(float value);
+    void boolValue(bool value);
+    void nullValue();
+    // Строка с экранированием кавычек, обратной косой черты и управляющих символов
+    void stringValue(const char* value, size_t len);
+    void stringValue(const char* value);
+
+    const char* data() const { return _buf; }
+    size_t size() const { return _len; }
+    bool ok() const { return !_overflow; }
+
+private:
+    void separator();
+    void put(char c);
+    void put(const char* s, size_t n);
+
+    char* _buf;
+    size_t _cap;
+    size_t _len;
+    bool _overflow;
+    int _depth;
+    bool _first[MAX_DEPTH];  // на уровне вложенности ещё не было элементов
+    bool _afterKey;          // следующее значение — после ключа, без запятой
+};
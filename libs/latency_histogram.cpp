@@ -0,0 +1,83 @@
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <cstring>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _sumNs = 0;
+    _minNs = UINT64_MAX;
+    _maxNs = 0;
+}
+
+unsigned LatencyHistogram::bucketOf(uint64_t ns)
+{
+    // Первая октава — точные значения 0..SUB_BUCKETS-1
+    if (ns < SUB_BUCKETS) return static_cast<unsigned>(ns);
+    unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(ns));
+    unsigned octave = msb - SUB_BITS + 1;
+    unsigned sub = static_cast<unsigned>(ns >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return octave * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperNs(unsigned bucket)
+{
+    unsigned octave = bucket / SUB_BUCKETS;
+    unsigned sub = bucket % SUB_BUCKETS;
+    if (octave == 0) return sub;
+    unsigned shift = octave - 1;
+    uint64_t base = static_cast<uint64_t>(SUB_BUCKETS + sub) << shift;
+    return base + ((1ull << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns)
+{
+    _buckets[bucketOf(ns)]++;
+    _count++;
+    _sumNs += ns;
+    if (ns < _minNs) _minNs = ns;
+    if (ns > _maxNs) _maxNs = ns;
+}
+
+uint64_t LatencyHistogram::percentileNs(double p) const
+{
+    if (_count == 0) return 0;
+    if (p < 0.0) p = 0.0;
+    if (p > 100.0) p = 100.0;
+
+    // Ранг измерения (1.._count), до которого нужно досчитать
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(_count)));
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < BUCKETS; ++b) {
+        seen += _buckets[b];
+        if (seen >= rank) {
+            uint64_t upper = bucketUpperNs(b);
+            if (upper > _maxNs) upper = _maxNs;
+            if (upper < minNs()) upper = minNs();
+            return upper;
+        }
+    }
+    return _maxNs;
+}
+
+void LatencyHistogram::cumulativeCounts(const uint64_t* boundsNs, unsigned n, uint64_t* out) const
+{
+    uint64_t seen = 0;
+    unsigned b = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        while (b < BUCKETS && bucketUpperNs(b) <= boundsNs[i]) {
+            seen += _buckets[b];
+            b++;
+        }
+        out[i] = seen;
+    }
+}
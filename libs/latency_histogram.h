@@ -0,0 +1,45 @@
+#pragma once
+
+// Гистограмма задержек с логарифмическими корзинами (без выделения памяти)
+// Каждая степень двойки делится на SUB_BUCKETS корзин, поэтому относительная
+// ошибка перцентиля не больше 1/SUB_BUCKETS при любом масштабе (от нс до секунд)
+
+#include <cstdint>
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 3;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BITS;  // 8 корзин на октаву, ошибка <= 12.5%
+    static constexpr unsigned OCTAVES = 64 - SUB_BITS + 1;
+    static constexpr unsigned BUCKETS = OCTAVES * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    // Добавить одно измерение, нс
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t count() const { return _count; }
+    uint64_t minNs() const { return _count ? _minNs : 0; }
+    uint64_t maxNs() const { return _maxNs; }
+    uint64_t meanNs() const { return _count ? _sumNs / _count : 0; }
+    uint64_t sumNs() const { return _sumNs; }
+    // Перцентиль p (0..100): верхняя граница корзины, но не больше максимума
+    uint64_t percentileNs(double p) const;
+
+    // Накопленные счётчики для внешних границ (по возрастанию): out[i] — измерений в корзинах,
+    // верхняя граница которых не больше boundsNs[i]. Корзина, пересекающая границу, в out[i]
+    // не попадает, поэтому счёт занижен не больше чем на одну корзину (экспорт в Prometheus)
+    void cumulativeCounts(const uint64_t* boundsNs, unsigned n, uint64_t* out) const;
+
+    // Номер корзины и её верхняя граница (для тестов и экспорта)
+    static unsigned bucketOf(uint64_t ns);
+    static uint64_t bucketUpperNs(unsigned bucket);
+
+private:
+    uint32_t _buckets[BUCKETS];
+    uint64_t _count;
+    uint64_t _sumNs;
+    uint64_t _minNs;
+    uint64_t _maxNs;
+};
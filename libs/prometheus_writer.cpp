@@ -0,0 +1,121 @@
+#include "prometheus_writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+PrometheusWriter::PrometheusWriter(char* buffer, size_t capacity)
+    : _buf(buffer), _cap(capacity), _len(0), _overflow(false)
+{
+}
+
+void PrometheusWriter::put(const char* s, size_t n)
+{
+    if (n > _cap - _len) {
+        n = _cap - _len;
+        _overflow = true;
+    }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+}
+
+void PrometheusWriter::put(const char* s)
+{
+    put(s, strlen(s));
+}
+
+void PrometheusWriter::putUint(uint64_t value)
+{
+    char tmp[24];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    put(tmp, static_cast<size_t>(r.ptr - tmp));
+}
+
+void PrometheusWriter::putDouble(double value)
+{
+    if (std::isnan(value)) {
+        put("NaN", 3);
+    } else if (std::isinf(value)) {
+        put(value > 0 ? "+Inf" : "-Inf");
+    } else {
+        char tmp[32];
+        std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+        put(tmp, static_cast<size_t>(r.ptr - tmp));
+    }
+}
+
+void PrometheusWriter::series(const char* name, const char* suffix, const char* labels, const char* extra)
+{
+    put(name);
+    if (suffix) put(suffix);
+    bool hasLabels = labels && *labels;
+    if (hasLabels || extra) {
+        put("{", 1);
+        if (hasLabels) put(labels);
+        if (hasLabels && extra) put(",", 1);
+        if (extra) put(extra);
+        put("}", 1);
+    }
+    put(" ", 1);
+}
+
+void PrometheusWriter::family(const char* name, const char* type, const char* help)
+{
+    put("# HELP ", 7);
+    put(name);
+    put(" ", 1);
+    put(help);
+    put("\n# TYPE ", 8);
+    put(name);
+    put(" ", 1);
+    put(type);
+    put("\n", 1);
+}
+
+void PrometheusWriter::sample(const char* name, const char* labels, uint64_t value)
+{
+    series(name, nullptr, labels, nullptr);
+    putUint(value);
+    put("\n", 1);
+}
+
+void PrometheusWriter::sampleInt(const char* name, const char* labels, int64_t value)
+{
+    series(name, nullptr, labels, nullptr);
+    char tmp[24];
+    std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    put(tmp, static_cast<size_t>(r.ptr - tmp));
+    put("\n", 1);
+}
+
+void PrometheusWriter::sampleDouble(const char* name, const char* labels, double value)
+{
+    series(name, nullptr, labels, nullptr);
+    putDouble(value);
+    put("\n", 1);
+}
+
+void PrometheusWriter::histogram(const char* name, const char* labels, const double* bounds,
+                                 const uint64_t* cumulative, unsigned n, uint64_t count, double sum)
+{
+    char le[48];
+    for (unsigned i = 0; i < n; ++i) {
+        memcpy(le, "le=\"", 4);
+        // Границы — без экспоненты: значение метки le одинаково при любых границах
+        std::to_chars_result r = std::to_chars(le + 4, le + sizeof(le) - 2, bounds[i], std::chars_format::fixed);
+        r.ptr[0] = '"';
+        r.ptr[1] = '\0';
+        series(name, "_bucket", labels, le);
+        putUint(cumulative[i]);
+        put("\n", 1);
+    }
+    series(name, "_bucket", labels, "le=\"+Inf\"");
+    putUint(count);
+    put("\n", 1);
+    series(name, "_sum", labels, nullptr);
+    putDouble(sum);
+    put("\n", 1);
+    series(name, "_count", labels, nullptr);
+    putUint(count);
+    put("\n", 1);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Текстовый формат экспозиции Prometheus (version 0.0.4) в заранее выделенный буфер
+// Числа пишутся через std::to_chars. Семейство метрик открывается family() (# HELP и # TYPE),
+// затем идут его строки sample()/histogram(). Если буфер кончился, ok() возвращает false
+
+#include <cstddef>
+#include <cstdint>
+
+class PrometheusWriter {
+public:
+    PrometheusWriter(char* buffer, size_t capacity);
+
+    // Заголовок семейства: type — "counter", "gauge" или "histogram"
+    void family(const char* name, const char* type, const char* help);
+    // Строка значения; labels — готовый текст меток без скобок (type="0x08") или nullptr
+    void sample(const char* name, const char* labels, uint64_t value);
+    void sampleInt(const char* name, const char* labels, int64_t value);
+    void sampleDouble(const char* name, const char* labels, double value);
+    // Строки гистограммы name_bucket/_sum/_count. bounds — верхние границы корзин по возрастанию
+    // (в единицах метрики), cumulative[i] — измерений не больше bounds[i]
+    void histogram(const char* name, const char* labels, const double* bounds, const uint64_t* cumulative,
+                   unsigned n, uint64_t count, double sum);
+
+    const char* data() const { return _buf; }
+    size_t size() const { return _len; }
+    bool ok() const { return !_overflow; }
+
+private:
+    void put(const char* s, size_t n);
+    void put(const char* s);
+    void putUint(uint64_t value);
+    void putDouble(double value);
+    // name{labels,extra} — метки объединяются через запятую
+    void series(const char* name, const char* suffix, const char* labels, const char* extra);
+
+    char* _buf;
+    size_t _cap;
+    size_t _len;
+    bool _overflow;
+};
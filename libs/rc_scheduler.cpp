@@ -0,0 +1,95 @@
+#include "rc_scheduler.h"
+#include "rpi_hal.h"
+
+#include <cerrno>
+#include <time.h>
+
+RcScheduler::RcScheduler(uint32_t periodUs)
+    : _basePeriodNs(static_cast<uint64_t>(MAX_PERIOD_US) * 1000u), _periodNs(_basePeriodNs),
+      _deadlineNs(0), _lastSyncNs(0), _stats{}
+{
+    setPeriodUs(periodUs);
+    resetStats();
+}
+
+bool RcScheduler::setPeriodUs(uint32_t periodUs)
+{
+    if (periodUs < MIN_PERIOD_US || periodUs > MAX_PERIOD_US) {
+        return false;
+    }
+    _basePeriodNs = static_cast<uint64_t>(periodUs) * 1000u;
+    if (!_stats.syncActive) _periodNs = _basePeriodNs;
+    return true;
+}
+
+void RcScheduler::resetStats()
+{
+    bool syncActive = _stats.syncActive;
+    _stats = RcSchedulerStats{};
+    _stats.jitterMinNs = INT64_MAX;
+    _stats.syncActive = syncActive;
+}
+
+void RcScheduler::applySync(uint32_t intervalNs, int32_t offsetNs, uint64_t nowNs)
+{
+    if (intervalNs < MIN_PERIOD_US * 1000u || intervalNs > MAX_PERIOD_US * 1000u) {
+        return; // модуль прислал темп вне поддерживаемого диапазона
+    }
+    _stats.syncFrames++;
+    _stats.syncOffsetNs = offsetNs;
+    _stats.syncActive = true;
+    _lastSyncNs = nowNs;
+    _periodNs = intervalNs;
+
+    // Сдвигаем фазу сетки на часть измеренного сдвига, не более полупериода за раз
+    int64_t shift = static_cast<int64_t>(offsetNs) / SYNC_PHASE_GAIN_DIV;
+    int64_t limit = static_cast<int64_t>(_periodNs / 2);
+    if (shift > limit) shift = limit;
+    if (shift < -limit) shift = -limit;
+    _deadlineNs = static_cast<uint64_t>(static_cast<int64_t>(_deadlineNs) + shift);
+}
+
+uint64_t RcScheduler::nowNs()
+{
+    return rpi_nanos();
+}
+
+void RcScheduler::start()
+{
+    _deadlineNs = nowNs() + _periodNs;
+}
+
+void RcScheduler::waitNext()
+{
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(_deadlineNs / 1000000000ull);
+    ts.tv_nsec = static_cast<long>(_deadlineNs % 1000000000ull);
+    // Абсолютный дедлайн: прерывание сигналом просто повторяет сон до той же точки
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+    onWake(nowNs());
+}
+
+void RcScheduler::onWake(uint64_t nowNs)
+{
+    int64_t late = static_cast<int64_t>(nowNs - _deadlineNs);
+    if (late < 0) late = 0; // проснулись раньше (не должно случаться с TIMER_ABSTIME)
+
+    _stats.ticks++;
+    _stats.jitterLastNs = late;
+    _stats.jitterSumNs += static_cast<uint64_t>(late);
+    if (late < _stats.jitterMinNs) _stats.jitterMinNs = late;
+    if (late > _stats.jitterMaxNs) _stats.jitterMaxNs = late;
+
+    // Опоздали больше чем на период: пропущенные тики не догоняем пачкой,
+    // а переходим на ближайший будущий дедлайн той же сетки
+    uint64_t missed = static_cast<uint64_t>(late) / _periodNs;
+    _stats.overruns += missed;
+    _deadlineNs += (missed + 1) * _periodNs;
+
+    // Модуль перестал присылать синхронизацию — возвращаемся к своему периоду
+    if (_stats.syncActive && nowNs - _lastSyncNs > SYNC_TIMEOUT_NS) {
+        _stats.syncActive = false;
+        _periodNs = _basePeriodNs;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Планировщик отправки RC-кадров по абсолютным дедлайнам
+// Период задаётся в микросекундах (50..1000 Гц), сон через clock_nanosleep(TIMER_ABSTIME),
+// поэтому ошибка одного тика не накапливается в дрейф периода
+
+#include <cstdint>
+
+// Статистика планировщика: опоздание пробуждения относительно дедлайна и пропуски
+struct RcSchedulerStats {
+    uint64_t ticks;        // количество отработанных тиков
+    uint64_t overruns;     // количество пропущенных дедлайнов (тик пришёл позже следующего)
+    int64_t jitterLastNs;  // опоздание последнего тика, нс
+    int64_t jitterMinNs;   // минимальное опоздание, нс
+    int64_t jitterMaxNs;   // максимальное опоздание, нс
+    uint64_t jitterSumNs;  // сумма опозданий для среднего, нс
+    uint64_t syncFrames;   // принятые кадры синхронизации от TX-модуля
+    int64_t syncOffsetNs;  // последний сдвиг фазы от модуля, нс
+    bool syncActive;       // темп задаёт модуль (иначе — настроенный период)
+};
+
+class RcScheduler {
+public:
+    static constexpr uint32_t MIN_PERIOD_US = 1000;   // 1000 Гц
+    static constexpr uint32_t MAX_PERIOD_US = 20000;  // 50 Гц
+
+    explicit RcScheduler(uint32_t periodUs);
+
+    // Доля сдвига фазы, применяемая за один кадр синхронизации (1/2: сглаживаем шум измерения)
+    static constexpr int SYNC_PHASE_GAIN_DIV = 2;
+    // Без кадров синхронизации дольше этого возвращаемся к настроенному периоду
+    static constexpr uint64_t SYNC_TIMEOUT_NS = 1000000000ull;
+
+    // Установить период; возвращает false, если он вне диапазона MIN..MAX
+    bool setPeriodUs(uint32_t periodUs);
+    uint32_t getPeriodUs() const { return static_cast<uint32_t>(_periodNs / 1000u); }
+    uint64_t getPeriodNs() const { return _periodNs; }
+
+    // Фазовая подстройка по кадру OPENTX_SYNC: интервал пакетов модуля и сдвиг фазы.
+    // offsetNs > 0 — RC-кадр пришёл в модуль раньше нужного, следующий дедлайн сдвигается позже
+    void applySync(uint32_t intervalNs, int32_t offsetNs, uint64_t nowNs);
+
+    // Привязать сетку дедлайнов к текущему моменту
+    void start();
+    // Заснуть до следующего дедлайна и учесть пробуждение в статистике
+    void waitNext();
+    // Учёт пробуждения в момент nowNs: статистика и сдвиг дедлайна по сетке
+    void onWake(uint64_t nowNs);
+
+    uint64_t nextDeadlineNs() const { return _deadlineNs; }
+    const RcSchedulerStats& getStats() const { return _stats; }
+    void resetStats();
+
+    // Текущее время rpi_nanos(). Сон идёт по настоящим CLOCK_MONOTONIC,
+    // поэтому waitNext() имеет смысл только с источником времени по умолчанию
+    static uint64_t nowNs();
+
+private:
+    uint64_t _basePeriodNs;   // настроенный период (без синхронизации)
+    uint64_t _periodNs;       // текущий период
+    uint64_t _deadlineNs;
+    uint64_t _lastSyncNs;
+    RcSchedulerStats _stats;
+};
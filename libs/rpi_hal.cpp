@@ -5,33 +5,94 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <alloca.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
 
-using ClockSteady = std::chrono::steady_clock;
-static const auto processStartTime = ClockSteady::now();
+static RpiClockSource clockSource = nullptr;
 
 // Время
+static inline uint64_t monotonicNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t rpi_nanos() {
+    return clockSource ? clockSource() : monotonicNanos();
+}
+
+uint64_t rpi_micros() {
+    return rpi_nanos() / 1000ull;
+}
+
 uint32_t rpi_millis() {
-    // Возвращает миллисекунды с момента запуска процесса
-    auto now = ClockSteady::now();
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - processStartTime).count();
-    return static_cast<uint32_t>(ms & 0xFFFFFFFFu);
+    return static_cast<uint32_t>((rpi_nanos() / 1000000ull) & 0xFFFFFFFFu);
 }
 
-//БЕСПОЛЕЗНО: функция определена, но нигде не используется
-/*
-uint32_t rpi_micros() {
-    // Возвращает микросекунды с момента запуска процесса
-    auto now = ClockSteady::now();
-    auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - processStartTime).count();
-    return static_cast<uint32_t>(us & 0xFFFFFFFFu);
+void rpi_set_clock_source(RpiClockSource source) {
+    clockSource = source;
 }
-*/
 
 void rpi_delay_ms(uint32_t ms) {
     // Простаивает текущий поток на указанное количество миллисекунд
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
 
+// Реалтайм-профиль
+bool rpi_rt_set_fifo(int priority) {
+    struct sched_param sp{};
+    sp.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+}
+
+bool rpi_rt_pin_cpu(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool rpi_rt_exclude_cpu(int cpu) {
+    // Текущая привязка (taskset, cpuset cgroup) без выделенного под RT-цикл CPU
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return false;
+    CPU_CLR(cpu, &set);
+    if (CPU_COUNT(&set) == 0) return false;  // других CPU нет
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool rpi_rt_lock_memory(size_t heapReserve) {
+    // Куча не возвращается системе и не уходит в отдельные mmap,
+    // иначе освобождённые страницы снова дадут page fault при следующем malloc
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) return false;
+
+    if (heapReserve > 0) {
+        // Затрагиваем страницы кучи один раз: после free() они остаются в процессе
+        volatile unsigned char* p = static_cast<volatile unsigned char*>(malloc(heapReserve));
+        if (p == nullptr) return false;
+        const long page = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < heapReserve; i += static_cast<size_t>(page)) p[i] = 0;
+        free(const_cast<unsigned char*>(p));
+    }
+    return true;
+}
+
+void rpi_rt_prefault_stack(size_t bytes) {
+    // Массив на стеке текущего потока: запись по странице материализует стек заранее
+    volatile unsigned char* p = static_cast<volatile unsigned char*>(alloca(bytes));
+    const long page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < bytes; i += static_cast<size_t>(page)) p[i] = 0;
+}
+
 // Простые файловые утилиты
 bool rpi_write_text_file(const std::string &path, const std::string &text) {
     std::ofstream f(path);
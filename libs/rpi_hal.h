@@ -3,15 +3,30 @@
 // Простой HAL для Raspberry Pi 5: время, GPIO, PWM
 // Все функции снабжены русскими комментариями
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
 // Время
-uint32_t rpi_millis();        // миллисекунды с момента запуска процесса
-//БЕСПОЛЕЗНО: функция определена, но нигде не используется
-//uint32_t rpi_micros();
+// Основная шкала — 64-битные наносекунды CLOCK_MONOTONIC (clock_gettime через vDSO, без системного вызова).
+// Значения сравнимы между процессами на одной машине
+uint64_t rpi_nanos();         // наносекунды монотонных часов
+uint64_t rpi_micros();        // микросекунды монотонных часов
+uint32_t rpi_millis();        // миллисекунды монотонных часов, 32 бита (устаревшее, переполнение ~49 сут)
 void rpi_delay_ms(uint32_t);  // пауза в миллисекундах
 
+// Подмена источника времени (для тестов). nullptr — системные часы
+typedef uint64_t (*RpiClockSource)();
+void rpi_set_clock_source(RpiClockSource source);
+
+// Реалтайм-профиль потока и процесса (требует root или CAP_SYS_NICE/CAP_IPC_LOCK)
+// Все функции возвращают false при ошибке и не прерывают работу приложения
+bool rpi_rt_set_fifo(int priority);          // SCHED_FIFO для текущего потока, priority 1..99
+bool rpi_rt_pin_cpu(int cpu);                // привязать текущий поток к одному CPU
+bool rpi_rt_exclude_cpu(int cpu);            // текущий поток — на все CPU, кроме cpu
+bool rpi_rt_lock_memory(size_t heapReserve); // mlockall + удержание heapReserve байт кучи
+void rpi_rt_prefault_stack(size_t bytes);    // заранее затронуть bytes байт стека
+
 // GPIO режимы
 enum class RpiGpioMode { Input, Output };
 
@@ -0,0 +1,122 @@
+#include "telemetry_dispatcher.h"
+
+#include <algorithm>
+#include <time.h>
+
+static uint64_t monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+TelemetryDispatcher::TelemetryDispatcher()
+    : _shm(nullptr), _history(nullptr), _handler(nullptr), _context(nullptr),
+      _maxLatencyNs(DEFAULT_MAX_LATENCY_NS), _maxBatch(DEFAULT_MAX_BATCH), _dropped(0), _stop(false)
+{
+    clearFrameTypes();
+}
+
+TelemetryDispatcher::~TelemetryDispatcher()
+{
+    stop();
+}
+
+bool TelemetryDispatcher::start(const TelemetryShm& shm, const TelemetryHistory& history,
+                                BatchHandler handler, void* context)
+{
+    stop();
+    if (!shm.isOpen() || !history.isOpen() || !handler) return false;
+
+    _shm = &shm;
+    _history = &history;
+    _handler = handler;
+    _context = context;
+    _batch.resize(history.capacity());  // пачка не больше кольца; память выделяется один раз
+    _dropped.store(0);
+    _stop.store(false);
+    // Счётчик и курсор берём до запуска потока: кадры сразу после start() не теряются
+    _thread = std::thread(&TelemetryDispatcher::run, this,
+                          shm.frameCounter(TelemetryShm::ANY_FRAME), history.head());
+    return true;
+}
+
+void TelemetryDispatcher::stop()
+{
+    if (_thread.joinable()) {
+        _stop.store(true);
+        _thread.join();
+    }
+    _shm = nullptr;
+    _history = nullptr;
+}
+
+void TelemetryDispatcher::setFrameType(int frameType, bool enabled)
+{
+    if (frameType == TelemetryShm::ANY_FRAME) {
+        for (std::atomic<uint64_t>& word : _frameTypes) {
+            word.store(enabled ? ~0ull : 0ull, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (frameType < 0 || frameType > 255) return;
+    uint64_t bit = 1ull << (frameType & 63);
+    if (enabled) {
+        _frameTypes[frameType >> 6].fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        _frameTypes[frameType >> 6].fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void TelemetryDispatcher::clearFrameTypes()
+{
+    for (std::atomic<uint64_t>& word : _frameTypes) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TelemetryDispatcher::accepts(uint32_t frameType) const
+{
+    if (frameType > 255) return false;
+    return (_frameTypes[frameType >> 6].load(std::memory_order_relaxed) >> (frameType & 63)) & 1u;
+}
+
+void TelemetryDispatcher::run(uint32_t counter, uint64_t cursor)
+{
+    size_t pending = 0;
+    uint64_t firstNs = 0;  // когда в пачку попала первая запись
+    while (!_stop.load(std::memory_order_relaxed)) {
+        size_t maxBatch = std::min(_maxBatch.load(std::memory_order_relaxed), _batch.size());
+        uint64_t maxLatencyNs = _maxLatencyNs.load(std::memory_order_relaxed);
+
+        // Счётчик до чтения: публикация после чтения не даст уснуть
+        counter = _shm->frameCounter(TelemetryShm::ANY_FRAME);
+        if (pending < maxBatch) {
+            uint64_t lost = 0;
+            size_t got = _history->read(cursor, &_batch[pending], maxBatch - pending, &cursor, &lost);
+            _dropped.fetch_add(lost, std::memory_order_relaxed);
+            // Кадры без подписки в пачку не попадают
+            size_t kept = pending;
+            for (size_t i = pending; i < pending + got; ++i) {
+                if (accepts(_batch[i].frameType)) {
+                    if (kept != i) _batch[kept] = _batch[i];
+                    kept++;
+                }
+            }
+            if (pending == 0 && kept > 0) firstNs = monotonicNs();
+            pending = kept;
+        }
+
+        uint64_t now = monotonicNs();
+        if (pending > 0 && (pending >= maxBatch || now - firstNs >= maxLatencyNs)) {
+            _handler(_batch.data(), pending, _context);
+            pending = 0;
+            continue;
+        }
+        if (cursor < _history->head()) continue;  // в кольце ещё есть непрочитанные записи
+
+        uint64_t waitNs = STOP_CHECK_NS;
+        if (pending > 0) waitNs = std::min(waitNs, firstNs + maxLatencyNs - now);
+        _shm->waitFrame(TelemetryShm::ANY_FRAME, counter, waitNs, &counter);
+    }
+}
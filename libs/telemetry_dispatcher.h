@@ -0,0 +1,66 @@
+#pragma once
+
+// Доставка принятых кадров пачками: поток забирает записи истории телеметрии по курсору,
+// оставляет кадры подписанных типов и отдаёт их обработчику одной пачкой — когда пачка
+// заполнена или первая запись в ней ждёт дольше maxLatency. Обработчику, которому нужна
+// блокировка (GIL Python), достаточно взять её один раз на пачку, а не на каждый кадр.
+// Новые записи поток ждёт на futex сегмента TelemetryShm, без опроса
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "telemetry_shm.h"
+#include "telemetry_history.h"
+
+class TelemetryDispatcher {
+public:
+    // Обработчик пачки: записи по возрастанию позиции, count > 0
+    typedef void (*BatchHandler)(const TelemetryHistoryRecord* records, size_t count, void* context);
+
+    static constexpr uint64_t DEFAULT_MAX_LATENCY_NS = 10000000ull;  // 10 мс
+    static constexpr size_t DEFAULT_MAX_BATCH = 64;
+    // Как часто поток проверяет флаг остановки, если кадров нет
+    static constexpr uint64_t STOP_CHECK_NS = 100000000ull;  // 100 мс
+
+    TelemetryDispatcher();
+    ~TelemetryDispatcher();
+    TelemetryDispatcher(const TelemetryDispatcher&) = delete;
+    TelemetryDispatcher& operator=(const TelemetryDispatcher&) = delete;
+
+    // Запустить поток доставки кадров, принятых после вызова. Сегменты должны быть открыты
+    // и жить дольше диспетчера. Обработчик вызывается на потоке диспетчера
+    bool start(const TelemetryShm& shm, const TelemetryHistory& history,
+               BatchHandler handler, void* context);
+    // Остановить поток (ждёт текущий обработчик и не дольше STOP_CHECK_NS)
+    void stop();
+    bool isRunning() const { return _thread.joinable(); }
+
+    // Подписка на тип кадра CRSF (TelemetryShm::ANY_FRAME — на все). По умолчанию подписок нет
+    void setFrameType(int frameType, bool enabled);
+    void clearFrameTypes();
+    // Максимальная задержка первой записи пачки и максимальный размер пачки
+    // (ограничен ёмкостью истории)
+    void setMaxLatencyNs(uint64_t ns) { _maxLatencyNs.store(ns, std::memory_order_relaxed); }
+    void setMaxBatch(size_t count) { _maxBatch.store(count ? count : 1, std::memory_order_relaxed); }
+
+    // Записей, вытесненных из истории до того, как диспетчер их прочитал
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    bool accepts(uint32_t frameType) const;
+    void run(uint32_t counter, uint64_t cursor);
+
+    const TelemetryShm* _shm;
+    const TelemetryHistory* _history;
+    BatchHandler _handler;
+    void* _context;
+    std::atomic<uint64_t> _frameTypes[4];  // битовая маска подписок, 256 типов
+    std::atomic<uint64_t> _maxLatencyNs;
+    std::atomic<size_t> _maxBatch;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _stop;
+    std::vector<TelemetryHistoryRecord> _batch;
+    std::thread _thread;
+};
@@ -0,0 +1,129 @@
+#include "telemetry_fanout.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+TelemetryFanout::TelemetryFanout()
+    : _fd(-1), _dest(), _destCount(0), _sent(0), _dropped(0)
+{
+}
+
+TelemetryFanout::~TelemetryFanout()
+{
+    close();
+}
+
+bool TelemetryFanout::addDestination(const char* spec)
+{
+    if (!spec || _destCount >= MAX_DESTINATIONS) return false;
+    const char* colon = strrchr(spec, ':');
+    if (!colon || colon == spec) return false;
+
+    char host[INET_ADDRSTRLEN];
+    size_t hostLen = static_cast<size_t>(colon - spec);
+    if (hostLen >= sizeof(host)) return false;
+    memcpy(host, spec, hostLen);
+    host[hostLen] = '\0';
+
+    char* end = nullptr;
+    unsigned long port = strtoul(colon + 1, &end, 10);
+    if (end == colon + 1 || *end != '\0' || port == 0 || port > 65535) return false;
+
+    sockaddr_in& dest = _dest[_destCount];
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host, &dest.sin_addr) != 1) return false;
+    _destCount++;
+    return true;
+}
+
+bool TelemetryFanout::open(int multicastTtl, bool multicastLoop)
+{
+    close();
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    unsigned char ttl = static_cast<unsigned char>(std::min(std::max(multicastTtl, 0), 255));
+    unsigned char loop = multicastLoop ? 1 : 0;
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    _packets.assign(MAX_BATCH * TELEMETRY_WIRE_SIZE, 0);
+    _iov.assign(MAX_BATCH, iovec());
+    _msgs.assign(MAX_BATCH * MAX_DESTINATIONS, mmsghdr());
+    _fd = fd;
+    return true;
+}
+
+void TelemetryFanout::close()
+{
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+    _fd = -1;
+}
+
+size_t TelemetryFanout::send(const TelemetryHistoryRecord* records, size_t count)
+{
+    if (_fd < 0 || _destCount == 0) return 0;
+    size_t sentTotal = 0;
+    uint64_t lost = 0;
+
+    while (count > 0) {
+        size_t chunk = std::min(count, MAX_BATCH);
+        // Пакет на запись, сообщение на пару (запись, адресат) с общим iovec
+        size_t nmsgs = 0;
+        for (size_t r = 0; r < chunk; ++r) {
+            uint8_t* packet = &_packets[r * TELEMETRY_WIRE_SIZE];
+            const TelemetryHistoryRecord& rec = records[r];
+            _iov[r].iov_base = packet;
+            _iov[r].iov_len = telemetryWireEncode(packet, rec.snapshot, rec.pos, rec.timestampNs, rec.frameType);
+            for (size_t d = 0; d < _destCount; ++d) {
+                msghdr& hdr = _msgs[nmsgs++].msg_hdr;
+                memset(&hdr, 0, sizeof(hdr));
+                hdr.msg_name = &_dest[d];
+                hdr.msg_namelen = sizeof(sockaddr_in);
+                hdr.msg_iov = &_iov[r];
+                hdr.msg_iovlen = 1;
+            }
+        }
+
+        size_t done = 0;
+        while (done < nmsgs) {
+            int n = sendmmsg(_fd, &_msgs[done], static_cast<unsigned int>(nmsgs - done), 0);
+            if (n > 0) {
+                done += static_cast<size_t>(n);
+                sentTotal += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Буфер сокета полон: остаток пачки отбрасываем, поток не ждёт
+                lost += nmsgs - done;
+                done = nmsgs;
+            } else {
+                // Ошибка первого сообщения (адресат недоступен): пропускаем только его
+                lost++;
+                done++;
+            }
+        }
+        records += chunk;
+        count -= chunk;
+    }
+
+    _sent.fetch_add(sentTotal, std::memory_order_relaxed);
+    _dropped.fetch_add(lost, std::memory_order_relaxed);
+    return sentTotal;
+}
+
+void TelemetryFanout::onBatch(const TelemetryHistoryRecord* records, size_t count, void* context)
+{
+    static_cast<TelemetryFanout*>(context)->send(records, count);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// Рассылка телеметрии по UDP: датаграмма на каждый разобранный кадр всем адресатам
+// (unicast, multicast, в том числе на этот же хост). Несколько процессов наземной станции
+// получают один поток, не опрашивая HTTP и файлы. Датаграмма — пакет telemetry_wire
+// (заголовок и снимок после кадра), seq — позиция кадра в истории телеметрии: пропуск
+// номеров означает потерянные кадры.
+// Записи истории приходят пачкой от TelemetryDispatcher, вся пачка уходит одним sendmmsg.
+// Сокет неблокирующий: при переполнении буфера датаграммы отбрасываются, поток не ждёт
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "telemetry_history.h"
+#include "telemetry_wire.h"
+
+class TelemetryFanout {
+public:
+    static constexpr size_t MAX_DESTINATIONS = 8;
+    // Записей в одном sendmmsg (пачка длиннее уходит частями)
+    static constexpr size_t MAX_BATCH = 64;
+
+    TelemetryFanout();
+    ~TelemetryFanout();
+    TelemetryFanout(const TelemetryFanout&) = delete;
+    TelemetryFanout& operator=(const TelemetryFanout&) = delete;
+
+    // Адресат "адрес:порт" (IPv4), multicast (224.0.0.0/4) определяется по адресу.
+    // false — ошибка разбора или адресатов уже MAX_DESTINATIONS
+    bool addDestination(const char* spec);
+    size_t destinationCount() const { return _destCount; }
+
+    // Открыть сокет. multicastTtl — время жизни multicast-датаграмм (1 — только локальная сеть),
+    // multicastLoop — доставлять multicast процессам этого же хоста
+    bool open(int multicastTtl = 1, bool multicastLoop = true);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    // Отправить записи истории всем адресатам; возвращает число отправленных датаграмм
+    size_t send(const TelemetryHistoryRecord* records, size_t count);
+    // Обработчик пачки TelemetryDispatcher, context — TelemetryFanout*
+    static void onBatch(const TelemetryHistoryRecord* records, size_t count, void* context);
+
+    // Отправленные датаграммы и отброшенные (буфер сокета полон, ошибка отправки)
+    uint64_t sent() const { return _sent.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    int _fd;
+    sockaddr_in _dest[MAX_DESTINATIONS];
+    size_t _destCount;
+    // Буферы пакетов и сообщений выделяются один раз в open()
+    std::vector<uint8_t> _packets;
+    std::vector<iovec> _iov;
+    std::vector<mmsghdr> _msgs;
+    std::atomic<uint64_t> _sent;
+    std::atomic<uint64_t> _dropped;
+};
@@ -0,0 +1,206 @@
+#include "telemetry_history.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Записи лежат на отдельных кэш-линиях после заголовка
+static size_t entriesOffset()
+{
+    return (sizeof(TelemetryHistoryHeader) + 63u) & ~static_cast<size_t>(63u);
+}
+
+TelemetryHistory::TelemetryHistory()
+    : _base(nullptr), _size(0), _hdr(nullptr), _entries(nullptr), _mask(0)
+{
+}
+
+TelemetryHistory::~TelemetryHistory()
+{
+    close();
+}
+
+bool TelemetryHistory::create(const char* name, uint32_t capacity)
+{
+    close();
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return false;
+
+    size_t size = entriesOffset() + static_cast<size_t>(capacity) * sizeof(TelemetryHistoryEntry);
+
+    // Сегмент прошлого запуска переиспользуется, только если совпадают размер и формат:
+    // менять размер под отображениями читателей нельзя (SIGBUS при уменьшении)
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd >= 0) {
+        struct stat st;
+        TelemetryHistoryHeader old;
+        bool reuse = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == size &&
+                     pread(fd, &old, sizeof(old), 0) == static_cast<ssize_t>(sizeof(old)) &&
+                     old.version == VERSION && old.entrySize == sizeof(TelemetryHistoryEntry) &&
+                     old.capacity == capacity && old.schemaHash == TELEMETRY_SCHEMA_HASH;
+        if (reuse) {
+            // Сегмент от прежних версий мог остаться доступным на запись всем: права только сужаем
+            if ((st.st_mode & 022) != 0) fchmod(fd, st.st_mode & 0755);
+        } else {
+            ::close(fd);
+            shm_unlink(name);
+            fd = -1;
+        }
+    }
+    bool created = fd < 0;
+    if (created) {
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) return false;
+        if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+            ::close(fd);
+            shm_unlink(name);
+            return false;
+        }
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    _base = base;
+    _size = size;
+    _hdr = static_cast<TelemetryHistoryHeader*>(base);
+    _entries = reinterpret_cast<TelemetryHistoryEntry*>(static_cast<uint8_t*>(base) + entriesOffset());
+    _mask = capacity - 1;
+
+    // Записи прошлого запуска недействительны: обнуляем метки. В переиспользованном сегменте
+    // позиция записи продолжается, новый начинается с 0
+    _hdr->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t start = created ? 0 : _hdr->writePos.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        _entries[i].stamp.store(0, std::memory_order_relaxed);
+    }
+    _hdr->version = VERSION;
+    _hdr->entrySize = static_cast<uint16_t>(sizeof(TelemetryHistoryEntry));
+    _hdr->capacity = capacity;
+    _hdr->writerPid = static_cast<uint32_t>(getpid());
+    _hdr->schemaHash = TELEMETRY_SCHEMA_HASH;
+    _hdr->writePos.store(start, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _hdr->magic = MAGIC;
+    return true;
+}
+
+bool TelemetryHistory::open(const char* name)
+{
+    close();
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(TelemetryHistoryHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    TelemetryHistoryHeader* hdr = static_cast<TelemetryHistoryHeader*>(base);
+    uint32_t capacity = hdr->capacity;
+    if (hdr->magic != MAGIC || hdr->version != VERSION ||
+        hdr->entrySize != sizeof(TelemetryHistoryEntry) || hdr->schemaHash != TELEMETRY_SCHEMA_HASH ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        entriesOffset() + static_cast<size_t>(capacity) * sizeof(TelemetryHistoryEntry) > size) {
+        munmap(base, size);
+        return false;
+    }
+
+    _base = base;
+    _size = size;
+    _hdr = hdr;
+    _entries = reinterpret_cast<TelemetryHistoryEntry*>(static_cast<uint8_t*>(base) + entriesOffset());
+    _mask = capacity - 1;
+    return true;
+}
+
+void TelemetryHistory::close()
+{
+    if (_base) {
+        munmap(_base, _size);
+    }
+    _base = nullptr;
+    _size = 0;
+    _hdr = nullptr;
+    _entries = nullptr;
+    _mask = 0;
+}
+
+void TelemetryHistory::append(const TelemetrySnapshot& snapshot, uint32_t frameType, uint64_t nowNs)
+{
+    if (!_hdr) return;
+    uint64_t pos = _hdr->writePos.load(std::memory_order_relaxed);
+    TelemetryHistoryEntry& entry = _entries[pos & _mask];
+
+    entry.stamp.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.timestampNs = nowNs;
+    entry.frameType = frameType;
+    memcpy(&entry.snapshot, &snapshot, sizeof(TelemetrySnapshot));
+    entry.stamp.store(2 * pos + 2, std::memory_order_release);
+
+    _hdr->writePos.store(pos + 1, std::memory_order_release);
+}
+
+size_t TelemetryHistory::read(uint64_t cursor, TelemetryHistoryRecord* out, size_t maxRecords,
+                              uint64_t* nextCursor, uint64_t* dropped) const
+{
+    uint64_t lost = 0;
+    size_t n = 0;
+    if (_hdr) {
+        uint64_t head = _hdr->writePos.load(std::memory_order_acquire);
+        uint64_t oldest = head > _mask + 1 ? head - (_mask + 1) : 0;
+        if (cursor > head) cursor = head;  // курсор от будущего — начинаем с новых записей
+        if (cursor < oldest) {
+            lost += oldest - cursor;
+            cursor = oldest;
+        }
+
+        while (cursor < head && n < maxRecords) {
+            const TelemetryHistoryEntry& entry = _entries[cursor & _mask];
+            uint64_t expected = 2 * cursor + 2;
+            if (entry.stamp.load(std::memory_order_acquire) == expected) {
+                TelemetryHistoryRecord& rec = out[n];
+                rec.pos = cursor;
+                rec.timestampNs = entry.timestampNs;
+                rec.frameType = entry.frameType;
+                memcpy(&rec.snapshot, &entry.snapshot, sizeof(TelemetrySnapshot));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (entry.stamp.load(std::memory_order_relaxed) == expected) {
+                    n++;
+                } else {
+                    lost++; // писатель перезаписал запись во время копирования
+                }
+            } else {
+                lost++; // запись уже вытеснена
+            }
+            cursor++;
+        }
+    }
+    if (nextCursor) *nextCursor = cursor;
+    if (dropped) *dropped = lost;
+    return n;
+}
+
+uint64_t TelemetryHistory::head() const
+{
+    return _hdr ? _hdr->writePos.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t TelemetryHistory::tail() const
+{
+    uint64_t h = head();
+    return h > _mask + 1 ? h - (_mask + 1) : 0;
+}
+
+bool TelemetryHistory::unlink(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
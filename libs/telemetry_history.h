@@ -0,0 +1,90 @@
+#pragma once
+
+// История телеметрии в разделяемой памяти (shm_open/mmap): кольцо снимков на каждый кадр
+// Один писатель (главный цикл crsf_io_rpi) добавляет снимок после каждого разобранного кадра,
+// читатели забирают пачкой все записи после своего курсора. У каждой записи свой seqlock:
+// читатель без блокировок замечает запись, перезаписанную писателем во время копирования
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "telemetry_snapshot.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "история телеметрии в shm требует lock-free atomic");
+
+// Запись кольца
+struct alignas(64) TelemetryHistoryEntry {
+    std::atomic<uint64_t> stamp;  // 2*pos+1 — идёт запись позиции pos, 2*pos+2 — записана
+    uint64_t timestampNs;         // время кадра, rpi_nanos()
+    uint32_t frameType;           // тип кадра CRSF
+    TelemetrySnapshot snapshot;   // снимок после разбора кадра
+};
+
+// Заголовок сегмента. Записи начинаются сразу после заголовка (смещение кратно 64)
+struct TelemetryHistoryHeader {
+    uint32_t magic;       // TelemetryHistory::MAGIC — сегмент инициализирован
+    uint16_t version;     // версия формата
+    uint16_t entrySize;   // sizeof(TelemetryHistoryEntry)
+    uint32_t capacity;    // количество записей, степень двойки
+    uint32_t writerPid;   // pid писателя
+    uint64_t schemaHash;  // TELEMETRY_SCHEMA_HASH писателя
+
+    alignas(64) std::atomic<uint64_t> writePos;  // позиций записано (курсор следующей записи)
+};
+
+// Запись, прочитанная из кольца
+struct TelemetryHistoryRecord {
+    uint64_t pos;          // позиция в истории (курсор)
+    uint64_t timestampNs;
+    uint32_t frameType;
+    TelemetrySnapshot snapshot;
+};
+
+class TelemetryHistory {
+public:
+    static constexpr uint32_t MAGIC = 0x54534843;  // "CHST"
+    static constexpr uint16_t VERSION = 1;
+
+    TelemetryHistory();
+    ~TelemetryHistory();
+    TelemetryHistory(const TelemetryHistory&) = delete;
+    TelemetryHistory& operator=(const TelemetryHistory&) = delete;
+
+    // Писатель: создать (или сбросить) сегмент name на capacity записей (степень двойки).
+    // Сегмент прошлого запуска с той же ёмкостью и форматом переиспользуется, позиции
+    // продолжаются, чтобы курсоры читателей не пошли назад. Иначе он удаляется и создаётся
+    // заново: читатели старого отображения не получат SIGBUS, но должны открыть сегмент снова
+    bool create(const char* name, uint32_t capacity);
+    // Читатель: открыть существующий сегмент только для чтения.
+    // false — сегмента нет, он другой версии или другой схемы снимка
+    bool open(const char* name);
+    void close();
+    bool isOpen() const { return _hdr != nullptr; }
+
+    // Добавить снимок (только писатель, из одного потока)
+    void append(const TelemetrySnapshot& snapshot, uint32_t frameType, uint64_t nowNs);
+
+    // Прочитать до maxRecords записей, начиная с позиции cursor.
+    // Записи, уже вытесненные писателем, пропускаются и считаются в *dropped.
+    // *nextCursor — курсор для следующего вызова. Возвращает количество записей в out
+    size_t read(uint64_t cursor, TelemetryHistoryRecord* out, size_t maxRecords,
+                uint64_t* nextCursor, uint64_t* dropped = nullptr) const;
+
+    // Позиция следующей записи (курсор "только новые")
+    uint64_t head() const;
+    // Самая старая позиция, ещё доступная в кольце
+    uint64_t tail() const;
+    uint32_t capacity() const { return _hdr ? _hdr->capacity : 0; }
+    // Записи кольца как есть (capacity() штук) — для представлений без копии.
+    // Запись позиции pos действительна, пока её stamp == 2*pos+2
+    const TelemetryHistoryEntry* entries() const { return _entries; }
+
+    static bool unlink(const char* name);
+
+private:
+    void* _base;
+    size_t _size;
+    TelemetryHistoryHeader* _hdr;
+    TelemetryHistoryEntry* _entries;
+    uint64_t _mask;
+};
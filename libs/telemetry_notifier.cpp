@@ -0,0 +1,61 @@
+#include "telemetry_notifier.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+TelemetryNotifier::TelemetryNotifier()
+    : _shm(nullptr), _frameType(TelemetryShm::ANY_FRAME), _fd(-1), _stop(false)
+{
+}
+
+TelemetryNotifier::~TelemetryNotifier()
+{
+    stop();
+}
+
+bool TelemetryNotifier::start(const TelemetryShm& shm, int frameType)
+{
+    stop();
+    if (!shm.isOpen()) return false;
+
+    _fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_fd < 0) return false;
+    _shm = &shm;
+    _frameType = frameType;
+    _stop.store(false);
+    // Счётчик берём до запуска потока: публикации сразу после start() не теряются
+    _thread = std::thread(&TelemetryNotifier::run, this, shm.frameCounter(frameType));
+    return true;
+}
+
+void TelemetryNotifier::stop()
+{
+    if (_thread.joinable()) {
+        _stop.store(true);
+        _thread.join();
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _shm = nullptr;
+}
+
+uint64_t TelemetryNotifier::drain()
+{
+    uint64_t count = 0;
+    if (_fd < 0 || ::read(_fd, &count, sizeof(count)) != sizeof(count)) return 0;
+    return count;
+}
+
+void TelemetryNotifier::run(uint32_t counter)
+{
+    while (!_stop.load(std::memory_order_relaxed)) {
+        // Таймаут только для проверки остановки: публикацию будит futex писателя
+        if (_shm->waitFrame(_frameType, counter, STOP_CHECK_NS, &counter)) {
+            uint64_t one = 1;
+            ssize_t written = ::write(_fd, &one, sizeof(one));
+            (void)written;  // счётчик eventfd переполнен — читатель и так проснётся
+        }
+    }
+}
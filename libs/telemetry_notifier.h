@@ -0,0 +1,43 @@
+#pragma once
+
+// Уведомления о публикациях телеметрии через файловый дескриптор (eventfd)
+// Поток уведомителя ждёт futex сегмента TelemetryShm (без опроса) и после каждой
+// публикации увеличивает счётчик eventfd. Дескриптор можно добавить в любой цикл событий
+// (epoll, select, asyncio add_reader): он читаемый, пока есть непрочитанные публикации
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "telemetry_shm.h"
+
+class TelemetryNotifier {
+public:
+    // Как часто поток проверяет флаг остановки, если публикаций нет
+    static constexpr uint64_t STOP_CHECK_NS = 100000000ull;  // 100 мс
+
+    TelemetryNotifier();
+    ~TelemetryNotifier();
+    TelemetryNotifier(const TelemetryNotifier&) = delete;
+    TelemetryNotifier& operator=(const TelemetryNotifier&) = delete;
+
+    // Запустить поток ожидания публикаций кадров frameType (ANY_FRAME — любых).
+    // Сегмент shm должен быть открыт и жить дольше уведомителя
+    bool start(const TelemetryShm& shm, int frameType = TelemetryShm::ANY_FRAME);
+    // Остановить поток (ждёт не дольше STOP_CHECK_NS) и закрыть дескриптор
+    void stop();
+    bool isRunning() const { return _thread.joinable(); }
+
+    // eventfd (неблокирующий), -1 — уведомитель не запущен
+    int fd() const { return _fd; }
+    // Сбросить дескриптор: количество публикаций с прошлого сброса (0 — не было)
+    uint64_t drain();
+
+private:
+    void run(uint32_t counter);
+
+    const TelemetryShm* _shm;
+    int _frameType;
+    int _fd;
+    std::atomic<bool> _stop;
+    std::thread _thread;
+};
@@ -0,0 +1,196 @@
+#include "telemetry_pyramid.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+TelemetryPyramid::TelemetryPyramid(uint64_t baseNs, uint32_t factor, uint32_t levels, uint32_t capacity)
+    : _capacity(capacity ? capacity : 1), _firstNs(0), _lastNs(0)
+{
+    // Столбцы из описания схемы; reserved* — выравнивание, в истории не нужны
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT && _columns.size() < MAX_COLUMNS; ++f) {
+        const TelemetryFieldInfo& field = TELEMETRY_FIELDS[f];
+        if (strncmp(field.name, "reserved", 8) == 0) continue;
+        for (uint16_t i = 0; i < field.count && _columns.size() < MAX_COLUMNS; ++i) {
+            Column column;
+            if (field.count == 1) {
+                snprintf(column.name, sizeof(column.name), "%s", field.name);
+            } else {
+                snprintf(column.name, sizeof(column.name), "%s[%u]", field.name, static_cast<unsigned>(i));
+            }
+            column.offset = static_cast<uint16_t>(field.offset + i * field.elemSize);
+            column.type = field.type;
+            _columns.push_back(column);
+        }
+    }
+    _values.resize(_columns.size());
+
+    uint64_t resolution = baseNs ? baseNs : 1;
+    for (uint32_t l = 0; l < (levels ? levels : 1); ++l) {
+        Level level;
+        level.resolutionNs = resolution;
+        level.newestId = 0;
+        level.ids.assign(_capacity, 0);
+        level.counts.assign(_capacity, 0);
+        level.mins.assign(static_cast<size_t>(_capacity) * _columns.size(), 0.0f);
+        level.maxs.assign(static_cast<size_t>(_capacity) * _columns.size(), 0.0f);
+        level.sums.assign(static_cast<size_t>(_capacity) * _columns.size(), 0.0);
+        _levels.push_back(std::move(level));
+        resolution *= (factor > 1 ? factor : 2);
+    }
+}
+
+double TelemetryPyramid::columnValue(const Column& column, const TelemetrySnapshot& snapshot) const
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&snapshot) + column.offset;
+    switch (column.type) {
+    case TELEMETRY_U8: return *p;
+    case TELEMETRY_U16: { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case TELEMETRY_U32: { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case TELEMETRY_U64: { uint64_t v; memcpy(&v, p, sizeof(v)); return static_cast<double>(v); }
+    case TELEMETRY_I16: { int16_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case TELEMETRY_I32: { int32_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case TELEMETRY_F64: { double v; memcpy(&v, p, sizeof(v)); return v; }
+    }
+    return 0.0;
+}
+
+uint64_t TelemetryPyramid::oldestId(const Level& level) const
+{
+    return level.newestId >= _capacity ? level.newestId - _capacity + 1 : 0;
+}
+
+void TelemetryPyramid::add(uint64_t timestampNs, const TelemetrySnapshot& snapshot)
+{
+    if (_firstNs == 0) _firstNs = timestampNs ? timestampNs : 1;
+    _lastNs = std::max(_lastNs, timestampNs);
+    const size_t ncolumns = _columns.size();
+    for (size_t c = 0; c < ncolumns; ++c) {
+        _values[c] = columnValue(_columns[c], snapshot);
+    }
+
+    for (Level& level : _levels) {
+        uint64_t id = timestampNs / level.resolutionNs;
+        if (id < oldestId(level)) continue;  // корзина уже вытеснена
+        size_t slot = static_cast<size_t>(id % _capacity);
+        float* mins = &level.mins[slot * ncolumns];
+        float* maxs = &level.maxs[slot * ncolumns];
+        double* sums = &level.sums[slot * ncolumns];
+        if (level.ids[slot] != id + 1) {
+            // Новая корзина на месте вытесненной
+            level.ids[slot] = id + 1;
+            level.counts[slot] = 0;
+            std::fill(mins, mins + ncolumns, std::numeric_limits<float>::infinity());
+            std::fill(maxs, maxs + ncolumns, -std::numeric_limits<float>::infinity());
+            std::fill(sums, sums + ncolumns, 0.0);
+        }
+        level.counts[slot]++;
+        for (size_t c = 0; c < ncolumns; ++c) {
+            float v = static_cast<float>(_values[c]);
+            if (v < mins[c]) mins[c] = v;
+            if (v > maxs[c]) maxs[c] = v;
+            sums[c] += _values[c];
+        }
+        level.newestId = std::max(level.newestId, id);
+    }
+}
+
+void TelemetryPyramid::clear()
+{
+    for (Level& level : _levels) {
+        level.newestId = 0;
+        std::fill(level.ids.begin(), level.ids.end(), 0);
+    }
+    _firstNs = 0;
+    _lastNs = 0;
+}
+
+size_t TelemetryPyramid::findColumns(const char* name, size_t len, uint16_t* out, size_t max) const
+{
+    size_t found = 0;
+    for (size_t c = 0; c < _columns.size(); ++c) {
+        const char* columnName = _columns[c].name;
+        // Точное совпадение или поле-массив целиком ("channels" для "channels[3]")
+        if (strncmp(columnName, name, len) == 0 && (columnName[len] == '\0' || columnName[len] == '[')) {
+            if (found < max) out[found] = static_cast<uint16_t>(c);
+            found++;
+        }
+    }
+    return found;
+}
+
+size_t TelemetryPyramid::query(uint64_t sinceNs, size_t maxPoints, const uint16_t* columns, size_t ncolumns,
+                               uint64_t* times, uint32_t* counts, TelemetryPyramidStats* stats,
+                               uint64_t* resolutionNs) const
+{
+    if (resolutionNs) *resolutionNs = _levels[0].resolutionNs;
+    if (_firstNs == 0 || maxPoints == 0 || ncolumns == 0 || ncolumns > MAX_COLUMNS) return 0;
+    uint64_t since = std::max(sinceNs, _firstNs);
+    if (since > _lastNs) return 0;
+
+    // Самый подробный уровень, который ещё хранит since
+    size_t l = 0;
+    while (l + 1 < _levels.size() && oldestId(_levels[l]) * _levels[l].resolutionNs > since) ++l;
+
+    // Корзин на точку: групп по k корзин должно быть не больше maxPoints. Если приходится
+    // объединять по целой корзине следующего уровня и больше, берём следующий уровень
+    uint64_t idStart = 0;
+    uint64_t idEnd = 0;
+    uint64_t k = 1;
+    for (;;) {
+        const Level& level = _levels[l];
+        idStart = std::max(since / level.resolutionNs, oldestId(level));
+        idEnd = level.newestId;
+        k = 1;
+        while (idEnd / k - idStart / k + 1 > maxPoints) k++;
+        if (l + 1 < _levels.size() && k * level.resolutionNs >= _levels[l + 1].resolutionNs) {
+            ++l;
+            continue;
+        }
+        break;
+    }
+
+    const Level& level = _levels[l];
+    const size_t total = _columns.size();
+    if (resolutionNs) *resolutionNs = level.resolutionNs * k;
+    size_t points = 0;
+    uint64_t group = idStart / k;
+    uint32_t groupCount = 0;
+    double sums[MAX_COLUMNS];  // суммы группы, среднее — в конце группы
+    for (uint64_t id = idStart;; ++id) {
+        // Точка готова: группа кончилась или корзины кончились
+        if (id > idEnd || id / k != group) {
+            if (groupCount > 0 && points < maxPoints) {
+                TelemetryPyramidStats* row = &stats[points * ncolumns];
+                for (size_t c = 0; c < ncolumns; ++c) {
+                    row[c].avg = static_cast<float>(sums[c] / groupCount);
+                }
+                times[points] = group * k * level.resolutionNs;
+                counts[points] = groupCount;
+                points++;
+            }
+            if (id > idEnd) break;
+            group = id / k;
+            groupCount = 0;
+        }
+
+        size_t slot = static_cast<size_t>(id % _capacity);
+        if (level.ids[slot] != id + 1 || level.counts[slot] == 0 || points >= maxPoints) continue;
+        TelemetryPyramidStats* row = &stats[points * ncolumns];
+        for (size_t c = 0; c < ncolumns; ++c) {
+            size_t i = slot * total + columns[c];
+            if (groupCount == 0) {
+                row[c].min = level.mins[i];
+                row[c].max = level.maxs[i];
+                sums[c] = level.sums[i];
+            } else {
+                row[c].min = std::min(row[c].min, level.mins[i]);
+                row[c].max = std::max(row[c].max, level.maxs[i]);
+                sums[c] += level.sums[i];
+            }
+        }
+        groupCount += level.counts[slot];
+    }
+    return points;
+}
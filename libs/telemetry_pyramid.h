@@ -0,0 +1,86 @@
+#pragma once
+
+// Многоуровневая история телеметрии в памяти веб-сервера (/api/telemetry/history)
+// Каждое числовое поле снимка (элемент массива — отдельный столбец, reserved* пропускаются)
+// агрегируется в корзины по времени: min, max, сумма и количество. Уровень 0 — корзины
+// baseNs, каждый следующий в factor раз крупнее; у каждого уровня кольцо на capacity корзин.
+// Каждый кадр сразу попадает во все уровни, поэтому запрос минут истории читает
+// сотни готовых корзин грубого уровня, а не десятки тысяч кадров.
+// Время — rpi_nanos() писателя (как timestampNs истории и потока /api/stream).
+// Не потокобезопасна: пишет и читает один поток (поток веб-сервера)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "telemetry_snapshot.h"
+
+// Агрегат столбца в точке ответа
+struct TelemetryPyramidStats {
+    float min;
+    float max;
+    float avg;
+};
+
+class TelemetryPyramid {
+public:
+    // Столбцов не больше: все элементы всех полей снимка
+    static constexpr size_t MAX_COLUMNS = 64;
+
+    TelemetryPyramid(uint64_t baseNs, uint32_t factor, uint32_t levels, uint32_t capacity);
+    TelemetryPyramid(const TelemetryPyramid&) = delete;
+    TelemetryPyramid& operator=(const TelemetryPyramid&) = delete;
+
+    // Добавить снимок с временем timestampNs (время не убывает; кадр из прошлого
+    // старше текущей корзины уровня в этот уровень не попадает)
+    void add(uint64_t timestampNs, const TelemetrySnapshot& snapshot);
+    void clear();
+
+    // Столбцы: "voltage", "channels[3]"
+    size_t columnCount() const { return _columns.size(); }
+    const char* columnName(size_t column) const { return _columns[column].name; }
+    // Столбцы поля по имени: "channels" — все 16, "channels[3]" — один. Возвращает число
+    // найденных (записано не больше max), 0 — нет такого поля
+    size_t findColumns(const char* name, size_t len, uint16_t* out, size_t max) const;
+
+    // Выборка с момента sinceNs не длиннее maxPoints точек: самый подробный уровень, который
+    // ещё хранит sinceNs, соседние корзины объединяются, если их больше maxPoints.
+    // times[p] — начало точки, counts[p] — кадров в ней, stats[p * ncolumns + c] — агрегат
+    // столбца columns[c]. Корзины без кадров пропускаются. Возвращает число точек;
+    // *resolutionNs — длительность точки
+    size_t query(uint64_t sinceNs, size_t maxPoints, const uint16_t* columns, size_t ncolumns,
+                 uint64_t* times, uint32_t* counts, TelemetryPyramidStats* stats,
+                 uint64_t* resolutionNs) const;
+
+    uint32_t levels() const { return static_cast<uint32_t>(_levels.size()); }
+    uint64_t resolutionNs(uint32_t level) const { return _levels[level].resolutionNs; }
+    // Время первого и последнего добавленного кадра (0 — кадров не было)
+    uint64_t firstNs() const { return _firstNs; }
+    uint64_t lastNs() const { return _lastNs; }
+
+private:
+    struct Column {
+        char name[32];
+        uint16_t offset;
+        TelemetryFieldType type;
+    };
+    // Кольцо корзин одного уровня: слот id % capacity хранит корзину id, если ids[слот] == id + 1
+    struct Level {
+        uint64_t resolutionNs;
+        uint64_t newestId;
+        std::vector<uint64_t> ids;
+        std::vector<uint32_t> counts;
+        std::vector<float> mins;     // [слот * столбцов + столбец]
+        std::vector<float> maxs;
+        std::vector<double> sums;
+    };
+
+    double columnValue(const Column& column, const TelemetrySnapshot& snapshot) const;
+    uint64_t oldestId(const Level& level) const;
+
+    std::vector<Column> _columns;
+    std::vector<Level> _levels;
+    uint32_t _capacity;
+    uint64_t _firstNs;
+    uint64_t _lastNs;
+    std::vector<double> _values;  // значения столбцов текущего кадра
+};
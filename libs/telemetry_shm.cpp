@@ -0,0 +1,229 @@
+#include "telemetry_shm.h"
+
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Индекс счётчика "любая публикация"
+static const int ANY_FRAME_INDEX = 256;
+
+static int futexIndex(int frameType)
+{
+    return (frameType < 0 || frameType > 255) ? ANY_FRAME_INDEX : frameType;
+}
+
+// futex между процессами (без FUTEX_PRIVATE_FLAG): слово лежит в общем отображении
+static long futexWait(std::atomic<uint32_t>* word, uint32_t expected, const struct timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+static void futexWakeAll(std::atomic<uint32_t>* word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static uint64_t monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Снимок лежит на отдельных кэш-линиях после заголовка
+static size_t payloadOffset()
+{
+    return (sizeof(TelemetryShmHeader) + 63u) & ~static_cast<size_t>(63u);
+}
+
+TelemetryShm::TelemetryShm()
+    : _base(nullptr), _size(0), _hdr(nullptr), _payload(nullptr), _payloadSize(0)
+{
+}
+
+TelemetryShm::~TelemetryShm()
+{
+    close();
+}
+
+bool TelemetryShm::create(const char* name, uint32_t payloadSize, uint64_t schemaHash)
+{
+    close();
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    // Сегмент от прежних версий мог остаться доступным на запись всем: права только сужаем
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (st.st_mode & 022) != 0) fchmod(fd, st.st_mode & 0755);
+
+    size_t size = payloadOffset() + payloadSize;
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    _base = base;
+    _size = size;
+    _hdr = static_cast<TelemetryShmHeader*>(base);
+    _payload = static_cast<uint8_t*>(base) + payloadOffset();
+    _payloadSize = payloadSize;
+
+    // Сегмент мог остаться от прошлого запуска (в том числе с оборванной записью):
+    // продолжаем счётчик с чётного значения, чтобы читатели заметили обновление
+    uint32_t seq = _hdr->seq.load(std::memory_order_relaxed);
+    _hdr->seq.store((seq + 2u) & ~1u, std::memory_order_relaxed);
+    _hdr->version = VERSION;
+    _hdr->headerSize = static_cast<uint16_t>(sizeof(TelemetryShmHeader));
+    _hdr->payloadSize = payloadSize;
+    _hdr->writerPid = static_cast<uint32_t>(getpid());
+    _hdr->schemaHash = schemaHash;
+    _hdr->frameType = 0;
+    _hdr->publishCount = 0;
+    _hdr->publishNs = 0;
+    // Счётчики кадров не сбрасываем: ждущие читатели прошлого запуска должны проснуться
+    memset(_payload, 0, payloadSize);
+    std::atomic_thread_fence(std::memory_order_release);
+    _hdr->magic = MAGIC;
+    return true;
+}
+
+bool TelemetryShm::open(const char* name, uint32_t payloadSize, uint64_t schemaHash)
+{
+    close();
+    // Только на чтение: ни снимок, ни счётчики читатель не меняет
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    size_t size = payloadOffset() + payloadSize;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < size) {
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const TelemetryShmHeader* hdr = static_cast<const TelemetryShmHeader*>(base);
+    if (hdr->magic != MAGIC || hdr->version != VERSION ||
+        hdr->headerSize != sizeof(TelemetryShmHeader) || hdr->payloadSize != payloadSize ||
+        hdr->schemaHash != schemaHash) {
+        munmap(base, size);
+        return false;
+    }
+
+    _base = base;
+    _size = size;
+    _hdr = static_cast<TelemetryShmHeader*>(base);
+    _payload = static_cast<uint8_t*>(base) + payloadOffset();
+    _payloadSize = payloadSize;
+    return true;
+}
+
+void TelemetryShm::close()
+{
+    if (_base) {
+        munmap(_base, _size);
+    }
+    _base = nullptr;
+    _size = 0;
+    _hdr = nullptr;
+    _payload = nullptr;
+    _payloadSize = 0;
+}
+
+void TelemetryShm::publish(const void* payload, uint32_t frameType, uint64_t nowNs)
+{
+    if (!_hdr) return;
+    uint32_t seq = _hdr->seq.load(std::memory_order_relaxed);
+    _hdr->seq.store(seq + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(_payload, payload, _payloadSize);
+    _hdr->frameType = frameType;
+    _hdr->publishCount++;
+    _hdr->publishNs = nowNs;
+
+    _hdr->seq.store(seq + 2u, std::memory_order_release);
+
+    // Счётчики для ждущих. Число ждущих читатель записать не может (сегмент у него только
+    // на чтение), поэтому будим всегда; без ждущих FUTEX_WAKE — короткий системный вызов
+    int index = futexIndex(static_cast<int>(frameType));
+    _hdr->frameCounters[index].fetch_add(1, std::memory_order_release);
+    _hdr->frameCounters[ANY_FRAME_INDEX].fetch_add(1, std::memory_order_release);
+    futexWakeAll(&_hdr->frameCounters[index]);
+    futexWakeAll(&_hdr->frameCounters[ANY_FRAME_INDEX]);
+}
+
+bool TelemetryShm::read(void* payload, TelemetryShmMeta* meta) const
+{
+    if (!_hdr) return false;
+    for (int attempt = 0; attempt < READ_RETRIES; ++attempt) {
+        uint32_t seq1 = _hdr->seq.load(std::memory_order_acquire);
+        if (seq1 & 1u) continue; // писатель в середине записи
+
+        memcpy(payload, _payload, _payloadSize);
+        TelemetryShmMeta m;
+        m.frameType = _hdr->frameType;
+        m.publishCount = _hdr->publishCount;
+        m.publishNs = _hdr->publishNs;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_hdr->seq.load(std::memory_order_relaxed) == seq1) {
+            if (meta) *meta = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t TelemetryShm::sequence() const
+{
+    return _hdr ? _hdr->seq.load(std::memory_order_acquire) : 0;
+}
+
+uint32_t TelemetryShm::frameCounter(int frameType) const
+{
+    return _hdr ? _hdr->frameCounters[futexIndex(frameType)].load(std::memory_order_acquire) : 0;
+}
+
+bool TelemetryShm::waitFrame(int frameType, uint32_t since, uint64_t timeoutNs, uint32_t* counter) const
+{
+    if (!_hdr) return false;
+    std::atomic<uint32_t>* word = &_hdr->frameCounters[futexIndex(frameType)];
+    uint64_t deadline = monotonicNs() + timeoutNs;
+
+    // FUTEX_WAIT сравнивает слово с since атомарно: счётчик, увеличенный до ожидания,
+    // вернёт EAGAIN, после — писатель разбудит
+    bool changed = false;
+    for (;;) {
+        uint32_t value = word->load(std::memory_order_acquire);
+        if (value != since) {
+            if (counter) *counter = value;
+            changed = true;
+            break;
+        }
+        uint64_t now = monotonicNs();
+        if (now >= deadline) break;
+        struct timespec ts;
+        uint64_t left = deadline - now;
+        ts.tv_sec = static_cast<time_t>(left / 1000000000ull);
+        ts.tv_nsec = static_cast<long>(left % 1000000000ull);
+        // EAGAIN — значение уже изменилось, EINTR/пробуждение — проверяем снова
+        futexWait(word, since, &ts);
+    }
+    return changed;
+}
+
+bool TelemetryShm::unlink(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// Сегмент разделяемой памяти (shm_open/mmap) для публикации снимка телеметрии
+// Один писатель (основной цикл crsf_io_rpi), любое число читателей в других процессах.
+// Снимок публикуется под seqlock: читатель копирует данные без блокировок и системных
+// вызовов и повторяет копию, если писатель успел изменить снимок во время чтения.
+// Для ожидания обновлений у каждого типа кадра есть счётчик — futex-слово в сегменте.
+// Сегмент создаётся с правами 0644: пишет только владелец, читатели отображают его только
+// на чтение (FUTEX_WAIT запись не требует)
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock в shm требует lock-free atomic");
+
+// Заголовок сегмента. Данные снимка начинаются сразу после заголовка (смещение кратно 64)
+struct TelemetryShmHeader {
+    uint32_t magic;        // TelemetryShm::MAGIC — сегмент инициализирован
+    uint16_t version;      // версия формата заголовка
+    uint16_t headerSize;   // sizeof(TelemetryShmHeader)
+    uint32_t payloadSize;  // размер снимка, байт
+    uint32_t writerPid;    // pid писателя
+    uint64_t schemaHash;   // хеш схемы снимка (TELEMETRY_SCHEMA_HASH), проверяется читателем
+
+    // Отдельная кэш-линия для seqlock: нечётное значение — идёт запись
+    alignas(64) std::atomic<uint32_t> seq;
+    uint32_t frameType;     // тип кадра CRSF, вызвавшего публикацию (0 — периодическая)
+    uint64_t publishCount;  // количество публикаций
+    uint64_t publishNs;     // время публикации, rpi_nanos()
+
+    // Ожидание обновлений: счётчики публикаций по типу кадра (futex-слова).
+    // Читатели сегмент не меняют, поэтому писатель будит после каждой публикации
+    alignas(64) std::atomic<uint32_t> frameCounters[257];  // [тип кадра 0..255], [256] — любая публикация
+};
+
+// Метаданные публикации, прочитанные вместе со снимком
+struct TelemetryShmMeta {
+    uint32_t frameType;
+    uint64_t publishCount;
+    uint64_t publishNs;
+};
+
+class TelemetryShm {
+public:
+    static constexpr uint32_t MAGIC = 0x46535243;  // "CRSF"
+    static constexpr uint16_t VERSION = 4;
+    // Тип кадра для ожидания любой публикации
+    static constexpr int ANY_FRAME = -1;
+    // Сколько раз читатель повторяет копию, если писатель не даёт прочитать целый снимок
+    static constexpr int READ_RETRIES = 64;
+
+    TelemetryShm();
+    ~TelemetryShm();
+    TelemetryShm(const TelemetryShm&) = delete;
+    TelemetryShm& operator=(const TelemetryShm&) = delete;
+
+    // Писатель: создать (или переинициализировать) сегмент name со снимком payloadSize байт
+    bool create(const char* name, uint32_t payloadSize, uint64_t schemaHash = 0);
+    // Читатель: открыть существующий сегмент (снимок только читается).
+    // false — сегмента нет, он другой версии, с другим размером снимка или другой схемой
+    bool open(const char* name, uint32_t payloadSize, uint64_t schemaHash = 0);
+    void close();
+    bool isOpen() const { return _hdr != nullptr; }
+
+    // Опубликовать снимок (только писатель, из одного потока)
+    void publish(const void* payload, uint32_t frameType, uint64_t nowNs);
+    // Прочитать согласованный снимок; false — сегмент не открыт или писатель занят слишком долго
+    bool read(void* payload, TelemetryShmMeta* meta = nullptr) const;
+    // Текущее значение seqlock: изменилось — снимок обновился
+    uint32_t sequence() const;
+
+    // Счётчик публикаций кадров типа frameType (ANY_FRAME — всех публикаций)
+    uint32_t frameCounter(int frameType) const;
+    // Ждать, пока счётчик frameType не станет отличным от since, не дольше timeoutNs.
+    // true — счётчик изменился
+    // (новое значение в *counter), false — таймаут или сегмент не открыт
+    bool waitFrame(int frameType, uint32_t since, uint64_t timeoutNs, uint32_t* counter = nullptr) const;
+
+    static bool unlink(const char* name);
+
+private:
+    void* _base;
+    size_t _size;
+    TelemetryShmHeader* _hdr;
+    uint8_t* _payload;
+    uint32_t _payloadSize;
+};
@@ -0,0 +1,66 @@
+#include "telemetry_snapshot.h"
+
+#include <cstring>
+#include "crsf/CrsfSerial.h"
+
+const TelemetryFieldInfo* telemetryFindField(const char* name)
+{
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        if (strcmp(TELEMETRY_FIELDS[f].name, name) == 0) return &TELEMETRY_FIELDS[f];
+    }
+    return nullptr;
+}
+
+uint64_t telemetryDiffFields(const TelemetrySnapshot& a, const TelemetrySnapshot& b)
+{
+    const uint8_t* pa = reinterpret_cast<const uint8_t*>(&a);
+    const uint8_t* pb = reinterpret_cast<const uint8_t*>(&b);
+    uint64_t mask = 0;
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        const TelemetryFieldInfo& field = TELEMETRY_FIELDS[f];
+        size_t bytes = static_cast<size_t>(field.count) * field.elemSize;
+        if (memcmp(pa + field.offset, pb + field.offset, bytes) != 0) mask |= 1ull << f;
+    }
+    return mask;
+}
+
+void telemetryFillFrame(TelemetrySnapshot& snapshot, const CrsfSerial& crsf)
+{
+    snapshot.linkUp = crsf.isLinkUp() ? 1 : 0;
+    snapshot.lastReceive = static_cast<uint32_t>(crsf.getLastReceiveNs() / 1000000ull);
+
+    // Каналы
+    for (int i = 0; i < 16; i++) {
+        snapshot.channels[i] = static_cast<uint16_t>(crsf.getChannel(i + 1));
+    }
+
+    // Статистика связи - отключена
+    snapshot.packetsReceived = 0;
+    snapshot.packetsSent = 0;
+    snapshot.packetsLost = 0;
+
+    // GPS
+    const crsf_sensor_gps_t* gps = crsf.getGpsSensor();
+    if (gps) {
+        snapshot.latitude = gps->latitude / 10000000.0;
+        snapshot.longitude = gps->longitude / 10000000.0;
+        snapshot.altitude = gps->altitude - 1000;
+        snapshot.speed = gps->groundspeed / 10.0;
+    }
+
+    // Батарея
+    snapshot.voltage = crsf.getBatteryVoltage();
+    snapshot.current = crsf.getBatteryCurrent();
+    snapshot.capacity = crsf.getBatteryCapacity();
+    snapshot.remaining = crsf.getBatteryRemaining();
+
+    // Положение
+    snapshot.roll = crsf.getAttitudeRoll();
+    snapshot.pitch = crsf.getAttitudePitch();
+    snapshot.yaw = crsf.getAttitudeYaw();
+
+    // Сырые значения attitude
+    snapshot.rollRaw = crsf.getRawAttitudeRoll();
+    snapshot.pitchRaw = crsf.getRawAttitudePitch();
+    snapshot.yawRaw = crsf.getRawAttitudeYaw();
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+// Единая схема снимка телеметрии: её пишет crsf_io_rpi, читают Python обертка и веб-сервер
+// Раскладка бинарная и версионированная: смещения закреплены static_assert, а хеш схемы
+// (имена, типы, смещения и размеры полей) хранится в заголовке сегмента разделяемой памяти,
+// поэтому читатель другой сборки не откроет сегмент вместо того, чтобы читать мусор.
+// Поля сгруппированы по кэш-линиям: каналы и связь — первая линия (меняются с каждым кадром),
+// датчики — вторая, статистика — третья и четвёртая
+
+#include <cstddef>
+#include <cstdint>
+
+class CrsfSerial;
+
+// Список полей: TELEMETRY_FIELD(тип, имя), TELEMETRY_ARRAY(тип, имя, количество).
+// Порядок полей — порядок в памяти. Любое изменение меняет TELEMETRY_SCHEMA_HASH;
+// при изменении раскладки увеличьте TELEMETRY_SCHEMA_VERSION и поправьте static_assert ниже
+#define TELEMETRY_SNAPSHOT_FIELDS(TELEMETRY_FIELD, TELEMETRY_ARRAY) \
+    /* Кэш-линия 0: связь и каналы */ \
+    TELEMETRY_FIELD(uint8_t, linkUp) \
+    TELEMETRY_FIELD(uint8_t, remaining)        /* остаток батареи, % */ \
+    TELEMETRY_FIELD(uint8_t, rcSyncActive) \
+    TELEMETRY_FIELD(uint8_t, workMode)         /* CrsfWorkMode главного цикла: 0 — manual, 1 — joystick */ \
+    TELEMETRY_FIELD(uint32_t, lastReceive)     /* мс, rpi_nanos() / 1e6 */ \
+    TELEMETRY_ARRAY(uint16_t, channels, 16)    /* мкс */ \
+    TELEMETRY_FIELD(int16_t, rollRaw) \
+    TELEMETRY_FIELD(int16_t, pitchRaw) \
+    TELEMETRY_FIELD(int16_t, yawRaw) \
+    TELEMETRY_FIELD(int16_t, reserved1) \
+    TELEMETRY_FIELD(uint32_t, packetsReceived) /* статистика связи отключена, поля для совместимости */ \
+    TELEMETRY_FIELD(uint32_t, packetsSent) \
+    TELEMETRY_FIELD(uint32_t, packetsLost) \
+    TELEMETRY_FIELD(uint32_t, reserved2) \
+    /* Кэш-линия 1: GPS, батарея, положение */ \
+    TELEMETRY_FIELD(double, latitude) \
+    TELEMETRY_FIELD(double, longitude) \
+    TELEMETRY_FIELD(double, altitude) \
+    TELEMETRY_FIELD(double, speed) \
+    TELEMETRY_FIELD(double, voltage) \
+    TELEMETRY_FIELD(double, current) \
+    TELEMETRY_FIELD(double, capacity) \
+    TELEMETRY_FIELD(double, roll) \
+    /* Кэш-линия 2: положение, планировщик RC-отправки */ \
+    TELEMETRY_FIELD(double, pitch) \
+    TELEMETRY_FIELD(double, yaw) \
+    TELEMETRY_FIELD(uint64_t, rcTicks) \
+    TELEMETRY_FIELD(uint64_t, rcOverruns) \
+    TELEMETRY_FIELD(uint64_t, latSamples) \
+    TELEMETRY_FIELD(uint32_t, rcPeriodUs) \
+    TELEMETRY_FIELD(uint32_t, rcJitterAvgUs) \
+    TELEMETRY_FIELD(uint32_t, rcJitterMaxUs) \
+    TELEMETRY_FIELD(int32_t, rcSyncOffsetUs) \
+    TELEMETRY_FIELD(uint32_t, latTotalP50Us) \
+    TELEMETRY_FIELD(uint32_t, latTotalP90Us) \
+    /* Кэш-линия 3: задержка команда -> UART (перцентили, мкс) */ \
+    TELEMETRY_FIELD(uint32_t, latTotalP99Us) \
+    TELEMETRY_FIELD(uint32_t, latTotalMaxUs) \
+    TELEMETRY_FIELD(uint32_t, latIpcP50Us) \
+    TELEMETRY_FIELD(uint32_t, latIpcP99Us) \
+    TELEMETRY_FIELD(uint32_t, latQueueP50Us) \
+    TELEMETRY_FIELD(uint32_t, latQueueP99Us) \
+    TELEMETRY_FIELD(uint32_t, latWriteP50Us) \
+    TELEMETRY_FIELD(uint32_t, latWriteP99Us)
+
+#define TELEMETRY_DECLARE_FIELD(type, name) type name;
+#define TELEMETRY_DECLARE_ARRAY(type, name, count) type name[count];
+
+// Снимок телеметрии (POD, копируется целиком)
+struct alignas(64) TelemetrySnapshot {
+    TELEMETRY_SNAPSHOT_FIELDS(TELEMETRY_DECLARE_FIELD, TELEMETRY_DECLARE_ARRAY)
+};
+
+#undef TELEMETRY_DECLARE_FIELD
+#undef TELEMETRY_DECLARE_ARRAY
+
+static constexpr uint16_t TELEMETRY_SCHEMA_VERSION = 1;
+
+// Закреплённая раскладка: границы кэш-линий и размер
+static_assert(offsetof(TelemetrySnapshot, linkUp) == 0, "схема телеметрии: linkUp");
+static_assert(offsetof(TelemetrySnapshot, lastReceive) == 4, "схема телеметрии: lastReceive");
+static_assert(offsetof(TelemetrySnapshot, channels) == 8, "схема телеметрии: channels");
+static_assert(offsetof(TelemetrySnapshot, rollRaw) == 40, "схема телеметрии: rollRaw");
+static_assert(offsetof(TelemetrySnapshot, packetsReceived) == 48, "схема телеметрии: packetsReceived");
+static_assert(offsetof(TelemetrySnapshot, latitude) == 64, "схема телеметрии: кэш-линия 1");
+static_assert(offsetof(TelemetrySnapshot, pitch) == 128, "схема телеметрии: кэш-линия 2");
+static_assert(offsetof(TelemetrySnapshot, rcPeriodUs) == 168, "схема телеметрии: rcPeriodUs");
+static_assert(offsetof(TelemetrySnapshot, latTotalP99Us) == 192, "схема телеметрии: кэш-линия 3");
+static_assert(sizeof(TelemetrySnapshot) == 256, "схема телеметрии: размер");
+
+// Тип поля в описании схемы
+enum TelemetryFieldType : uint8_t {
+    TELEMETRY_U8, TELEMETRY_U16, TELEMETRY_U32, TELEMETRY_U64,
+    TELEMETRY_I16, TELEMETRY_I32, TELEMETRY_F64,
+};
+
+template <typename T> struct TelemetryFieldTypeOf;
+template <> struct TelemetryFieldTypeOf<uint8_t> { static constexpr TelemetryFieldType value = TELEMETRY_U8; };
+template <> struct TelemetryFieldTypeOf<uint16_t> { static constexpr TelemetryFieldType value = TELEMETRY_U16; };
+template <> struct TelemetryFieldTypeOf<uint32_t> { static constexpr TelemetryFieldType value = TELEMETRY_U32; };
+template <> struct TelemetryFieldTypeOf<uint64_t> { static constexpr TelemetryFieldType value = TELEMETRY_U64; };
+template <> struct TelemetryFieldTypeOf<int16_t> { static constexpr TelemetryFieldType value = TELEMETRY_I16; };
+template <> struct TelemetryFieldTypeOf<int32_t> { static constexpr TelemetryFieldType value = TELEMETRY_I32; };
+template <> struct TelemetryFieldTypeOf<double> { static constexpr TelemetryFieldType value = TELEMETRY_F64; };
+
+// Описание одного поля: для хеша схемы и для потребителей, которым нужен доступ по имени
+struct TelemetryFieldInfo {
+    const char* name;
+    uint16_t offset;
+    uint16_t count;      // элементов (1 — скалярное поле)
+    TelemetryFieldType type;
+    uint8_t elemSize;    // размер элемента, байт
+};
+
+#define TELEMETRY_DESCRIBE_FIELD(type, name) \
+    { #name, static_cast<uint16_t>(offsetof(TelemetrySnapshot, name)), 1, \
+      TelemetryFieldTypeOf<type>::value, static_cast<uint8_t>(sizeof(type)) },
+#define TELEMETRY_DESCRIBE_ARRAY(type, name, count) \
+    { #name, static_cast<uint16_t>(offsetof(TelemetrySnapshot, name)), count, \
+      TelemetryFieldTypeOf<type>::value, static_cast<uint8_t>(sizeof(type)) },
+
+static constexpr TelemetryFieldInfo TELEMETRY_FIELDS[] = {
+    TELEMETRY_SNAPSHOT_FIELDS(TELEMETRY_DESCRIBE_FIELD, TELEMETRY_DESCRIBE_ARRAY)
+};
+
+#undef TELEMETRY_DESCRIBE_FIELD
+#undef TELEMETRY_DESCRIBE_ARRAY
+
+static constexpr size_t TELEMETRY_FIELD_COUNT = sizeof(TELEMETRY_FIELDS) / sizeof(TELEMETRY_FIELDS[0]);
+
+// FNV-1a по описанию полей и версии схемы
+constexpr uint64_t telemetrySchemaMix(uint64_t hash, uint64_t value, unsigned bytes)
+{
+    for (unsigned i = 0; i < bytes; ++i) {
+        hash = (hash ^ ((value >> (8 * i)) & 0xFFu)) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+constexpr uint64_t telemetrySchemaHash()
+{
+    uint64_t hash = telemetrySchemaMix(0xCBF29CE484222325ull, TELEMETRY_SCHEMA_VERSION, 2);
+    hash = telemetrySchemaMix(hash, sizeof(TelemetrySnapshot), 4);
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        const TelemetryFieldInfo& field = TELEMETRY_FIELDS[f];
+        for (const char* c = field.name; *c; ++c) {
+            hash = telemetrySchemaMix(hash, static_cast<uint8_t>(*c), 1);
+        }
+        hash = telemetrySchemaMix(hash, field.offset, 2);
+        hash = telemetrySchemaMix(hash, field.count, 2);
+        hash = telemetrySchemaMix(hash, field.type, 1);
+        hash = telemetrySchemaMix(hash, field.elemSize, 1);
+    }
+    return hash;
+}
+
+// Проверка полноты описания: поля без неявных промежутков заполняют данные снимка
+constexpr size_t telemetryFieldsBytes()
+{
+    size_t bytes = 0;
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        bytes += static_cast<size_t>(TELEMETRY_FIELDS[f].count) * TELEMETRY_FIELDS[f].elemSize;
+    }
+    return bytes;
+}
+static_assert(telemetryFieldsBytes() == 224, "схема телеметрии: неявное выравнивание между полями");
+
+static constexpr uint64_t TELEMETRY_SCHEMA_HASH = telemetrySchemaHash();
+
+// Найти поле по имени; nullptr — нет такого поля
+const TelemetryFieldInfo* telemetryFindField(const char* name);
+
+// Маска изменившихся полей: бит f — поле TELEMETRY_FIELDS[f] в a и b различается
+static_assert(TELEMETRY_FIELD_COUNT <= 64, "схема телеметрии: маска полей — 64 бита");
+uint64_t telemetryDiffFields(const TelemetrySnapshot& a, const TelemetrySnapshot& b);
+
+// Заполнить поля, меняющиеся с каждым кадром от полётника (связь, каналы, датчики)
+void telemetryFillFrame(TelemetrySnapshot& snapshot, const CrsfSerial& crsf);
@@ -0,0 +1,92 @@
+#include "telemetry_wire.h"
+
+#include <cstdio>
+#include <cstring>
+#include "json_writer.h"
+
+size_t telemetryWireEncode(void* out, const TelemetrySnapshot& snapshot, uint64_t seq, uint64_t timestampNs,
+                           uint32_t frameType)
+{
+    TelemetryWireHeader header;
+    header.magic = TELEMETRY_WIRE_MAGIC;
+    header.version = TELEMETRY_WIRE_VERSION;
+    header.headerSize = static_cast<uint16_t>(sizeof(TelemetryWireHeader));
+    header.schemaHash = TELEMETRY_SCHEMA_HASH;
+    header.seq = seq;
+    header.timestampNs = timestampNs;
+    header.frameType = frameType;
+    header.payloadSize = static_cast<uint32_t>(sizeof(TelemetrySnapshot));
+
+    uint8_t* p = static_cast<uint8_t*>(out);
+    memcpy(p, &header, sizeof(header));
+    memcpy(p + sizeof(header), &snapshot, sizeof(snapshot));
+    return TELEMETRY_WIRE_SIZE;
+}
+
+bool telemetryWireDecode(const void* data, size_t len, TelemetryWireHeader* header, TelemetrySnapshot* snapshot)
+{
+    if (len < TELEMETRY_WIRE_SIZE) return false;
+    TelemetryWireHeader h;
+    memcpy(&h, data, sizeof(h));
+    if (h.magic != TELEMETRY_WIRE_MAGIC || h.version != TELEMETRY_WIRE_VERSION ||
+        h.headerSize != sizeof(TelemetryWireHeader) || h.schemaHash != TELEMETRY_SCHEMA_HASH ||
+        h.payloadSize != sizeof(TelemetrySnapshot)) {
+        return false;
+    }
+    if (header) *header = h;
+    if (snapshot) memcpy(snapshot, static_cast<const uint8_t*>(data) + sizeof(h), sizeof(TelemetrySnapshot));
+    return true;
+}
+
+static const char* numpyTypeName(TelemetryFieldType type)
+{
+    switch (type) {
+    case TELEMETRY_U8:  return "uint8";
+    case TELEMETRY_U16: return "uint16";
+    case TELEMETRY_U32: return "uint32";
+    case TELEMETRY_U64: return "uint64";
+    case TELEMETRY_I16: return "int16";
+    case TELEMETRY_I32: return "int32";
+    case TELEMETRY_F64: return "float64";
+    }
+    return "void";
+}
+
+size_t telemetrySchemaJson(char* out, size_t capacity)
+{
+    // 64-битный хеш — строкой: в JSON числа надёжно точны только до 2^53
+    char hash[24];
+    snprintf(hash, sizeof(hash), "0x%016llx", static_cast<unsigned long long>(TELEMETRY_SCHEMA_HASH));
+
+    JsonWriter json(out, capacity);
+    json.beginObject();
+    json.key("schemaVersion"); json.uintValue(TELEMETRY_SCHEMA_VERSION);
+    json.key("schemaHash"); json.stringValue(hash);
+    json.key("snapshotSize"); json.uintValue(sizeof(TelemetrySnapshot));
+    json.key("byteOrder"); json.stringValue("little");
+
+    json.key("wire");
+    json.beginObject();
+    json.key("magic"); json.uintValue(TELEMETRY_WIRE_MAGIC);
+    json.key("version"); json.uintValue(TELEMETRY_WIRE_VERSION);
+    json.key("headerSize"); json.uintValue(sizeof(TelemetryWireHeader));
+    json.key("header");
+    json.stringValue("magic:uint32,version:uint16,headerSize:uint16,schemaHash:uint64,seq:uint64,"
+                     "timestampNs:uint64,frameType:uint32,payloadSize:uint32");
+    json.endObject();
+
+    json.key("fields");
+    json.beginArray();
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        const TelemetryFieldInfo& field = TELEMETRY_FIELDS[f];
+        json.beginObject();
+        json.key("name"); json.stringValue(field.name);
+        json.key("offset"); json.uintValue(field.offset);
+        json.key("count"); json.uintValue(field.count);
+        json.key("type"); json.stringValue(numpyTypeName(field.type));
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    return json.ok() ? json.size() : 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Бинарный пакет телеметрии для машинных клиентов (логгер, мост к автопилоту):
+// HTTP /api/telemetry.bin и UDP веб-сервера телеметрии.
+// Пакет — заголовок и снимок TelemetrySnapshot байт в байт, без сериализации. Раскладку
+// снимка описывает дескриптор схемы (JSON, /api/telemetry/schema); хеш схемы в заголовке
+// защищает клиента от чтения пакета другой сборки. Порядок байт — little-endian
+// (Raspberry Pi и x86); клиент на Python читает снимок через numpy.frombuffer с dtype из схемы
+
+#include <cstddef>
+#include <cstdint>
+#include "telemetry_snapshot.h"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "бинарный пакет телеметрии: little-endian");
+
+static constexpr uint32_t TELEMETRY_WIRE_MAGIC = 0x54535243;  // "CRST"
+static constexpr uint16_t TELEMETRY_WIRE_VERSION = 1;
+
+struct TelemetryWireHeader {
+    uint32_t magic;        // TELEMETRY_WIRE_MAGIC
+    uint16_t version;      // TELEMETRY_WIRE_VERSION
+    uint16_t headerSize;   // sizeof(TelemetryWireHeader), снимок начинается после заголовка
+    uint64_t schemaHash;   // TELEMETRY_SCHEMA_HASH
+    uint64_t seq;          // номер публикации (publishCount или позиция в истории)
+    uint64_t timestampNs;  // время публикации, rpi_nanos() писателя
+    uint32_t frameType;    // тип кадра CRSF (0 — периодическая публикация)
+    uint32_t payloadSize;  // sizeof(TelemetrySnapshot)
+};
+
+static_assert(sizeof(TelemetryWireHeader) == 40, "бинарный пакет телеметрии: размер заголовка");
+
+static constexpr size_t TELEMETRY_WIRE_SIZE = sizeof(TelemetryWireHeader) + sizeof(TelemetrySnapshot);
+
+// Собрать пакет в out (не меньше TELEMETRY_WIRE_SIZE байт); возвращает длину пакета
+size_t telemetryWireEncode(void* out, const TelemetrySnapshot& snapshot, uint64_t seq, uint64_t timestampNs,
+                           uint32_t frameType);
+// Разобрать пакет: false — короткий пакет, чужой magic, другая версия или схема
+bool telemetryWireDecode(const void* data, size_t len, TelemetryWireHeader* header, TelemetrySnapshot* snapshot);
+
+// Дескриптор схемы в JSON: версия и хеш схемы, размер снимка, заголовок пакета и поля
+// (имя, смещение, количество, тип в именах numpy). Возвращает длину, 0 — не поместился в буфер
+size_t telemetrySchemaJson(char* out, size_t capacity);
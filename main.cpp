@@ -1,26 +1,210 @@
 #include "config.h"
-#include <thread>
-#include <string>
-#include <fstream>
+#include <atomic>
+#include <cstdint>
 #include <unistd.h>
 #include <cstdio>
-#include <sstream>
+#include <cstdlib>
+#include <getopt.h>
+#include <arpa/inet.h>
+#include <sched.h>
+#include <signal.h>
 
 #include "crsf/crsf.h"
+#include "crsf/crsf_engine.h"
 #include "libs/rpi_hal.h"
 #include "libs/joystick.h"
-#include "libs/crsf/CrsfSerial.h"
+#include "libs/rc_scheduler.h"
+#include "libs/telemetry_dispatcher.h"
+#include "libs/telemetry_fanout.h"
+#include "telemetry_server.h"
 
-// Простая функция для получения режима работы
-// Режим теперь управляется через pybind модуль, но для совместимости
-// используем режим по умолчанию "manual"
-std::string getWorkMode() {
-    return "manual"; // По умолчанию ручной режим управления
+// Рассылка кадров по UDP (--udp): поток диспетчера читает историю телеметрии движка
+static TelemetryShm fanoutShm;
+static TelemetryHistory fanoutHistory;
+static TelemetryFanout udpFanout;
+static TelemetryDispatcher fanoutDispatcher;
+
+// Флаг остановки главного цикла: SIGINT/SIGTERM завершают работу штатно
+// (останов веб-сервера, рассылки и закрытие джойстика)
+static std::atomic<bool> stopRequested(false);
+
+static void onStopSignal(int)
+{
+  stopRequested.store(true, std::memory_order_relaxed);
+}
+
+static void installStopHandlers()
+{
+  struct sigaction sa = {};
+  sa.sa_handler = &onStopSignal;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+}
+
+static void printUsage(const char* prog) {
+  printf("Использование: %s [--rc-rate <Гц>] [--rc-period-us <мкс>]\n"
+         "       [--rt-priority <1..99>] [--rt-cpu <n>] [--mlock]\n"
+         "       [--udp <адрес:порт>]... [--udp-ttl <n>] [--http-port <порт>] [--http-bind <адрес>]\n"
+         "       [--joystick <устройство>]\n", prog);
+  printf("  --rc-rate <Гц>         частота отправки RC-каналов, 50..1000 (по умолчанию %u)\n",
+         1000000u / CRSF_RC_PERIOD_US);
+  printf("  --rc-period-us <мкс>   период отправки RC-каналов, %u..%u\n",
+         RcScheduler::MIN_PERIOD_US, RcScheduler::MAX_PERIOD_US);
+  printf("  --rt-priority <1..99>  главный цикл в SCHED_FIFO с указанным приоритетом\n");
+  printf("  --rt-cpu <n>           привязать главный цикл к CPU n (остальные потоки — на другие CPU)\n");
+  printf("  --mlock                mlockall и предварительное затрагивание стека и кучи\n");
+  printf("  --udp <адрес:порт>     рассылать кадры телеметрии по UDP (unicast/multicast, до %zu адресатов)\n",
+         TelemetryFanout::MAX_DESTINATIONS);
+  printf("  --udp-ttl <0..255>     TTL multicast-датаграмм (по умолчанию %d)\n", TELEMETRY_FANOUT_TTL);
+  printf("  --http-port <порт>     порт веб-сервера телеметрии, 0 — выключен (по умолчанию %d)\n",
+         TELEMETRY_SERVER_PORT);
+  printf("  --http-bind <адрес>    адрес IPv4 веб-сервера (по умолчанию %s — только эта машина;\n"
+         "                         0.0.0.0 открывает управление без пароля всей сети)\n", TELEMETRY_SERVER_BIND);
+  printf("  --joystick <путь>      устройство джойстика: /dev/input/eventN (evdev) или /dev/input/jsN\n"
+         "                         (по умолчанию — первый джойстик evdev, затем /dev/input/js0)\n");
+}
+
+// Обработчик тика движка: оси джойстика в каналы 1-4 (только в режиме joystick)
+static void joystickTick()
+{
+  // Читать события джойстика (неблокирующе)
+  js_poll();
+
+  // Канал пишется, только когда ось сдвинулась: команды кольца на каналах 1-4 не затираются
+  // каждым тиком, а отметка ядра события попадает в гистограммы задержки стик -> UART
+  if (crsfEngineWorkMode() == CRSF_MODE_JOYSTICK) {
+    js_update_channels(&crsfSetChannelStamped);
+  } else {
+    js_reset_channels();  // при возврате в joystick каналы сразу примут положение стиков
+  }
 }
 
 // Главная точка входа Linux-приложения для Raspberry Pi
 // Полная замена Arduino setup()/loop()
-int main() {
+int main(int argc, char** argv) {
+  uint32_t rcPeriodUs = CRSF_RC_PERIOD_US;
+  int rtPriority = 0;     // 0 — обычный планировщик
+  int rtCpu = -1;         // -1 — без привязки
+  bool rtLockMemory = false;
+  int udpTtl = TELEMETRY_FANOUT_TTL;
+  int httpPort = TELEMETRY_SERVER_PORT;
+  const char* httpBind = TELEMETRY_SERVER_BIND;
+  const char* joystickPath = nullptr;  // nullptr — поиск устройства
+
+  static const struct option longOptions[] = {
+    {"rc-rate", required_argument, nullptr, 'r'},
+    {"rc-period-us", required_argument, nullptr, 'p'},
+    {"rt-priority", required_argument, nullptr, 'P'},
+    {"rt-cpu", required_argument, nullptr, 'c'},
+    {"mlock", no_argument, nullptr, 'm'},
+    {"udp", required_argument, nullptr, 'u'},
+    {"udp-ttl", required_argument, nullptr, 't'},
+    {"http-port", required_argument, nullptr, 'H'},
+    {"http-bind", required_argument, nullptr, 'B'},
+    {"joystick", required_argument, nullptr, 'j'},
+    {"help", no_argument, nullptr, 'h'},
+    {nullptr, 0, nullptr, 0}
+  };
+  int opt;
+  while ((opt = getopt_long(argc, argv, "h", longOptions, nullptr)) != -1) {
+    switch (opt) {
+    case 'r': {
+      char* end = nullptr;
+      long hz = strtol(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || hz < 0) {
+        fprintf(stderr, "Ошибка: частота RC '%s' (нужно целое число Гц)\n", optarg);
+        return 1;
+      }
+      rcPeriodUs = (hz > 0) ? static_cast<uint32_t>(1000000l / hz) : 0;  // диапазон — ниже
+      break;
+    }
+    case 'p': {
+      char* end = nullptr;
+      long us = strtol(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || us < 0) {
+        fprintf(stderr, "Ошибка: период RC '%s' (нужно целое число мкс)\n", optarg);
+        return 1;
+      }
+      rcPeriodUs = us > static_cast<long>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(us);
+      break;
+    }
+    case 'P': {
+      char* end = nullptr;
+      long priority = strtol(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || priority < 1 || priority > 99) {
+        fprintf(stderr, "Ошибка: приоритет SCHED_FIFO должен быть 1..99\n");
+        return 1;
+      }
+      rtPriority = static_cast<int>(priority);
+      break;
+    }
+    case 'c': {
+      char* end = nullptr;
+      long cpu = strtol(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || cpu < 0 || cpu >= CPU_SETSIZE) {
+        fprintf(stderr, "Ошибка: номер CPU должен быть 0..%d\n", CPU_SETSIZE - 1);
+        return 1;
+      }
+      rtCpu = static_cast<int>(cpu);
+      break;
+    }
+    case 'm':
+      rtLockMemory = true;
+      break;
+    case 'u':
+      if (!udpFanout.addDestination(optarg)) {
+        fprintf(stderr, "Ошибка: адресат UDP '%s' (нужен IPv4 адрес:порт, не больше %zu адресатов)\n",
+                optarg, TelemetryFanout::MAX_DESTINATIONS);
+        return 1;
+      }
+      break;
+    case 't': {
+      char* end = nullptr;
+      long ttl = strtol(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || ttl < 0 || ttl > 255) {
+        fprintf(stderr, "Ошибка: TTL multicast должен быть 0..255\n");
+        return 1;
+      }
+      udpTtl = static_cast<int>(ttl);
+      break;
+    }
+    case 'H': {
+      char* end = nullptr;
+      long port = strtol(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || port < 0 || port > 65535) {
+        fprintf(stderr, "Ошибка: порт веб-сервера должен быть 0..65535\n");
+        return 1;
+      }
+      httpPort = static_cast<int>(port);
+      break;
+    }
+    case 'B': {
+      struct in_addr addr;
+      if (inet_pton(AF_INET, optarg, &addr) != 1) {
+        fprintf(stderr, "Ошибка: адрес веб-сервера '%s' (нужен IPv4 адрес)\n", optarg);
+        return 1;
+      }
+      httpBind = optarg;
+      break;
+    }
+    case 'j':
+      joystickPath = optarg;
+      break;
+    default:
+      printUsage(argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+  RcScheduler rcScheduler(CRSF_RC_PERIOD_US);
+  if (!rcScheduler.setPeriodUs(rcPeriodUs)) {
+    fprintf(stderr, "Ошибка: период RC %u мкс вне диапазона %u..%u\n",
+            rcPeriodUs, RcScheduler::MIN_PERIOD_US, RcScheduler::MAX_PERIOD_US);
+    return 1;
+  }
+  printf("RC-каналы: период %u мкс (%.1f Гц)\n", rcScheduler.getPeriodUs(),
+         1000000.0 / rcScheduler.getPeriodUs());
+
 #if USE_CRSF_RECV == true
   crsfInitRecv(); // Запуск CRSF приёма
 #endif
@@ -31,198 +215,80 @@ int main() {
   //БЕСПОЛЕЗНО: устаревший Arduino код - закомментированная неиспользуемая переменная
   // флаг доступности (не используется, можно удалить/раскомментировать при необходимости)
   // bool isCan = true;
-  const uint32_t crsfSendPeriodMs = 10; // ~100 Гц отправка каналов для реалтайма
-  uint32_t lastSendMs = 0;
+  // Вспомогательные потоки создаются из главного и наследуют его привязку:
+  // до их запуска убираем выделенный RT-CPU, сам главный поток перенесём на него позже
+  if (rtCpu >= 0 && !rpi_rt_exclude_cpu(rtCpu)) {
+    printf("Предупреждение: не удалось исключить CPU %d для вспомогательных потоков\n", rtCpu);
+  }
+
   // Инициализация джойстика (не критично, если недоступен)
-  if (js_open("/dev/input/js0")) {
-    printf("Джойстик подключен: %d осей, %d кнопок\n", js_num_axes(), js_num_buttons());
+  if (js_open(joystickPath)) {
+    printf("Джойстик подключен (%s): %d осей, %d кнопок\n", js_is_evdev() ? "evdev" : "joystick API",
+           js_num_axes(), js_num_buttons());
   } else {
     printf("Предупреждение: джойстик недоступен, работа без управления\n");
   }
 
-  // Структура для записи телеметрии в файл (для Python обертки)
-  struct SharedTelemetryData {
-    bool linkUp;
-    uint32_t lastReceive;
-    int channels[16];
-    // Статистика связи - отключена (поля оставлены для совместимости)
-    uint32_t packetsReceived;
-    uint32_t packetsSent;
-    uint32_t packetsLost;
-    double latitude;
-    double longitude;
-    double altitude;
-    double speed;
-    double voltage;
-    double current;
-    double capacity;
-    uint8_t remaining;
-    double roll;
-    double pitch;
-    double yaw;
-    int16_t rollRaw;
-    int16_t pitchRaw;
-    int16_t yawRaw;
-  };
-  
-  // Запускаем поток для периодической записи телеметрии в файл
-  std::thread telemetryWriterThread([&]() {
-    CrsfSerial* crsf = static_cast<CrsfSerial*>(crsfGetActive());
-    if (crsf == nullptr) return;
-    
-    while (true) {
-      SharedTelemetryData shared;
-      
-      shared.linkUp = crsf->isLinkUp();
-      shared.lastReceive = crsf->_lastReceive;
-      
-      // Каналы
-      for (int i = 0; i < 16; i++) {
-        shared.channels[i] = crsf->getChannel(i + 1);
-      }
-      
-      // Статистика связи - отключена
-      shared.packetsReceived = 0;
-      shared.packetsSent = 0;
-      shared.packetsLost = 0;
-      
-      // GPS
-      const crsf_sensor_gps_t* gps = crsf->getGpsSensor();
-      if (gps) {
-        shared.latitude = gps->latitude / 10000000.0;
-        shared.longitude = gps->longitude / 10000000.0;
-        shared.altitude = gps->altitude - 1000;
-        shared.speed = gps->groundspeed / 10.0;
-      }
-      
-      // Батарея
-      shared.voltage = crsf->getBatteryVoltage();
-      shared.current = crsf->getBatteryCurrent();
-      shared.capacity = crsf->getBatteryCapacity();
-      shared.remaining = crsf->getBatteryRemaining();
-      
-      // Положение
-      shared.roll = crsf->getAttitudeRoll();
-      shared.pitch = crsf->getAttitudePitch();
-      shared.yaw = crsf->getAttitudeYaw();
-      
-      // Сырые значения attitude
-      shared.rollRaw = crsf->getRawAttitudeRoll();
-      shared.pitchRaw = crsf->getRawAttitudePitch();
-      shared.yawRaw = crsf->getRawAttitudeYaw();
-      
-      // Записываем в файл
-      std::ofstream file("/tmp/crsf_telemetry.dat", std::ios::binary);
-      if (file.is_open()) {
-        file.write(reinterpret_cast<const char*>(&shared), sizeof(SharedTelemetryData));
-        file.close();
-      }
-      
-      rpi_delay_ms(20); // Обновляем каждые 20мс для реалтайма
-    }
-  });
-  telemetryWriterThread.detach();
-  
-  printf("✓ Поток записи телеметрии запущен для Python обертки\n");
+  // Сигналы останова — до запуска потоков, чтобы они унаследовали обработчики
+  installStopHandlers();
 
+  // Кольцо команд, снимок и история телеметрии в разделяемой памяти
+  crsfEngineInit(rcScheduler);
+  crsfEngineSetTickHandler(&joystickTick);
 
+  // Рассылка по UDP: отдельный поток на обычном приоритете, главный цикл не делает send
+  if (udpFanout.destinationCount() > 0) {
+    if (udpFanout.open(udpTtl) &&
+        fanoutShm.open(CRSF_TELEMETRY_SHM_NAME, sizeof(TelemetrySnapshot), TELEMETRY_SCHEMA_HASH) &&
+        fanoutHistory.open(CRSF_TELEMETRY_HISTORY_SHM_NAME)) {
+      fanoutDispatcher.setFrameType(TelemetryShm::ANY_FRAME, true);
+      fanoutDispatcher.setMaxLatencyNs(0);  // кадр уходит сразу, пачка копится только при отставании
+      fanoutDispatcher.setMaxBatch(TelemetryFanout::MAX_BATCH);
+      fanoutDispatcher.start(fanoutShm, fanoutHistory, &TelemetryFanout::onBatch, &udpFanout);
+      printf("✓ Рассылка телеметрии по UDP: %zu адресатов\n", udpFanout.destinationCount());
+    } else {
+      printf("Предупреждение: рассылка телеметрии по UDP не запущена\n");
+    }
+  }
 
-  // Главный цикл
-  for (;;) {
-#if USE_CRSF_RECV == true
-    loop_ch();
-#endif
+  // Веб-сервер телеметрии: свой поток, только сегменты shm и кольцо команд
+  if (httpPort > 0 && !startTelemetryServer(httpPort, TELEMETRY_SERVER_UPDATE_MS, httpBind)) {
+    printf("Предупреждение: веб-сервер телеметрии не запущен, работа без него\n");
+  }
 
-    // Обработка команд из файла (от Python обертки)
-    std::ifstream cmdFile("/tmp/crsf_command.txt");
-    if (cmdFile.is_open()) {
-      std::string cmd;
-      // Обрабатываем все команды из файла (многострочный формат)
-      while (std::getline(cmdFile, cmd)) {
-        if (cmd.find("setChannels") == 0) {
-          // Формат: setChannels 1=1500 2=1600 3=1700 ...
-          std::istringstream iss(cmd);
-          std::string token;
-          iss >> token; // пропускаем "setChannels"
-          while (iss >> token) {
-            size_t pos = token.find('=');
-            if (pos != std::string::npos) {
-              unsigned int ch = std::stoi(token.substr(0, pos));
-              int value = std::stoi(token.substr(pos + 1));
-              if (ch >= 1 && ch <= 16 && value >= 1000 && value <= 2000) {
-                crsfSetChannel(ch, value);
-              }
-            }
-          }
-        } else if (cmd.find("setChannel") == 0) {
-          unsigned int ch;
-          int value;
-          if (sscanf(cmd.c_str(), "setChannel %u %d", &ch, &value) == 2) {
-            if (ch >= 1 && ch <= 16 && value >= 1000 && value <= 2000) {
-              crsfSetChannel(ch, value);
-            }
-          }
-        } else if (cmd == "sendChannels") {
-          crsfSendChannels();
-        } else if (cmd.find("setMode") == 0) {
-          std::string mode = cmd.substr(8); // "setMode " = 8 символов
-          if (mode == "joystick" || mode == "manual") {
-            // Режим сохраняется в глобальной переменной workMode
-            // (управляется через pybind модуль, но для совместимости оставляем)
-          }
-        }
-      }
-      cmdFile.close();
-      // Удаляем файл после обработки всех команд
-      remove("/tmp/crsf_command.txt");
+  // Реалтайм-профиль главного цикла: после запуска вспомогательных потоков,
+  // чтобы они остались на обычном приоритете и других CPU
+  if (rtLockMemory) {
+    if (rpi_rt_lock_memory(CRSF_RT_HEAP_RESERVE)) {
+      rpi_rt_prefault_stack(CRSF_RT_STACK_PREFAULT);
+      printf("✓ Память процесса заблокирована (mlockall), стек и куча затронуты заранее\n");
+    } else {
+      printf("Предупреждение: mlockall не удался (нужен root или CAP_IPC_LOCK)\n");
     }
-
-#if USE_CRSF_SEND == true
-    uint32_t currentMillis = rpi_millis();
-
-    // Читать события джойстика (неблокирующе)
-    js_poll();
-
-    // Преобразуем оси джойстика [-32767..32767] в CRSF [1000..2000]
-    auto axisToUs = [](int16_t v) -> int {
-      // нормируем к [-1..1]
-      const float nf = (v >= 0) ? (static_cast<float>(v) / 32767.0f)
-                                : (static_cast<float>(v) / 32768.0f);
-      // диапазон [1000..2000]
-      float us = 1500.0f + nf * 500.0f;
-      int ius = static_cast<int>(us + 0.5f);
-      if (ius < 1000) ius = 1000;
-      if (ius > 2000) ius = 2000;
-      return ius;
-    };
-
-    // Обработка осей джойстика только в режиме joystick
-    std::string mode = getWorkMode();
-    if (mode == "joystick") {
-      int16_t ax0 = 0, ax1 = 0, ax2 = 0, ax3 = 0;
-      bool axis0_ok = js_get_axis(0, ax0);
-      bool axis1_ok = js_get_axis(1, ax1);
-      bool axis2_ok = js_get_axis(2, ax2);
-      bool axis3_ok = js_get_axis(3, ax3);
-      
-      if (axis0_ok) crsfSetChannel(1, axisToUs(ax2)); // Roll
-      if (axis1_ok) crsfSetChannel(2, axisToUs(-ax3)); // Pitch
-      if (axis2_ok) crsfSetChannel(3, axisToUs(-ax1)); // Throttle
-      if (axis3_ok) crsfSetChannel(4, axisToUs(ax0)); // Yaw
+  }
+  if (rtCpu >= 0) {
+    if (rpi_rt_pin_cpu(rtCpu)) {
+      printf("✓ Главный цикл привязан к CPU %d\n", rtCpu);
+    } else {
+      printf("Предупреждение: не удалось привязать главный цикл к CPU %d\n", rtCpu);
     }
-
-    // Отправляем RC-каналы с частотой ~100 Гц для реалтайма
-    if (currentMillis - lastSendMs >= crsfSendPeriodMs) {
-      lastSendMs = currentMillis;
-      crsfSendChannels();
+  }
+  if (rtPriority > 0) {
+    if (rpi_rt_set_fifo(rtPriority)) {
+      printf("✓ Главный цикл в SCHED_FIFO, приоритет %d\n", rtPriority);
+    } else {
+      printf("Предупреждение: SCHED_FIFO недоступен (нужен root или CAP_SYS_NICE)\n");
     }
+  }
 
 
-#endif
-    //БЕСПОЛЕЗНО: закомментированный код
-    // Реалтайм без задержек - максимальная скорость обработки
-    // rpi_delay_ms(0); // Полностью убираем задержку для реалтайма
-  }
+
+  // Главный цикл: один проход на тик планировщика (абсолютные дедлайны) до SIGINT/SIGTERM
+  crsfEngineRun(rcScheduler, stopRequested);
+
+  stopTelemetryServer();
+  fanoutDispatcher.stop();
+  js_close();
 
   return 0;
 }
@@ -23,10 +23,20 @@ class get_pybind_include(object):
 # Список исходных файлов для CRSF модуля
 crsf_sources = [
     'src/crsf_bindings.cpp',
+    os.path.join(project_root, 'crsf/crsf.cpp'),
+    os.path.join(project_root, 'crsf/crsf_engine.cpp'),
     os.path.join(project_root, 'libs/crsf/CrsfSerial.cpp'),
     os.path.join(project_root, 'libs/crsf/crc8.cpp'),
     os.path.join(project_root, 'libs/SerialPort.cpp'),
     os.path.join(project_root, 'libs/rpi_hal.cpp'),
+    os.path.join(project_root, 'libs/rc_scheduler.cpp'),
+    os.path.join(project_root, 'libs/latency_histogram.cpp'),
+    os.path.join(project_root, 'libs/telemetry_shm.cpp'),
+    os.path.join(project_root, 'libs/telemetry_snapshot.cpp'),
+    os.path.join(project_root, 'libs/telemetry_history.cpp'),
+    os.path.join(project_root, 'libs/telemetry_notifier.cpp'),
+    os.path.join(project_root, 'libs/telemetry_dispatcher.cpp'),
+    os.path.join(project_root, 'libs/command_ring.cpp'),
 ]
 
 # Директории с заголовками
@@ -48,6 +58,7 @@ ext_modules = [
         'crsf_native',
         crsf_sources,
         include_dirs=include_dirs,
+        libraries=['rt', 'pthread'],  # shm_open для glibc < 2.34, поток встроенного движка
         language='c++',
         extra_compile_args=compile_args,
     ),
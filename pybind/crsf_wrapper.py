@@ -4,8 +4,9 @@ CRSF Python Wrapper
 Обертка для работы с CRSF через pybind11
 """
 
+import asyncio
 import crsf_native
-from typing import Dict, List, Optional
+from typing import AsyncIterator, Dict, List, Optional
 import ctypes
 import os
 
@@ -47,18 +48,44 @@ class CRSFWrapper:
         """
         Автоматическая инициализация CRSF
         
-        Проверяет наличие файла с телеметрией, созданного основным приложением.
-        Данные читаются из файла /tmp/crsf_telemetry.dat без прямого доступа к указателю
-        (безопасно для межпроцессного взаимодействия).
+        Проверяет наличие сегмента разделяемой памяти с телеметрией (/dev/shm/crsf_telemetry),
+        созданного основным приложением. Сегмент отображается в память один раз, дальше
+        снимки читаются без системных вызовов и без прямого доступа к указателю.
         """
-        # Проверяем наличие файла с телеметрией
-        telemetry_file = "/tmp/crsf_telemetry.dat"
-        if os.path.exists(telemetry_file):
-            # Файл существует, значит основное приложение запущено и записывает данные
+        if crsf_native.telemetry_available():
             self._initialized = True
             return
         
-        raise RuntimeError("Файл с телеметрией не найден. Убедитесь, что crsf_io_rpi запущен.")
+        raise RuntimeError("Сегмент телеметрии не найден. Убедитесь, что crsf_io_rpi запущен.")
+    
+    def start_engine(self, rc_period_us: Optional[int] = None):
+        """
+        Запустить встроенный движок CRSF в этом процессе (без crsf_io_rpi)
+        
+        Порты, планировщик RC-кадров и публикация телеметрии работают на собственном
+        потоке модуля без GIL. Телеметрия и команды идут через те же сегменты
+        разделяемой памяти, поэтому внешние читатели продолжают работать.
+        
+        Args:
+            rc_period_us: Период RC-кадров в мкс (None — значение из config.h)
+        
+        Raises:
+            RuntimeError: crsf_io_rpi уже запущен
+        """
+        if rc_period_us is None:
+            crsf_native.start_engine()
+        else:
+            crsf_native.start_engine(rc_period_us)
+        self._initialized = True
+    
+    def stop_engine(self):
+        """Остановить встроенный движок"""
+        crsf_native.stop_engine()
+    
+    @property
+    def engine_running(self) -> bool:
+        """Работает ли встроенный движок"""
+        return crsf_native.engine_running()
     
     def get_telemetry(self) -> Dict:
         """
@@ -79,6 +106,8 @@ class CRSFWrapper:
             'activePort': data.activePort,
             'lastReceive': data.lastReceive,
             'timestamp': data.timestamp,
+            'frameType': data.frameType,
+            'publishCount': data.publishCount,
             'channels': data.channels,
             'packetsReceived': data.packetsReceived,
             'packetsSent': data.packetsSent,
@@ -105,19 +134,182 @@ class CRSFWrapper:
                 'pitch': data.pitchRaw,
                 'yaw': data.yawRaw
             },
+            'rcScheduler': {
+                'periodUs': data.rcPeriodUs,
+                'ticks': data.rcTicks,
+                'overruns': data.rcOverruns,
+                'jitterAvgUs': data.rcJitterAvgUs,
+                'jitterMaxUs': data.rcJitterMaxUs,
+                'syncActive': data.rcSyncActive,
+                'syncOffsetUs': data.rcSyncOffsetUs
+            },
+            'latency': {
+                'samples': data.latSamples,
+                'totalP50Us': data.latTotalP50Us,
+                'totalP90Us': data.latTotalP90Us,
+                'totalP99Us': data.latTotalP99Us,
+                'totalMaxUs': data.latTotalMaxUs,
+                'ipcP50Us': data.latIpcP50Us,
+                'ipcP99Us': data.latIpcP99Us,
+                'queueP50Us': data.latQueueP50Us,
+                'queueP99Us': data.latQueueP99Us,
+                'writeP50Us': data.latWriteP50Us,
+                'writeP99Us': data.latWriteP99Us
+            },
             'workMode': self.get_work_mode()
         }
     
-    def set_work_mode(self, mode: str):
+    def update_telemetry(self) -> int:
+        """
+        Обновить последний снимок на месте без выделения памяти
+        
+        Массивы telemetry_array() и channels_array() смотрят на этот снимок, поэтому
+        в цикле управления их достаточно получить один раз и дальше вызывать только
+        update_telemetry().
+        
+        Returns:
+            Номер публикации снимка или -1 (сегмент недоступен, значения не изменились)
+        """
+        return crsf_native.update_telemetry()
+    
+    def telemetry_array(self):
+        """
+        Последний снимок как 0-мерный структурный массив NumPy (crsf_native.TELEMETRY_DTYPE)
+        
+        Представление без копии и только для чтения, обновляется update_telemetry():
+            snap = crsf.telemetry_array()
+            crsf.update_telemetry()
+            print(snap['voltage'], snap['channels'][0])
+        """
+        return crsf_native.telemetry_array()
+    
+    def channels_array(self):
+        """Каналы последнего снимка как массив NumPy uint16[16] без копии (обновляется update_telemetry())"""
+        return crsf_native.channels_array()
+    
+    def history_array(self):
+        """
+        Кольцо истории целиком как массив NumPy (crsf_native.HISTORY_ENTRY_DTYPE) поверх
+        разделяемой памяти, без копии и только для чтения
+        
+        Запись позиции pos лежит в слоте pos % len(ring) и действительна, пока
+        ring['stamp'][slot] == 2*pos+2 (писатель может перезаписать её в любой момент).
+        Для согласованных пачек используйте read_history_into().
+        
+        Returns:
+            Массив или None, если история недоступна
+        """
+        return crsf_native.history_array()
+    
+    def read_history_into(self, out, cursor: Optional[int] = None):
+        """
+        Прочитать кадры истории после курсора в заранее выделенный массив
+        
+        Args:
+            out: numpy.empty(n, dtype=crsf_native.HISTORY_RECORD_DTYPE)
+            cursor: Курсор из прошлого вызова; None — всё, что есть в кольце
+        
+        Returns:
+            (count, next_cursor, dropped): сколько записей заполнено в out[:count],
+            курсор для следующего вызова и количество вытесненных кадров
+        """
+        if not self._initialized:
+            raise RuntimeError("CRSF не инициализирован. Вызовите auto_init() сначала.")
+        return crsf_native.read_history_into(out, -1 if cursor is None else cursor)
+    
+    def on_frames(self, frame_type: Optional[int], callback) -> int:
+        """
+        Подписать callback на принятые кадры типа frame_type (None — все кадры)
+        
+        Кадры доставляются пачками с нативного потока: callback(records) получает массив
+        NumPy crsf_native.HISTORY_RECORD_DTYPE (поля pos, timestampNs, frameType, snapshot),
+        GIL берётся один раз на пачку. Размер пачки и задержка — set_frame_batch().
+        
+        Returns:
+            id для remove_frame_callback()
+        """
+        if not self._initialized:
+            raise RuntimeError("CRSF не инициализирован. Вызовите auto_init() сначала.")
+        return crsf_native.register_frame_callback(-1 if frame_type is None else frame_type, callback)
+    
+    def remove_frame_callback(self, callback_id: int) -> bool:
+        """Отписать колбэк кадров (можно вызывать из самого колбэка)"""
+        return crsf_native.unregister_frame_callback(callback_id)
+    
+    def set_frame_batch(self, max_latency: float = 0.01, max_batch: int = 64):
+        """
+        Параметры пачек колбэков кадров
+        
+        Args:
+            max_latency: Максимальная задержка первого кадра пачки, секунды
+            max_batch: Максимум кадров в пачке
+        """
+        crsf_native.set_frame_batch(max_latency * 1000.0, max_batch)
+    
+    def get_history_cursor(self) -> int:
+        """Курсор следующей записи истории (читать только новые кадры), -1 — история недоступна"""
+        return crsf_native.get_history_cursor()
+    
+    def read_history(self, cursor: Optional[int] = None, max_records: int = 1024):
+        """
+        Прочитать все кадры телеметрии после курсора одной пачкой
+        
+        В отличие от get_telemetry() (последний снимок) история содержит снимок после
+        каждого принятого кадра, поэтому между вызовами ничего не теряется, пока читатель
+        отстаёт не больше чем на размер кольца (1024 кадра).
+        
+        Args:
+            cursor: Курсор из прошлого вызова; None — всё, что есть в кольце
+            max_records: Максимум записей за вызов
+        
+        Returns:
+            (records, next_cursor, dropped): записи TelemetryHistoryRecord (pos, timestampNs,
+            frameType и поля снимка как у get_telemetry), курсор для следующего вызова и
+            количество кадров, вытесненных до чтения
+        """
+        if not self._initialized:
+            raise RuntimeError("CRSF не инициализирован. Вызовите auto_init() сначала.")
+        return crsf_native.read_history(-1 if cursor is None else cursor, max_records)
+    
+    def get_update_counter(self, frame_type: Optional[int] = None) -> int:
+        """Текущий счётчик публикаций (для wait_for_update(since=...)), -1 — сегмент недоступен"""
+        return crsf_native.get_frame_counter(-1 if frame_type is None else frame_type)
+    
+    def wait_for_update(self, frame_type: Optional[int] = None, timeout: float = 1.0,
+                        since: Optional[int] = None) -> Optional[int]:
+        """
+        Дождаться новой публикации телеметрии (без опроса, futex в сегменте)
+        
+        Args:
+            frame_type: Тип кадра CRSF (например 0x08 — батарея), None — любое обновление
+            timeout: Максимальное время ожидания, секунды
+            since: Счётчик, возвращённый прошлым вызовом (None — ждать следующую публикацию).
+                   Передавайте его, чтобы не пропустить кадры между вызовами
+        
+        Returns:
+            Новый счётчик публикаций или None по таймауту
+        """
+        if not self._initialized:
+            raise RuntimeError("CRSF не инициализирован. Вызовите auto_init() сначала.")
+        
+        counter = crsf_native.wait_for_frame(-1 if frame_type is None else frame_type,
+                                             timeout * 1000.0,
+                                             -1 if since is None else since)
+        return None if counter < 0 else counter
+    
+    def set_work_mode(self, mode: str) -> int:
         """
         Установить режим работы
         
         Args:
             mode: 'joystick' или 'manual'
+        
+        Returns:
+            Номер команды в кольце команд или -1 (crsf_io_rpi не запущен / кольцо полно)
         """
         if mode not in ['joystick', 'manual']:
             raise ValueError(f"Неверный режим: {mode}. Допустимые значения: 'joystick', 'manual'")
-        crsf_native.set_work_mode(mode)
+        return crsf_native.set_work_mode(mode)
     
     def get_work_mode(self) -> str:
         """
@@ -128,37 +320,206 @@ class CRSFWrapper:
         """
         return crsf_native.get_work_mode()
     
-    def set_channel(self, channel: int, value: int):
+    def set_channel(self, channel: int, value: int) -> int:
         """
         Установить значение канала
         
         Args:
             channel: Номер канала (1-16)
             value: Значение (1000-2000)
+        
+        Returns:
+            Номер команды в кольце команд или -1
         """
         if not (1 <= channel <= 16):
             raise ValueError(f"Номер канала должен быть от 1 до 16, получено: {channel}")
         if not (1000 <= value <= 2000):
             raise ValueError(f"Значение канала должно быть от 1000 до 2000, получено: {value}")
-        crsf_native.set_channel(channel, value)
+        return crsf_native.set_channel(channel, value)
     
-    def set_channels(self, channels: List[int]):
+    def set_channels(self, channels) -> int:
         """
         Установить все каналы одновременно
         
         Args:
-            channels: Список значений каналов (16 элементов, 1000-2000)
+            channels: Список или массив NumPy значений каналов (16 элементов, 1000-2000).
+                      Массив int32 передаётся без копии
+        
+        Returns:
+            Номер команды в кольце команд или -1
         """
         if len(channels) < 16:
             raise ValueError(f"Должно быть 16 каналов, получено: {len(channels)}")
-        crsf_native.set_channels(channels[:16])
+        return crsf_native.set_channels(channels[:16])
+    
+    def send_channels(self) -> int:
+        """Отправить пакет каналов (возвращает номер команды или -1)"""
+        return crsf_native.send_channels()
     
-    def send_channels(self):
-        """Отправить пакет каналов"""
-        crsf_native.send_channels()
+    def is_command_applied(self, seq: int) -> bool:
+        """Выполнена ли основным приложением команда с номером seq"""
+        return seq >= 0 and crsf_native.get_applied_command_seq() > seq
     
     @property
     def is_initialized(self) -> bool:
         """Проверка инициализации"""
         return self._initialized
 
+
+class AsyncCRSFWrapper:
+    """
+    asyncio-API поверх CRSFWrapper
+    
+    Уведомления о публикациях приходят через eventfd модуля (crsf_native.telemetry_fd()),
+    добавленный в цикл событий через loop.add_reader(): поток Python на каждый источник
+    не нужен, корутины просыпаются только при новой публикации.
+    
+        async with AsyncCRSFWrapper() as crsf:
+            async for record in crsf.frames(frame_type=0x08):
+                print(record.voltage)
+    """
+    
+    def __init__(self, wrapper: Optional[CRSFWrapper] = None):
+        self._crsf = wrapper if wrapper is not None else CRSFWrapper()
+        self._loop = None
+        self._fd = -1
+        self._waiters = []
+    
+    @property
+    def wrapper(self) -> CRSFWrapper:
+        """Синхронная обёртка (get_telemetry(), массивы NumPy и т.д.)"""
+        return self._crsf
+    
+    async def open(self):
+        """Подключиться к телеметрии и добавить дескриптор уведомлений в текущий цикл событий"""
+        if self._fd >= 0:
+            return
+        if not self._crsf.is_initialized:
+            self._crsf.auto_init()
+        fd = crsf_native.telemetry_fd()
+        if fd < 0:
+            raise RuntimeError("Сегмент телеметрии не найден. Убедитесь, что crsf_io_rpi запущен.")
+        self._loop = asyncio.get_event_loop()
+        self._loop.add_reader(fd, self._on_readable)
+        self._fd = fd
+    
+    async def close(self):
+        """Убрать дескриптор из цикла событий (сам дескриптор модуля остаётся открытым)"""
+        if self._fd >= 0:
+            self._loop.remove_reader(self._fd)
+            self._fd = -1
+        for waiter in self._waiters:
+            if not waiter.done():
+                waiter.cancel()
+        self._waiters = []
+    
+    async def __aenter__(self):
+        await self.open()
+        return self
+    
+    async def __aexit__(self, exc_type, exc, tb):
+        await self.close()
+    
+    def _on_readable(self):
+        crsf_native.drain_telemetry_fd()
+        waiters, self._waiters = self._waiters, []
+        for waiter in waiters:
+            if not waiter.done():
+                waiter.set_result(None)
+    
+    async def _next_publish(self, timeout: Optional[float]):
+        """Дождаться следующей публикации (любого кадра); asyncio.TimeoutError по таймауту"""
+        if self._fd < 0:
+            await self.open()
+        waiter = self._loop.create_future()
+        self._waiters.append(waiter)
+        await asyncio.wait_for(waiter, timeout)
+    
+    def _remaining(self, deadline: Optional[float]) -> Optional[float]:
+        if deadline is None:
+            return None
+        return max(0.0, deadline - self._loop.time())
+    
+    async def wait_for(self, frame_type: Optional[int] = None, timeout: Optional[float] = None) -> int:
+        """
+        Дождаться публикации кадра frame_type (None — любой публикации)
+        
+        Returns:
+            Новый счётчик публикаций этого типа
+        
+        Raises:
+            asyncio.TimeoutError: Публикации не было за timeout секунд
+        """
+        if self._fd < 0:
+            await self.open()
+        key = -1 if frame_type is None else frame_type
+        since = crsf_native.get_frame_counter(key)
+        deadline = None if timeout is None else self._loop.time() + timeout
+        while True:
+            await self._next_publish(self._remaining(deadline))
+            counter = crsf_native.get_frame_counter(key)
+            if counter != since:
+                return counter
+    
+    async def frames(self, frame_type: Optional[int] = None,
+                     cursor: Optional[int] = None) -> AsyncIterator:
+        """
+        Асинхронный итератор принятых кадров из истории телеметрии
+        
+        Каждый элемент — TelemetryHistoryRecord (pos, timestampNs, frameType и поля снимка).
+        Кадры между итерациями не теряются, пока потребитель отстаёт не больше чем на
+        размер кольца истории.
+        
+        Args:
+            frame_type: Только кадры этого типа CRSF (None — все)
+            cursor: Начальный курсор истории (None — только новые кадры)
+        """
+        if self._fd < 0:
+            await self.open()
+        if cursor is None:
+            cursor = crsf_native.get_history_cursor()
+            if cursor < 0:
+                raise RuntimeError("История телеметрии недоступна")
+        while True:
+            records, cursor, _ = crsf_native.read_history(cursor)
+            for record in records:
+                if frame_type is None or record.frameType == frame_type:
+                    yield record
+            if not records:
+                await self._next_publish(None)
+    
+    async def _submit(self, push, timeout: Optional[float]) -> int:
+        """
+        Поставить команду и дождаться её выполнения основным приложением
+        
+        Полное кольцо команд не ошибка: команда повторяется после следующей публикации.
+        После выполнения команд crsf_io_rpi публикует снимок, поэтому ждём тот же дескриптор
+        """
+        if self._fd < 0:
+            await self.open()
+        deadline = None if timeout is None else self._loop.time() + timeout
+        seq = push()
+        while seq < 0:
+            await self._next_publish(self._remaining(deadline))
+            seq = push()
+        while not self._crsf.is_command_applied(seq):
+            await self._next_publish(self._remaining(deadline))
+        return seq
+    
+    async def set_work_mode(self, mode: str, timeout: Optional[float] = 1.0) -> int:
+        """Переключить режим и дождаться выполнения команды (номер команды)"""
+        if mode not in ('joystick', 'manual'):
+            raise ValueError(f"Режим должен быть 'joystick' или 'manual', получено: {mode}")
+        return await self._submit(lambda: crsf_native.set_work_mode(mode), timeout)
+    
+    async def set_channel(self, channel: int, value: int, timeout: Optional[float] = 1.0) -> int:
+        """Установить канал и дождаться выполнения команды (номер команды)"""
+        return await self._submit(lambda: self._crsf.set_channel(channel, value), timeout)
+    
+    async def set_channels(self, channels, timeout: Optional[float] = 1.0) -> int:
+        """Установить все каналы и дождаться выполнения команды (номер команды)"""
+        return await self._submit(lambda: self._crsf.set_channels(channels), timeout)
+    
+    async def send_channels(self, timeout: Optional[float] = 1.0) -> int:
+        """Отправить RC-кадр и дождаться выполнения команды (номер команды)"""
+        return await self._submit(crsf_native.send_channels, timeout)
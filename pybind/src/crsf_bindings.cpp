@@ -1,16 +1,29 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
-#include <fstream>
 #include <cstdint>
+#include <cstring>
 #include "../crsf/crsf.h"
+#include "../crsf/crsf_engine.h"
 #include "../libs/crsf/CrsfSerial.h"
+#include "../libs/rpi_hal.h"
+#include "../libs/telemetry_shm.h"
+#include "../libs/telemetry_snapshot.h"
+#include "../libs/telemetry_history.h"
+#include "../libs/telemetry_notifier.h"
+#include "../libs/telemetry_dispatcher.h"
+#include "../libs/command_ring.h"
 
 namespace py = pybind11;
 
@@ -18,36 +31,47 @@ namespace py = pybind11;
 static CrsfSerial* crsfInstance = nullptr;
 static std::mutex telemetryMutex;
 static std::string workMode = "manual"; // joystick, manual - по умолчанию ручной режим
+// Сегмент телеметрии основного приложения: открывается один раз, дальше чтение без системных вызовов
+static TelemetryShm telemetryShm;
+// История телеметрии основного приложения: все кадры, читается пачками по курсору
+static TelemetryHistory telemetryHistory;
+// Уведомления о публикациях для циклов событий (asyncio): eventfd, поток ждёт futex сегмента
+static TelemetryNotifier telemetryNotifier;
+// Колбэки Python на кадры: диспетчер копит кадры подписанных типов и отдаёт пачкой,
+// GIL берётся один раз на пачку. Список колбэков меняется и читается только под GIL
+struct FrameCallback {
+    int id;
+    int frameType;  // тип кадра CRSF, -1 — все кадры
+    py::function callback;
+};
+static std::vector<FrameCallback> frameCallbacks;
+static int nextFrameCallbackId = 1;
+static TelemetryDispatcher frameDispatcher;
+// Кольцо команд основного приложения (пишем без блокировок и системных вызовов)
+static CommandRing commandRing;
+// Встроенный движок: SerialPort/CrsfSerial на собственном потоке модуля, без GIL.
+// Python работает с ним через те же снимок и кольцо команд, но без отдельного процесса
+static std::mutex engineMutex;
+static std::thread engineThread;
+static std::atomic<bool> engineStop(false);
+static RcScheduler engineScheduler(CRSF_RC_PERIOD_US);
+// Последний снимок для NumPy-представлений: обновляется на месте update_telemetry()
+static TelemetrySnapshot latestSnapshot = {};
+// Снимок старше этого считается устаревшим (crsf_io_rpi остановлен)
+static const uint64_t TELEMETRY_STALE_NS = 1000000000ull;
 
-// Структура для телеметрии
+// Телеметрия для Python: снимок в единой схеме (libs/telemetry_snapshot.h) и метаданные
+// публикации. Поля снимка отдаются в Python напрямую, без промежуточной копии
 struct TelemetryData {
-    bool linkUp = false;
+    TelemetrySnapshot snapshot = {};
     std::string activePort = "Unknown";
-    uint32_t lastReceive = 0;
-    std::vector<int> channels;
-    uint32_t packetsReceived = 0;
-    uint32_t packetsSent = 0;
-    uint32_t packetsLost = 0;
-    double latitude = 0.0;
-    double longitude = 0.0;
-    double altitude = 0.0;
-    double speed = 0.0;
-    double voltage = 0.0;
-    double current = 0.0;
-    double capacity = 0.0;
-    uint8_t remaining = 0;
-    double roll = 0.0;
-    double pitch = 0.0;
-    double yaw = 0.0;
-    int16_t rollRaw = 0;
-    int16_t pitchRaw = 0;
-    int16_t yawRaw = 0;
-    std::string timestamp;
+    uint32_t frameType = 0;      // тип кадра последней публикации (0 — периодическая)
+    uint64_t publishCount = 0;   // номер публикации снимка
+    std::chrono::system_clock::time_point time;  // момент чтения, строка — только по запросу
 };
 
-// Функция для получения текущего времени
-std::string getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
+// Время в формате ЧЧ:ММ:СС.ммм
+std::string formatTime(std::chrono::system_clock::time_point now) {
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()) % 1000;
@@ -84,163 +108,510 @@ void autoInitCrsfInstance() {
     }
 }
 
-// Структура для чтения данных из файла (совместима с записью из main.cpp)
-struct SharedTelemetryData {
-    bool linkUp;
-    uint32_t lastReceive;
-    int channels[16];
-    uint32_t packetsReceived;
-    uint32_t packetsSent;
-    uint32_t packetsLost;
-    double latitude;
-    double longitude;
-    double altitude;
-    double speed;
-    double voltage;
-    double current;
-    double capacity;
-    uint8_t remaining;
-    double roll;
-    double pitch;
-    double yaw;
-    int16_t rollRaw;
-    int16_t pitchRaw;
-    int16_t yawRaw;
-};
+// Открыть сегмент телеметрии при первом обращении (вызывать под telemetryMutex)
+static bool ensureTelemetryShm() {
+    return telemetryShm.isOpen() ||
+           telemetryShm.open(CRSF_TELEMETRY_SHM_NAME, sizeof(TelemetrySnapshot), TELEMETRY_SCHEMA_HASH);
+}
+
+// Доступен ли сегмент телеметрии основного приложения
+bool telemetryAvailable() {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    return ensureTelemetryShm();
+}
+
+// Текущий счётчик публикаций кадров типа frameType (-1 — всех публикаций)
+int64_t getFrameCounter(int frameType) {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    return ensureTelemetryShm() ? static_cast<int64_t>(telemetryShm.frameCounter(frameType)) : -1;
+}
+
+// Ждать публикации кадра типа frameType (-1 — любой публикации) без опроса: futex в сегменте.
+// since — счётчик, возвращённый прошлым вызовом (-1 — ждать следующую публикацию).
+// Возвращает новый счётчик или -1 по таймауту. GIL отпущен на время ожидания
+int64_t waitForFrame(int frameType, double timeoutMs, int64_t since) {
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        if (!ensureTelemetryShm()) return -1;
+    }
+    // Сегмент после открытия не закрывается: ждём без telemetryMutex
+    uint32_t sinceCounter = (since < 0) ? telemetryShm.frameCounter(frameType)
+                                        : static_cast<uint32_t>(since);
+    uint64_t timeoutNs = (timeoutMs > 0.0) ? static_cast<uint64_t>(timeoutMs * 1000000.0) : 0;
+    uint32_t counter = 0;
+    bool changed;
+    {
+        py::gil_scoped_release release;
+        changed = telemetryShm.waitFrame(frameType, sinceCounter, timeoutNs, &counter);
+    }
+    return changed ? static_cast<int64_t>(counter) : -1;
+}
+
+// Дескриптор уведомлений о публикациях (eventfd) для loop.add_reader(); -1 — сегмент недоступен.
+// Дескриптор читаемый, пока есть публикации после drain_telemetry_fd()
+int telemetryFd() {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    if (!ensureTelemetryShm()) return -1;
+    if (!telemetryNotifier.isRunning() && !telemetryNotifier.start(telemetryShm)) return -1;
+    return telemetryNotifier.fd();
+}
 
-// Получение телеметрии из файла (безопасный способ для межпроцессного взаимодействия)
+// Сбросить дескриптор уведомлений: количество публикаций с прошлого сброса
+uint64_t drainTelemetryFd() {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    return telemetryNotifier.drain();
+}
+
+// Остановить поток уведомлений и закрыть дескриптор (поток может ждать до 100 мс)
+void closeTelemetryFd() {
+    py::gil_scoped_release release;  // GIL отпускаем до мьютекса: иначе взаимная блокировка
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    telemetryNotifier.stop();
+}
+
+// Получение телеметрии из разделяемой памяти (seqlock: согласованный снимок без блокировки писателя)
 TelemetryData getTelemetry() {
     std::lock_guard<std::mutex> lock(telemetryMutex);
     TelemetryData data;
     
-    // Читаем данные из файла, созданного основным приложением
-    std::ifstream file("/tmp/crsf_telemetry.dat", std::ios::binary);
-    if (file.is_open() && file.good()) {
-        SharedTelemetryData shared;
-        file.read(reinterpret_cast<char*>(&shared), sizeof(SharedTelemetryData));
-        file.close();
-        
-        if (file.gcount() == sizeof(SharedTelemetryData)) {
-            // Копируем данные из разделяемой структуры
-            data.linkUp = shared.linkUp;
-            data.lastReceive = shared.lastReceive;
-            data.channels.assign(shared.channels, shared.channels + 16);
-            data.packetsReceived = shared.packetsReceived;
-            data.packetsSent = shared.packetsSent;
-            data.packetsLost = shared.packetsLost;
-            data.latitude = shared.latitude;
-            data.longitude = shared.longitude;
-            data.altitude = shared.altitude;
-            data.speed = shared.speed;
-            data.voltage = shared.voltage;
-            data.current = shared.current;
-            data.capacity = shared.capacity;
-            data.remaining = shared.remaining;
-            data.roll = shared.roll;
-            data.pitch = shared.pitch;
-            data.yaw = shared.yaw;
-            data.rollRaw = shared.rollRaw;
-            data.pitchRaw = shared.pitchRaw;
-            data.yawRaw = shared.yawRaw;
-            data.activePort = "UART Active";
+    TelemetryShmMeta meta;
+    if (ensureTelemetryShm()) {
+        if (telemetryShm.read(&data.snapshot, &meta)) {
+            data.frameType = meta.frameType;
+            data.publishCount = meta.publishCount;
+            // Сегмент переживает основное приложение: старый снимок — нет связи
+            data.activePort = (rpi_nanos() - meta.publishNs < TELEMETRY_STALE_NS) ? "UART Active" : "No Connection";
         } else {
+            data.snapshot = TelemetrySnapshot();  // неудачные попытки могли оставить смешанный снимок
             data.activePort = "No Connection";
         }
     } else {
         data.activePort = "No Connection";
     }
     
-    data.timestamp = getCurrentTime();
+    data.time = std::chrono::system_clock::now();
     return data;
 }
 
-// Установка режима работы через файл команд
-void setWorkMode(const std::string& mode) {
+// Обновить последний снимок на месте (для представлений telemetry_array()/channels_array()).
+// Без выделения памяти; номер публикации или -1 (сегмент недоступен или писатель не дал
+// согласованный снимок — тогда представления сохраняют прошлые значения)
+int64_t updateTelemetry() {
     std::lock_guard<std::mutex> lock(telemetryMutex);
-    if (mode == "joystick" || mode == "manual") {
-        workMode = mode;
-        // Записываем команду в файл для основного приложения
-        std::ofstream cmdFile("/tmp/crsf_command.txt");
-        if (cmdFile.is_open()) {
-            cmdFile << "setMode " << mode << std::endl;
-            cmdFile.close();
+    TelemetrySnapshot snapshot;
+    TelemetryShmMeta meta;
+    if (!ensureTelemetryShm() || !telemetryShm.read(&snapshot, &meta)) return -1;
+    latestSnapshot = snapshot;
+    return static_cast<int64_t>(meta.publishCount);
+}
+
+// Формат NumPy для типа поля схемы
+static const char* numpyFormat(TelemetryFieldType type) {
+    switch (type) {
+        case TELEMETRY_U8:  return "u1";
+        case TELEMETRY_U16: return "<u2";
+        case TELEMETRY_U32: return "<u4";
+        case TELEMETRY_U64: return "<u8";
+        case TELEMETRY_I16: return "<i2";
+        case TELEMETRY_I32: return "<i4";
+        case TELEMETRY_F64: return "<f8";
+    }
+    return "V1";
+}
+
+// Структурный dtype снимка, построенный по описанию схемы TELEMETRY_FIELDS
+static py::dtype snapshotDtype() {
+    static py::dtype* dtype = nullptr;  // живёт до выхода интерпретатора
+    if (!dtype) {
+        py::list names, formats, offsets;
+        for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+            const TelemetryFieldInfo& field = TELEMETRY_FIELDS[f];
+            std::string format = numpyFormat(field.type);
+            if (field.count > 1) format = "(" + std::to_string(field.count) + ",)" + format;
+            names.append(field.name);
+            formats.append(format);
+            offsets.append(field.offset);
         }
+        dtype = new py::dtype(names, formats, offsets, sizeof(TelemetrySnapshot));
     }
+    return *dtype;
 }
 
-// Получение режима работы
-std::string getWorkMode() {
+// dtype записи истории: метаданные + вложенный снимок. stampField — сырая запись кольца
+// (TelemetryHistoryEntry, первое поле stamp), иначе прочитанная TelemetryHistoryRecord
+static py::dtype historyDtype(bool stampField) {
+    static py::dtype* entry = nullptr;
+    static py::dtype* record = nullptr;
+    py::dtype*& dtype = stampField ? entry : record;
+    if (!dtype) {
+        py::list names, formats, offsets;
+        names.append(stampField ? "stamp" : "pos");
+        names.append("timestampNs");
+        names.append("frameType");
+        names.append("snapshot");
+        formats.append("<u8");
+        formats.append("<u8");
+        formats.append("<u4");
+        formats.append(snapshotDtype());
+        if (stampField) {
+            offsets.append(offsetof(TelemetryHistoryEntry, stamp));
+            offsets.append(offsetof(TelemetryHistoryEntry, timestampNs));
+            offsets.append(offsetof(TelemetryHistoryEntry, frameType));
+            offsets.append(offsetof(TelemetryHistoryEntry, snapshot));
+            dtype = new py::dtype(names, formats, offsets, sizeof(TelemetryHistoryEntry));
+        } else {
+            offsets.append(offsetof(TelemetryHistoryRecord, pos));
+            offsets.append(offsetof(TelemetryHistoryRecord, timestampNs));
+            offsets.append(offsetof(TelemetryHistoryRecord, frameType));
+            offsets.append(offsetof(TelemetryHistoryRecord, snapshot));
+            dtype = new py::dtype(names, formats, offsets, sizeof(TelemetryHistoryRecord));
+        }
+    }
+    return *dtype;
+}
+
+// Представление NumPy над памятью модуля или сегмента без копии и только для чтения.
+// Память статическая или не освобождается до выхода, поэтому владелец — пустая капсула
+static py::array readonlyView(const py::dtype& dtype, std::vector<py::ssize_t> shape, const void* ptr) {
+    py::capsule owner(ptr, [](void*) {});
+    py::array view(dtype, std::move(shape), std::vector<py::ssize_t>(), ptr, owner);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
+}
+
+// Последний снимок (0-мерный структурный массив) поверх буфера модуля
+py::array telemetryArray() {
+    return readonlyView(snapshotDtype(), {}, &latestSnapshot);
+}
+
+// Каналы последнего снимка (uint16[16]) поверх буфера модуля
+py::array channelsArray() {
+    return readonlyView(py::dtype("<u2"), {16}, latestSnapshot.channels);
+}
+
+// Открыть историю телеметрии при первом обращении (вызывать под telemetryMutex)
+static bool ensureTelemetryHistory() {
+    return telemetryHistory.isOpen() || telemetryHistory.open(CRSF_TELEMETRY_HISTORY_SHM_NAME);
+}
+
+// Курсор следующей записи истории (для чтения только новых кадров), -1 — история недоступна
+int64_t getHistoryCursor() {
     std::lock_guard<std::mutex> lock(telemetryMutex);
-    return workMode;
+    return ensureTelemetryHistory() ? static_cast<int64_t>(telemetryHistory.head()) : -1;
 }
 
-// Установка канала через файл команд (добавляет команду, не перезаписывает)
-void setChannel(unsigned int channel, int value) {
-    if (channel >= 1 && channel <= 16 && value >= 1000 && value <= 2000) {
-        // Добавляем команду в файл (append mode) для основного приложения
-        std::ofstream cmdFile("/tmp/crsf_command.txt", std::ios::app);
-        if (cmdFile.is_open()) {
-            cmdFile << "setChannel " << channel << " " << value << std::endl;
-            cmdFile.close();
+// Все кадры истории после курсора одной пачкой (cursor < 0 — всё, что есть в кольце).
+// Возвращает (записи, следующий курсор, пропущено вытесненных записей)
+py::tuple readHistory(int64_t cursor, size_t maxRecords) {
+    std::vector<TelemetryHistoryRecord> records;
+    uint64_t next = cursor < 0 ? 0 : static_cast<uint64_t>(cursor);
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        if (!ensureTelemetryHistory()) return py::make_tuple(records, next, dropped);
+    }
+    // Сегмент после открытия не закрывается: копируем без telemetryMutex и без GIL
+    {
+        py::gil_scoped_release release;
+        uint64_t head = telemetryHistory.head();
+        uint64_t from = cursor < 0 ? telemetryHistory.tail() : std::min(next, head);
+        records.resize(std::min<uint64_t>(std::min<uint64_t>(maxRecords, head - from), telemetryHistory.capacity()));
+        records.resize(telemetryHistory.read(from, records.data(), records.size(), &next, &dropped));
+    }
+    return py::make_tuple(records, next, dropped);
+}
+
+// Кольцо истории целиком (capacity записей) поверх сегмента разделяемой памяти, без копии.
+// Запись с позицией pos действительна, если её stamp == 2*pos+2 (см. telemetry_history.h)
+py::object historyArray() {
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        if (!ensureTelemetryHistory()) return py::none();
+    }
+    return readonlyView(historyDtype(true), {static_cast<py::ssize_t>(telemetryHistory.capacity())},
+                        telemetryHistory.entries());
+}
+
+// Прочитать записи истории после курсора в заранее выделенный массив HISTORY_RECORD_DTYPE
+// (без выделения памяти на вызов). Возвращает (записано, следующий курсор, пропущено)
+py::tuple readHistoryInto(py::array out, int64_t cursor) {
+    if (!out.dtype().equal(historyDtype(false)) || out.ndim() != 1 ||
+        !(out.flags() & py::array::c_style) || !out.writeable()) {
+        throw py::value_error("out: одномерный непрерывный изменяемый массив с dtype HISTORY_RECORD_DTYPE");
+    }
+    uint64_t next = cursor < 0 ? 0 : static_cast<uint64_t>(cursor);
+    uint64_t dropped = 0;
+    size_t n = 0;
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        if (!ensureTelemetryHistory()) return py::make_tuple(n, next, dropped);
+    }
+    auto* records = static_cast<TelemetryHistoryRecord*>(out.mutable_data());
+    size_t maxRecords = static_cast<size_t>(out.shape(0));
+    {
+        py::gil_scoped_release release;
+        uint64_t from = cursor < 0 ? telemetryHistory.tail() : next;
+        n = telemetryHistory.read(from, records, maxRecords, &next, &dropped);
+    }
+    return py::make_tuple(n, next, dropped);
+}
+
+// Обработчик пачки на потоке диспетчера: один захват GIL, каждому колбэку — массив
+// HISTORY_RECORD_DTYPE только с его типом кадра (одна копия на колбэк, без объекта на кадр)
+static void deliverFrameBatch(const TelemetryHistoryRecord* records, size_t count, void*) {
+    py::gil_scoped_acquire gil;
+    std::vector<FrameCallback> callbacks = frameCallbacks;  // колбэк может отписаться во время вызова
+    std::vector<TelemetryHistoryRecord> matched;
+    for (const FrameCallback& cb : callbacks) {
+        py::array batch;
+        if (cb.frameType < 0) {
+            batch = py::array(historyDtype(false), {static_cast<py::ssize_t>(count)}, std::vector<py::ssize_t>(), records);
+        } else {
+            matched.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (records[i].frameType == static_cast<uint32_t>(cb.frameType)) matched.push_back(records[i]);
+            }
+            if (matched.empty()) continue;
+            batch = py::array(historyDtype(false), {static_cast<py::ssize_t>(matched.size())}, std::vector<py::ssize_t>(), matched.data());
+        }
+        try {
+            cb.callback(batch);
+        } catch (py::error_already_set& e) {
+            e.discard_as_unraisable("crsf_native frame callback");  // ошибка колбэка не останавливает доставку
         }
     }
 }
 
-// Установка всех каналов одной командой
-void setChannels(const std::vector<int>& channels) {
-    if (channels.size() >= 16) {
-        std::ofstream cmdFile("/tmp/crsf_command.txt");
-        if (cmdFile.is_open()) {
-            cmdFile << "setChannels";
-            for (size_t i = 0; i < 16; i++) {
-                if (channels[i] >= 1000 && channels[i] <= 2000) {
-                    cmdFile << " " << (i + 1) << "=" << channels[i];
-                }
+// Подписки диспетчера по текущему списку колбэков (под GIL)
+static void updateFrameSubscriptions() {
+    frameDispatcher.clearFrameTypes();
+    for (const FrameCallback& cb : frameCallbacks) {
+        frameDispatcher.setFrameType(cb.frameType, true);
+    }
+}
+
+// Остановить диспетчер (при выходе): поток может ждать GIL в обработчике, поэтому GIL отпускаем
+static void stopFrameDispatcher() {
+    py::gil_scoped_release release;
+    frameDispatcher.stop();
+}
+
+// Подписать callback(records) на кадры типа frameType (-1 — все). records — массив
+// HISTORY_RECORD_DTYPE, накопленный за пачку. Возвращает id для unregister_frame_callback()
+int registerFrameCallback(int frameType, py::function callback) {
+    if (frameType < -1 || frameType > 255) throw py::value_error("frame_type: 0..255 или -1");
+    if (!frameDispatcher.isRunning()) {
+        {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            if (!ensureTelemetryShm() || !ensureTelemetryHistory()) {
+                throw std::runtime_error("Сегменты телеметрии не найдены. Убедитесь, что crsf_io_rpi запущен.");
             }
-            cmdFile << std::endl;
-            cmdFile.close();
         }
+        // Сегменты после открытия не закрываются: диспетчер читает их без telemetryMutex
+        frameDispatcher.start(telemetryShm, telemetryHistory, &deliverFrameBatch, nullptr);
+    }
+    frameCallbacks.push_back({nextFrameCallbackId++, frameType, std::move(callback)});
+    updateFrameSubscriptions();
+    return frameCallbacks.back().id;
+}
+
+// Отписать колбэк (можно из самого колбэка). Без подписок диспетчер GIL не берёт
+bool unregisterFrameCallback(int id) {
+    auto it = std::find_if(frameCallbacks.begin(), frameCallbacks.end(),
+                           [id](const FrameCallback& cb) { return cb.id == id; });
+    if (it == frameCallbacks.end()) return false;
+    frameCallbacks.erase(it);
+    updateFrameSubscriptions();
+    return true;
+}
+
+// Параметры пачки: максимальная задержка первого кадра и максимальный размер
+void setFrameBatch(double maxLatencyMs, size_t maxBatch) {
+    frameDispatcher.setMaxLatencyNs(maxLatencyMs > 0.0 ? static_cast<uint64_t>(maxLatencyMs * 1000000.0) : 0);
+    frameDispatcher.setMaxBatch(maxBatch);
+}
+
+// Кольцо команд основного приложения: открывается при первой команде (вызывать под telemetryMutex)
+static bool ensureCommandRing() {
+    return commandRing.isOpen() || commandRing.open(CRSF_COMMAND_SHM_NAME);
+}
+
+// Поставить команду в кольцо; номер команды или -1 (приложение не запущено / кольцо полно)
+static int64_t pushCommand(CrsfCommand& cmd) {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    if (!ensureCommandRing()) return -1;
+    cmd.originNs = rpi_nanos(); // отметка для трассировки задержки команды до UART
+    return commandRing.push(cmd);
+}
+
+// Установка режима работы
+int64_t setWorkMode(const std::string& mode) {
+    if (mode != "joystick" && mode != "manual") return -1;
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        workMode = mode;
     }
+    CrsfCommand cmd = {};
+    cmd.type = CRSF_CMD_SET_MODE;
+    cmd.value = (mode == "joystick") ? CRSF_MODE_JOYSTICK : CRSF_MODE_MANUAL;
+    return pushCommand(cmd);
+}
+
+// Получение режима работы
+std::string getWorkMode() {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    return workMode;
+}
+
+// Установка одного канала
+int64_t setChannel(unsigned int channel, int value) {
+    if (channel < 1 || channel > 16 || value < 1000 || value > 2000) return -1;
+    CrsfCommand cmd = {};
+    cmd.type = CRSF_CMD_SET_CHANNEL;
+    cmd.channel = static_cast<uint8_t>(channel);
+    cmd.value = value;
+    return pushCommand(cmd);
+}
+
+// Установка всех каналов одной командой (значения вне 1000..2000 пропускаются).
+// Массив NumPy int32 читается без копии, список или другой dtype приводится один раз
+int64_t setChannels(py::array_t<int32_t, py::array::c_style | py::array::forcecast> channels) {
+    if (channels.ndim() != 1 || channels.shape(0) < 16) return -1;
+    const int32_t* values = channels.data();
+    CrsfCommand cmd = {};
+    cmd.type = CRSF_CMD_SET_CHANNELS;
+    for (size_t i = 0; i < 16; i++) {
+        if (values[i] >= 1000 && values[i] <= 2000) {
+            cmd.mask |= static_cast<uint16_t>(1u << i);
+            cmd.values[i] = static_cast<uint16_t>(values[i]);
+        }
+    }
+    return pushCommand(cmd);
+}
+
+// Немедленная отправка RC-кадра
+int64_t sendChannels() {
+    CrsfCommand cmd = {};
+    cmd.type = CRSF_CMD_SEND;
+    return pushCommand(cmd);
+}
+
+// Номер последней выполненной основным приложением команды + 1
+uint64_t getAppliedCommandSeq() {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    return ensureCommandRing() ? commandRing.appliedSeq() : 0;
+}
+
+// Поля снимка для Python: читаются прямо из TelemetrySnapshot (T — класс с полем snapshot)
+template <typename T>
+static void bindSnapshotFields(py::class_<T>& cls) {
+#define SNAPSHOT_FIELD(name) \
+        .def_property_readonly(#name, [](const T& d) { return d.snapshot.name; })
+    cls
+        .def_property_readonly("linkUp", [](const T& d) { return d.snapshot.linkUp != 0; })
+        SNAPSHOT_FIELD(lastReceive)
+        .def_property_readonly("channels", [](const T& d) {
+            return std::vector<int>(d.snapshot.channels, d.snapshot.channels + 16);
+        })
+        SNAPSHOT_FIELD(packetsReceived)
+        SNAPSHOT_FIELD(packetsSent)
+        SNAPSHOT_FIELD(packetsLost)
+        SNAPSHOT_FIELD(latitude)
+        SNAPSHOT_FIELD(longitude)
+        SNAPSHOT_FIELD(altitude)
+        SNAPSHOT_FIELD(speed)
+        SNAPSHOT_FIELD(voltage)
+        SNAPSHOT_FIELD(current)
+        SNAPSHOT_FIELD(capacity)
+        SNAPSHOT_FIELD(remaining)
+        SNAPSHOT_FIELD(roll)
+        SNAPSHOT_FIELD(pitch)
+        SNAPSHOT_FIELD(yaw)
+        SNAPSHOT_FIELD(rollRaw)
+        SNAPSHOT_FIELD(pitchRaw)
+        SNAPSHOT_FIELD(yawRaw)
+        SNAPSHOT_FIELD(rcPeriodUs)
+        SNAPSHOT_FIELD(rcTicks)
+        SNAPSHOT_FIELD(rcOverruns)
+        SNAPSHOT_FIELD(rcJitterAvgUs)
+        SNAPSHOT_FIELD(rcJitterMaxUs)
+        .def_property_readonly("rcSyncActive", [](const T& d) { return d.snapshot.rcSyncActive != 0; })
+        SNAPSHOT_FIELD(rcSyncOffsetUs)
+        SNAPSHOT_FIELD(latSamples)
+        SNAPSHOT_FIELD(latTotalP50Us)
+        SNAPSHOT_FIELD(latTotalP90Us)
+        SNAPSHOT_FIELD(latTotalP99Us)
+        SNAPSHOT_FIELD(latTotalMaxUs)
+        SNAPSHOT_FIELD(latIpcP50Us)
+        SNAPSHOT_FIELD(latIpcP99Us)
+        SNAPSHOT_FIELD(latQueueP50Us)
+        SNAPSHOT_FIELD(latQueueP99Us)
+        SNAPSHOT_FIELD(latWriteP50Us)
+        SNAPSHOT_FIELD(latWriteP99Us);
+#undef SNAPSHOT_FIELD
 }
 
-// Отправка каналов через файл команд
-// ВАЖНО: используем append режим, чтобы не перезаписать команды setChannel
-void sendChannels() {
-    std::ofstream cmdFile("/tmp/crsf_command.txt", std::ios::app);
-    if (cmdFile.is_open()) {
-        cmdFile << "sendChannels" << std::endl;
-        cmdFile.close();
+// Запустить встроенный движок: открыть порты CRSF и крутить главный цикл на потоке модуля
+void startEngine(uint32_t rcPeriodUs) {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (engineThread.joinable()) return;
+    if (crsfEngineOwnedElsewhere()) {
+        throw std::runtime_error("crsf_io_rpi уже запущен: встроенный движок не может открыть те же порты");
+    }
+    if (!engineScheduler.setPeriodUs(rcPeriodUs)) {
+        throw py::value_error("Период RC вне диапазона " + std::to_string(RcScheduler::MIN_PERIOD_US) +
+                              ".." + std::to_string(RcScheduler::MAX_PERIOD_US) + " мкс");
     }
+#if USE_CRSF_RECV == true
+    crsfInitRecv();
+#endif
+#if USE_CRSF_SEND == true
+    crsfInitSend();
+#endif
+    crsfEngineInit(engineScheduler);
+    engineStop.store(false);
+    engineThread = std::thread([]() { crsfEngineRun(engineScheduler, engineStop); });
+}
+
+// Остановить встроенный движок (ждёт завершения текущего тика)
+void stopEngine() {
+    py::gil_scoped_release release;  // GIL отпускаем до мьютекса: иначе взаимная блокировка
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (!engineThread.joinable()) return;
+    engineStop.store(true);
+    engineThread.join();
+}
+
+bool engineRunning() {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    return engineThread.joinable();
 }
 
 // Модуль pybind11
 PYBIND11_MODULE(crsf_native, m) {
     m.doc() = "CRSF Native C++ bindings for Python";
+    m.attr("TELEMETRY_SCHEMA_VERSION") = TELEMETRY_SCHEMA_VERSION;
+    m.attr("TELEMETRY_SCHEMA_HASH") = TELEMETRY_SCHEMA_HASH;
+    m.attr("TELEMETRY_DTYPE") = snapshotDtype();
+    m.attr("HISTORY_ENTRY_DTYPE") = historyDtype(true);
+    m.attr("HISTORY_RECORD_DTYPE") = historyDtype(false);
     
     // Экспорт структуры TelemetryData
-    py::class_<TelemetryData>(m, "TelemetryData")
-        .def_readwrite("linkUp", &TelemetryData::linkUp)
-        .def_readwrite("activePort", &TelemetryData::activePort)
-        .def_readwrite("lastReceive", &TelemetryData::lastReceive)
-        .def_readwrite("channels", &TelemetryData::channels)
-        .def_readwrite("packetsReceived", &TelemetryData::packetsReceived)
-        .def_readwrite("packetsSent", &TelemetryData::packetsSent)
-        .def_readwrite("packetsLost", &TelemetryData::packetsLost)
-        .def_readwrite("latitude", &TelemetryData::latitude)
-        .def_readwrite("longitude", &TelemetryData::longitude)
-        .def_readwrite("altitude", &TelemetryData::altitude)
-        .def_readwrite("speed", &TelemetryData::speed)
-        .def_readwrite("voltage", &TelemetryData::voltage)
-        .def_readwrite("current", &TelemetryData::current)
-        .def_readwrite("capacity", &TelemetryData::capacity)
-        .def_readwrite("remaining", &TelemetryData::remaining)
-        .def_readwrite("roll", &TelemetryData::roll)
-        .def_readwrite("pitch", &TelemetryData::pitch)
-        .def_readwrite("yaw", &TelemetryData::yaw)
-        .def_readwrite("rollRaw", &TelemetryData::rollRaw)
-        .def_readwrite("pitchRaw", &TelemetryData::pitchRaw)
-        .def_readwrite("yawRaw", &TelemetryData::yawRaw)
-        .def_readwrite("timestamp", &TelemetryData::timestamp);
+    py::class_<TelemetryData> telemetryData(m, "TelemetryData");
+    bindSnapshotFields(telemetryData);
+    telemetryData
+        .def_readonly("activePort", &TelemetryData::activePort)
+        .def_readonly("frameType", &TelemetryData::frameType)
+        .def_readonly("publishCount", &TelemetryData::publishCount)
+        .def_property_readonly("timestamp", [](const TelemetryData& d) { return formatTime(d.time); });
+    
+    // Запись истории телеметрии
+    py::class_<TelemetryHistoryRecord> historyRecord(m, "TelemetryHistoryRecord");
+    bindSnapshotFields(historyRecord);
+    historyRecord
+        .def_readonly("pos", &TelemetryHistoryRecord::pos)
+        .def_readonly("timestampNs", &TelemetryHistoryRecord::timestampNs)
+        .def_readonly("frameType", &TelemetryHistoryRecord::frameType);
     
     // Экспорт функций
     m.def("init_crsf_instance", &initCrsfInstance,
@@ -250,9 +621,92 @@ PYBIND11_MODULE(crsf_native, m) {
     m.def("auto_init_crsf_instance", &autoInitCrsfInstance,
           "Auto-initialize CRSF instance from crsfGetActive()");
     
+    m.def("start_engine", &startEngine,
+          "Run the CRSF engine (serial ports, RC scheduler, telemetry) on a native thread in this process",
+          py::arg("rc_period_us") = CRSF_RC_PERIOD_US);
+    
+    m.def("stop_engine", &stopEngine,
+          "Stop the in-process CRSF engine");
+    
+    m.def("engine_running", &engineRunning,
+          "Whether the in-process CRSF engine is running");
+    
+    // Потоки движка и уведомлений должны завершиться до выгрузки модуля
+    py::module_::import("atexit").attr("register")(py::cpp_function(&stopEngine));
+    py::module_::import("atexit").attr("register")(py::cpp_function(&closeTelemetryFd));
+    py::module_::import("atexit").attr("register")(py::cpp_function([]() {
+        stopFrameDispatcher();
+        frameCallbacks.clear();
+    }));
+    
     m.def("get_telemetry", &getTelemetry,
           "Get telemetry data");
     
+    m.def("telemetry_fd", &telemetryFd,
+          "Non-blocking eventfd that becomes readable on every telemetry publish "
+          "(for loop.add_reader), -1 if the segment is unavailable");
+    
+    m.def("drain_telemetry_fd", &drainTelemetryFd,
+          "Reset the telemetry fd; returns the number of publishes since the last drain");
+    
+    m.def("close_telemetry_fd", &closeTelemetryFd,
+          "Stop the notifier thread and close the telemetry fd");
+    
+    m.def("register_frame_callback", &registerFrameCallback,
+          "Call callback(records) with batches of received frames of the given CRSF type (-1: all); "
+          "records is a HISTORY_RECORD_DTYPE array, the GIL is taken once per batch. Returns an id",
+          py::arg("frame_type"), py::arg("callback"));
+    
+    m.def("unregister_frame_callback", &unregisterFrameCallback,
+          "Remove a frame callback by id",
+          py::arg("callback_id"));
+    
+    m.def("set_frame_batch", &setFrameBatch,
+          "Frame callback batching: maximum latency of the first frame in a batch and maximum batch size",
+          py::arg("max_latency_ms") = 10.0, py::arg("max_batch") = TelemetryDispatcher::DEFAULT_MAX_BATCH);
+    
+    m.def("get_frame_callback_dropped", []() { return frameDispatcher.dropped(); },
+          "Frames overwritten in the history ring before the callback dispatcher read them");
+    
+    m.def("update_telemetry", &updateTelemetry,
+          "Refresh the latest snapshot behind telemetry_array()/channels_array() in place; "
+          "returns the publish count or -1");
+    
+    m.def("telemetry_array", &telemetryArray,
+          "Read-only zero-copy NumPy view (TELEMETRY_DTYPE) of the latest snapshot");
+    
+    m.def("channels_array", &channelsArray,
+          "Read-only zero-copy uint16[16] NumPy view of the latest snapshot channels");
+    
+    m.def("history_array", &historyArray,
+          "Read-only zero-copy NumPy view (HISTORY_ENTRY_DTYPE) of the whole history ring, "
+          "None if unavailable");
+    
+    m.def("read_history_into", &readHistoryInto,
+          "Read history records after the cursor into a preallocated HISTORY_RECORD_DTYPE array; "
+          "returns (count, next_cursor, dropped)",
+          py::arg("out"), py::arg("cursor") = -1);
+    
+    m.def("telemetry_available", &telemetryAvailable,
+          "Check that the crsf_io_rpi telemetry segment exists");
+    
+    m.def("get_history_cursor", &getHistoryCursor,
+          "Cursor of the next telemetry history record (-1 if the history segment is unavailable)");
+    
+    m.def("read_history", &readHistory,
+          "Read all telemetry history records after the cursor in one batch; "
+          "returns (records, next_cursor, dropped)",
+          py::arg("cursor") = -1, py::arg("max_records") = CRSF_TELEMETRY_HISTORY_SIZE);
+    
+    m.def("get_frame_counter", &getFrameCounter,
+          "Publish counter for the given CRSF frame type (-1: all updates), -1 if unavailable",
+          py::arg("frame_type") = -1);
+    
+    m.def("wait_for_frame", &waitForFrame,
+          "Block until a frame of the given CRSF type (-1: any update) is published; "
+          "returns the new counter or -1 on timeout",
+          py::arg("frame_type") = -1, py::arg("timeout_ms") = 1000.0, py::arg("since") = -1);
+    
     m.def("set_work_mode", &setWorkMode,
           "Set work mode (joystick or manual)",
           py::arg("mode"));
@@ -265,10 +719,13 @@ PYBIND11_MODULE(crsf_native, m) {
           py::arg("channel"), py::arg("value"));
     
     m.def("set_channels", &setChannels,
-          "Set all channels at once",
+          "Set all channels at once (list or NumPy array of 16 values)",
           py::arg("channels"));
     
     m.def("send_channels", &sendChannels,
           "Send channels packet");
+    
+    m.def("get_applied_command_seq", &getAppliedCommandSeq,
+          "Sequence number of the last command applied by crsf_io_rpi, plus one");
 }
 
@@ -1,248 +1,726 @@
+#include <atomic>
 #include <iostream>
-#include <thread>
-#include <mutex>
 #include <chrono>
-#include <sstream>
-#include <iomanip>
-#include <sys/socket.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
 #include <unistd.h>
-#include <cstring>
-#include "libs/crsf/CrsfSerial.h"
+#include "config.h"
+#include "telemetry_server.h"
+#include "libs/channel_command.h"
+#include "libs/command_ring.h"
+#include "libs/http_server.h"
+#include "libs/crsf_metrics.h"
+#include "libs/json_writer.h"
+#include "libs/prometheus_writer.h"
+#include "libs/rpi_hal.h"
+#include "libs/telemetry_history.h"
+#include "libs/telemetry_notifier.h"
+#include "libs/telemetry_pyramid.h"
+#include "libs/telemetry_shm.h"
+#include "libs/telemetry_snapshot.h"
+#include "libs/telemetry_wire.h"
 
-// Глобальные переменные для телеметрии
+// Глобальные переменные для телеметрии: снимок в единой схеме (libs/telemetry_snapshot.h)
+// и служебные поля веб-сервера. Всё состояние сервера принадлежит его потоку
 struct TelemetryData {
-    // Статус связи
-    bool linkUp = false;
+    TelemetrySnapshot snapshot = {};
     std::string activePort = "Unknown";
-    uint32_t lastReceive = 0;
-    
-    // RC каналы
-    int channels[16] = {0};
-    
-    // Статистика связи
-    uint32_t packetsReceived = 0;
-    uint32_t packetsSent = 0;
-    uint32_t packetsLost = 0;
-    
-    // GPS данные (если доступны)
-    double latitude = 0.0;
-    double longitude = 0.0;
-    double altitude = 0.0;
-    double speed = 0.0;
-    
-    // Батарея
-    double voltage = 0.0;
-    double current = 0.0;
-    double capacity = 0.0;
-    uint8_t remaining = 0;
-    
-    // Положение
-    double roll = 0.0;
-    double pitch = 0.0;
-    double yaw = 0.0;
-    
-    // Сырые значения attitude (raw bytes)
-    int16_t rawAttitudeBytes[3] = {0};  // [0]=roll, [1]=pitch, [2]=yaw
-    
-    // Режим работы
-    std::string workMode = "joystick"; // joystick, manual
-    
-    std::string timestamp;
+    char timestamp[24] = "";           // время последнего изменения, ЧЧ:ММ:СС.ммм
+    uint64_t version = 0;              // растёт при каждом изменении полей выше
 };
 
 static TelemetryData telemetryData;
-static std::mutex telemetryMutex;
-static CrsfSerial* crsfInstance = nullptr;
 
-// Функция для получения текущего режима работы
-std::string getWorkMode() {
-    std::lock_guard<std::mutex> lock(telemetryMutex);
-    return telemetryData.workMode;
-}
+// Сегменты crsf_io_rpi: снимок и история телеметрии (только чтение, открываются при первом запросе)
+static TelemetryShm crsfShm;
+static TelemetryHistory crsfHistory;
+// Кольцо команд главного цикла (писатель, открывается при первой команде)
+static CommandRing commandRing;
+
+// Тело /api/telemetry, сериализованное для версии telemetryJsonVersion: клиенты, опрашивающие
+// одну версию, получают готовый буфер, а с совпавшим If-None-Match — 304 без тела
+static char telemetryJson[4096];
+static size_t telemetryJsonSize = 0;
+static uint64_t telemetryJsonVersion = ~0ull;
+static char telemetryETag[48];      // "эпоха-версия" в кавычках
+static char telemetryHeaders[96];   // ETag и Cache-Control для ответа
+static uint64_t serverEpochNs = 0;  // отличает версии разных запусков сервера
 
 // Функция для получения текущего времени
-std::string getCurrentTime() {
+static void formatCurrentTime(char* out, size_t size) {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+    struct tm local;
+    localtime_r(&time_t, &local);
+    char hms[9];
+    strftime(hms, sizeof(hms), "%H:%M:%S", &local);
+    snprintf(out, size, "%s.%03d", hms, static_cast<int>(ms.count()));
 }
 
-// Функция для обновления телеметрии
-void updateTelemetry() {
-    std::lock_guard<std::mutex> lock(telemetryMutex);
-    
-    if (crsfInstance) {
-        telemetryData.linkUp = crsfInstance->isLinkUp();
-        telemetryData.lastReceive = crsfInstance->_lastReceive;
-        
-        // Получаем каналы
-        for (int i = 0; i < 16; i++) {
-            telemetryData.channels[i] = crsfInstance->getChannel(i + 1);
-        }
-        
-        // Получаем статистику связи
-        const crsfLinkStatistics_t* stats = crsfInstance->getLinkStatistics();
-        if (stats) {
-            telemetryData.packetsReceived = stats->uplink_RSSI_1;
-            telemetryData.packetsSent = stats->uplink_RSSI_2;
-            telemetryData.packetsLost = 100 - stats->uplink_Link_quality; // Потерянные пакеты = 100 - качество связи
-        }
-        
-        // Получаем GPS данные
-        const crsf_sensor_gps_t* gps = crsfInstance->getGpsSensor();
-        if (gps) {
-            // Конвертируем из формата CRSF (degree / 10,000,000) в обычные градусы
-            telemetryData.latitude = gps->latitude / 10000000.0;
-            telemetryData.longitude = gps->longitude / 10000000.0;
-            // Высота в метрах, +1000м offset
-            telemetryData.altitude = gps->altitude - 1000;
-            // Скорость в км/ч / 10
-            telemetryData.speed = gps->groundspeed / 10.0;
-        }
-        
-        // Получаем данные батареи
-        telemetryData.voltage = crsfInstance->getBatteryVoltage();
-        telemetryData.current = crsfInstance->getBatteryCurrent();
-        telemetryData.capacity = crsfInstance->getBatteryCapacity();
-        telemetryData.remaining = crsfInstance->getBatteryRemaining();
-        
-        // Получаем данные положения
-        telemetryData.roll = crsfInstance->getAttitudeRoll();
-        telemetryData.pitch = crsfInstance->getAttitudePitch();
-        telemetryData.yaw = crsfInstance->getAttitudeYaw();
-        
-        // Получаем сырые значения attitude
-        telemetryData.rawAttitudeBytes[0] = crsfInstance->getRawAttitudeRoll();
-        telemetryData.rawAttitudeBytes[1] = crsfInstance->getRawAttitudePitch();
-        telemetryData.rawAttitudeBytes[2] = crsfInstance->getRawAttitudeYaw();
-    }
-    
-    telemetryData.timestamp = getCurrentTime();
-    
-    // Определяем активный порт
-    if (crsfInstance) {
-        telemetryData.activePort = "UART Active";
-    } else {
-        telemetryData.activePort = "No Connection";
-    }
+static bool openCrsfSegments() {
+    if (crsfShm.isOpen() && crsfHistory.isOpen()) return true;
+    return crsfShm.open(CRSF_TELEMETRY_SHM_NAME, sizeof(TelemetrySnapshot), TELEMETRY_SCHEMA_HASH) &&
+           crsfHistory.open(CRSF_TELEMETRY_HISTORY_SHM_NAME);
 }
 
-// Функция для отправки HTTP ответа
-void sendHttpResponse(int clientSocket, const std::string& content, const std::string& contentType = "text/html") {
-    std::stringstream response;
-    response << "HTTP/1.1 200 OK\r\n";
-    response << "Content-Type: " << contentType << "\r\n";
-    response << "Content-Length: " << content.length() << "\r\n";
-    response << "Access-Control-Allow-Origin: *\r\n";
-    response << "Connection: close\r\n\r\n";
-    response << content;
+// Функция для обновления телеметрии: последний снимок из сегмента (seqlock, без блокировок
+// главного цикла); версия растёт, только если данные изменились
+static void updateTelemetry() {
+    TelemetrySnapshot snap = telemetryData.snapshot;
+    bool active = openCrsfSegments() && crsfShm.read(&snap);
+    
+    // Определяем активный порт
+    const char* activePort = active ? "UART Active" : "No Connection";
     
-    std::string responseStr = response.str();
-    send(clientSocket, responseStr.c_str(), responseStr.length(), 0);
+    if (memcmp(&snap, &telemetryData.snapshot, sizeof(snap)) != 0 || telemetryData.activePort != activePort) {
+        telemetryData.snapshot = snap;
+        telemetryData.activePort = activePort;
+        formatCurrentTime(telemetryData.timestamp, sizeof(telemetryData.timestamp));
+        telemetryData.version++;
+    }
 }
 
-// Функция для создания JSON телеметрии
-std::string createTelemetryJson() {
-    std::lock_guard<std::mutex> lock(telemetryMutex);
-    
-    std::stringstream json;
-    json << "{";
-    json << "\"linkUp\":" << (telemetryData.linkUp ? "true" : "false") << ",";
-    json << "\"activePort\":\"" << telemetryData.activePort << "\",";
-    json << "\"lastReceive\":" << telemetryData.lastReceive << ",";
-    json << "\"timestamp\":\"" << telemetryData.timestamp << "\",";
+// Сериализовать телеметрию в кэш, если версия изменилась (без выделений памяти)
+static void refreshTelemetryJson() {
+    if (telemetryJsonVersion == telemetryData.version) return;
+    const TelemetrySnapshot& snap = telemetryData.snapshot;
+    
+    JsonWriter json(telemetryJson, sizeof(telemetryJson));
+    json.beginObject();
+    json.key("linkUp"); json.boolValue(snap.linkUp != 0);
+    json.key("activePort"); json.stringValue(telemetryData.activePort.data(), telemetryData.activePort.size());
+    json.key("lastReceive"); json.uintValue(snap.lastReceive);
+    json.key("timestamp"); json.stringValue(telemetryData.timestamp);
     
     // RC каналы
-    json << "\"channels\":[";
+    json.key("channels");
+    json.beginArray();
     for (int i = 0; i < 16; i++) {
-        if (i > 0) json << ",";
-        json << telemetryData.channels[i];
+        json.uintValue(snap.channels[i]);
     }
-    json << "],";
+    json.endArray();
     
     // Статистика
-    json << "\"packetsReceived\":" << telemetryData.packetsReceived << ",";
-    json << "\"packetsSent\":" << telemetryData.packetsSent << ",";
-    json << "\"packetsLost\":" << telemetryData.packetsLost << ",";
+    json.key("packetsReceived"); json.uintValue(snap.packetsReceived);
+    json.key("packetsSent"); json.uintValue(snap.packetsSent);
+    json.key("packetsLost"); json.uintValue(snap.packetsLost);
     
     // GPS
-    json << "\"gps\":{";
-    json << "\"latitude\":" << telemetryData.latitude << ",";
-    json << "\"longitude\":" << telemetryData.longitude << ",";
-    json << "\"altitude\":" << telemetryData.altitude << ",";
-    json << "\"speed\":" << telemetryData.speed;
-    json << "},";
+    json.key("gps");
+    json.beginObject();
+    json.key("latitude"); json.doubleValue(snap.latitude);
+    json.key("longitude"); json.doubleValue(snap.longitude);
+    json.key("altitude"); json.doubleValue(snap.altitude);
+    json.key("speed"); json.doubleValue(snap.speed);
+    json.endObject();
     
     // Батарея
-    json << "\"battery\":{";
-    json << "\"voltage\":" << telemetryData.voltage << ",";
-    json << "\"current\":" << telemetryData.current << ",";
-    json << "\"capacity\":" << telemetryData.capacity << ",";
-    json << "\"remaining\":" << (int)telemetryData.remaining;
-    json << "},";
+    json.key("battery");
+    json.beginObject();
+    json.key("voltage"); json.doubleValue(snap.voltage);
+    json.key("current"); json.doubleValue(snap.current);
+    json.key("capacity"); json.doubleValue(snap.capacity);
+    json.key("remaining"); json.uintValue(snap.remaining);
+    json.endObject();
     
     // Положение
-    json << "\"attitude\":{";
-    json << "\"roll\":" << telemetryData.roll << ",";
-    json << "\"pitch\":" << telemetryData.pitch << ",";
-    json << "\"yaw\":" << telemetryData.yaw;
-    json << "},";
+    json.key("attitude");
+    json.beginObject();
+    json.key("roll"); json.doubleValue(snap.roll);
+    json.key("pitch"); json.doubleValue(snap.pitch);
+    json.key("yaw"); json.doubleValue(snap.yaw);
+    json.endObject();
     
     // Сырые значения attitude (raw CRSF bytes)
-    json << "\"attitudeRaw\":{";
-    json << "\"roll\":" << telemetryData.rawAttitudeBytes[0] << ",";
-    json << "\"pitch\":" << telemetryData.rawAttitudeBytes[1] << ",";
-    json << "\"yaw\":" << telemetryData.rawAttitudeBytes[2];
-    json << "},";
-    
-    // Режим работы
-    json << "\"workMode\":\"" << telemetryData.workMode << "\"";
-    
-    json << "}";
-    return json.str();
+    json.key("attitudeRaw");
+    json.beginObject();
+    json.key("roll"); json.intValue(snap.rollRaw);
+    json.key("pitch"); json.intValue(snap.pitchRaw);
+    json.key("yaw"); json.intValue(snap.yawRaw);
+    json.endObject();
+    
+    // Режим работы главного цикла (применённый, а не последний запрошенный)
+    json.key("workMode"); json.stringValue(snap.workMode == CRSF_MODE_JOYSTICK ? "joystick" : "manual");
+    
+    json.endObject();
+    telemetryJsonSize = json.size();
+    telemetryJsonVersion = telemetryData.version;
+    snprintf(telemetryETag, sizeof(telemetryETag), "\"%llx-%llu\"",
+             static_cast<unsigned long long>(serverEpochNs), static_cast<unsigned long long>(telemetryJsonVersion));
+    snprintf(telemetryHeaders, sizeof(telemetryHeaders), "ETag: %s\r\nCache-Control: no-cache\r\n", telemetryETag);
 }
 
-// Функция для обработки команд управления
-void handleCommand(const std::string& command, const std::string& value) {
-    std::lock_guard<std::mutex> lock(telemetryMutex);
-    
+// Клиент уже видел текущую версию (If-None-Match с нашим ETag или *)
+static bool telemetryNotModified(const HttpRequest& request) {
+    const std::string* match = request.header("if-none-match");
+    if (!match) return false;
+    return *match == "*" || match->find(telemetryETag) != std::string::npos;
+}
+
+// Целое из строки целиком; false — пусто, лишние символы или вне [min, max]
+static bool parseInt(const std::string& text, long min, long max, long* out) {
+    char* end = nullptr;
+    long v = strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || v < min || v > max) return false;
+    *out = v;
+    return true;
+}
+
+// Результат команды управления
+enum CommandStatus {
+    COMMAND_QUEUED,       // команда в кольце, seq — её номер
+    COMMAND_INVALID,      // неизвестная команда или неверное значение
+    COMMAND_UNAVAILABLE,  // кольца нет (crsf_io_rpi не запущен) или оно полно
+};
+
+// Поставить команду в кольцо главного цикла (отметка времени — для гистограмм задержки)
+static CommandStatus pushCommand(CrsfCommand& cmd, int64_t* seq) {
+    if (!commandRing.isOpen() && !commandRing.open(CRSF_COMMAND_SHM_NAME)) return COMMAND_UNAVAILABLE;
+    cmd.originNs = rpi_nanos();
+    *seq = commandRing.push(cmd);
+    return *seq < 0 ? COMMAND_UNAVAILABLE : COMMAND_QUEUED;
+}
+
+// Функция для обработки команд управления: команда ставится в кольцо и применяется
+// главным циклом на ближайшем тике, сервер каналы напрямую не трогает
+static CommandStatus handleCommand(const std::string& command, const std::string& value, int64_t* seq) {
+    CrsfCommand cmd = {};
     if (command == "setMode") {
-        if (value == "joystick" || value == "manual") {
-            telemetryData.workMode = value;
-            std::cout << "🔧 Режим изменен на: " << value << std::endl;
-        }
+        if (value != "joystick" && value != "manual") return COMMAND_INVALID;
+        cmd.type = CRSF_CMD_SET_MODE;
+        cmd.value = (value == "joystick") ? CRSF_MODE_JOYSTICK : CRSF_MODE_MANUAL;
     } else if (command == "setChannel") {
         // Формат: channel=value (например: 1=1500)
         size_t pos = value.find('=');
-        if (pos != std::string::npos) {
-            int channel = std::stoi(value.substr(0, pos));
-            int val = std::stoi(value.substr(pos + 1));
-            if (channel >= 1 && channel <= 16 && val >= 1000 && val <= 2000) {
-                if (crsfInstance) {
-                    crsfInstance->setChannel(channel, val);
-                    std::cout << "🎮 Канал " << channel << " установлен в " << val << " мкс" << std::endl;
+        long channel = 0;
+        long val = 0;
+        if (pos == std::string::npos || !parseInt(value.substr(0, pos), 1, 16, &channel) ||
+            !parseInt(value.substr(pos + 1), CHANNEL_COMMAND_MIN_US, CHANNEL_COMMAND_MAX_US, &val)) {
+            return COMMAND_INVALID;
+        }
+        cmd.type = CRSF_CMD_SET_CHANNEL;
+        cmd.channel = static_cast<uint8_t>(channel);
+        cmd.value = static_cast<int32_t>(val);
+    } else {
+        return COMMAND_INVALID;
+    }
+    
+    // Режим в /api/telemetry меняется, когда главный цикл применит команду и опубликует снимок
+    CommandStatus status = pushCommand(cmd, seq);
+    if (status == COMMAND_QUEUED && cmd.type == CRSF_CMD_SET_MODE) {
+        std::cout << "🔧 Запрошен режим: " << value << std::endl;
+    }
+    return status;
+}
+
+// Ответ на команду: номер команды в кольце или ошибка
+static void respondCommand(HttpServer& server, int conn, CommandStatus status, int64_t seq) {
+    if (status == COMMAND_QUEUED) {
+        char body[64];
+        int len = snprintf(body, sizeof(body), "{\"status\":\"ok\",\"seq\":%lld}", static_cast<long long>(seq));
+        server.respond(conn, 200, "application/json", body, static_cast<size_t>(len));
+    } else if (status == COMMAND_INVALID) {
+        server.respond(conn, 400, "application/json", std::string("{\"error\":\"invalid command\"}"));
+    } else {
+        server.respond(conn, 503, "application/json", std::string("{\"error\":\"command queue unavailable\"}"));
+    }
+}
+
+// Заголовок Content-Type начинается с type (параметры вроде charset не важны)
+static bool hasContentType(const HttpRequest& request, const char* type) {
+    const std::string* value = request.header("content-type");
+    return value && value->compare(0, strlen(type), type) == 0;
+}
+
+// POST /api/channels: все каналы одним запросом (бинарное тело или JSON, libs/channel_command.h),
+// одна команда CRSF_CMD_SET_CHANNELS — главный цикл применяет их на одном тике
+static void handleChannels(HttpServer& server, int conn, const HttpRequest& request) {
+    if (request.method != "POST") {
+        server.respond(conn, 405, "application/json", std::string("{\"error\":\"use POST\"}"), "Allow: POST\r\n");
+        return;
+    }
+    CrsfCommand cmd = {};
+    bool parsed;
+    if (hasContentType(request, "application/octet-stream")) {
+        parsed = channelCommandParseBinary(request.body.data(), request.body.size(), &cmd);
+    } else if (hasContentType(request, "application/json")) {
+        parsed = channelCommandParseJson(request.body.data(), request.body.size(), &cmd);
+    } else {
+        server.respond(conn, 415, "application/json", std::string("{\"error\":\"content type\"}"));
+        return;
+    }
+    int64_t seq = -1;
+    CommandStatus status = parsed ? pushCommand(cmd, &seq) : COMMAND_INVALID;
+    respondCommand(server, conn, status, seq);
+}
+
+// Бинарный пакет (libs/telemetry_wire.h) с последним опубликованным снимком; 0 — crsf_io_rpi не запущен
+static size_t encodeLatestWire(uint8_t* out) {
+    TelemetrySnapshot snap;
+    TelemetryShmMeta meta;
+    if (!openCrsfSegments() || !crsfShm.read(&snap, &meta)) return 0;
+    return telemetryWireEncode(out, snap, meta.publishCount, meta.publishNs, meta.frameType);
+}
+
+// Дескриптор схемы строится один раз: схема задана при сборке
+static const size_t SCHEMA_MAX_SIZE = 8192;
+
+static const char* telemetrySchema(size_t* len) {
+    static char schema[SCHEMA_MAX_SIZE];
+    static size_t schemaLen = telemetrySchemaJson(schema, sizeof(schema));
+    *len = schemaLen;
+    return schema;
+}
+
+// Поток /api/stream (Server-Sent Events): событие на каждый разобранный кадр из истории
+// телеметрии crsf_io_rpi. Первое событие клиента — полный снимок, дальше только изменившиеся
+// поля. Публикации будит eventfd уведомителя в том же epoll, что и HTTP соединения
+struct StreamClient {
+    uint64_t frameTypes[4];     // подписка: бит — тип кадра 0..255
+    TelemetrySnapshot last;     // состояние, которое видел клиент
+    bool sentFull;              // полный снимок отправлен (иначе следующий кадр — целиком)
+    bool degraded;              // отстал: кадры пропускаются до STREAM_RESUME_PENDING
+};
+
+static const size_t STREAM_BATCH = 64;
+// Клиент, не забирающий данные, пропускает кадры, пока буфер не опустеет до RESUME, и затем
+// получает полный снимок — только последнее состояние, без очереди пропущенных кадров
+static const size_t STREAM_MAX_PENDING = 65536;
+static const size_t STREAM_RESUME_PENDING = 16384;
+static const uint64_t STREAM_PING_NS = 15000000000ull;
+
+static std::unordered_map<int, StreamClient> streamClients;
+static TelemetryNotifier streamNotifier;
+static uint64_t streamCursor = 0;
+static std::vector<TelemetryHistoryRecord> streamBatch;
+static char streamEvent[4096];
+static size_t streamEventSize = 0;
+static uint64_t streamDegradedTotal = 0;
+
+// Значение поля снимка в JSON (массив — списком)
+static void writeFieldJson(JsonWriter& json, const TelemetrySnapshot& snap, const TelemetryFieldInfo& field) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&snap) + field.offset;
+    if (field.count > 1) json.beginArray();
+    for (uint16_t i = 0; i < field.count; ++i, p += field.elemSize) {
+        switch (field.type) {
+        case TELEMETRY_U8:  json.uintValue(*p); break;
+        case TELEMETRY_U16: { uint16_t v; memcpy(&v, p, 2); json.uintValue(v); break; }
+        case TELEMETRY_U32: { uint32_t v; memcpy(&v, p, 4); json.uintValue(v); break; }
+        case TELEMETRY_U64: { uint64_t v; memcpy(&v, p, 8); json.uintValue(v); break; }
+        case TELEMETRY_I16: { int16_t v; memcpy(&v, p, 2); json.intValue(v); break; }
+        case TELEMETRY_I32: { int32_t v; memcpy(&v, p, 4); json.intValue(v); break; }
+        case TELEMETRY_F64: { double v; memcpy(&v, p, 8); json.doubleValue(v); break; }
+        }
+    }
+    if (field.count > 1) json.endArray();
+}
+
+// Событие кадра для клиента: поля из mask
+static void buildStreamEvent(const TelemetryHistoryRecord& rec, uint64_t mask) {
+    int n = snprintf(streamEvent, sizeof(streamEvent), "id: %llu\nevent: frame\ndata: ",
+                     static_cast<unsigned long long>(rec.pos));
+    JsonWriter json(streamEvent + n, sizeof(streamEvent) - static_cast<size_t>(n) - 2);
+    json.beginObject();
+    json.key("pos"); json.uintValue(rec.pos);
+    json.key("frameType"); json.uintValue(rec.frameType);
+    json.key("timestampNs"); json.uintValue(rec.timestampNs);
+    json.key("fields");
+    json.beginObject();
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        if (!(mask & (1ull << f))) continue;
+        json.key(TELEMETRY_FIELDS[f].name);
+        writeFieldJson(json, rec.snapshot, TELEMETRY_FIELDS[f]);
+    }
+    json.endObject();
+    json.endObject();
+    streamEventSize = static_cast<size_t>(n) + json.size();
+    streamEvent[streamEventSize++] = '\n';
+    streamEvent[streamEventSize++] = '\n';
+}
+
+// Новые записи истории — подписанным клиентам
+static void onTelemetryPublished(int, void* context) {
+    HttpServer& server = *static_cast<HttpServer*>(context);
+    streamNotifier.drain();
+    static const uint64_t allFields = TELEMETRY_FIELD_COUNT == 64 ? ~0ull : (1ull << TELEMETRY_FIELD_COUNT) - 1;
+
+    for (;;) {
+        size_t n = crsfHistory.read(streamCursor, streamBatch.data(), streamBatch.size(), &streamCursor);
+        for (size_t i = 0; i < n; ++i) {
+            const TelemetryHistoryRecord& rec = streamBatch[i];
+            uint32_t type = rec.frameType & 0xFFu;
+            for (auto& entry : streamClients) {
+                StreamClient& client = entry.second;
+                if (!(client.frameTypes[type >> 6] & (1ull << (type & 63u)))) continue;
+                size_t pending = server.pendingOutput(entry.first);
+                if (!client.degraded && pending > STREAM_MAX_PENDING) {
+                    client.degraded = true;
+                    streamDegradedTotal++;
                 }
+                if (client.degraded) {
+                    if (pending > STREAM_RESUME_PENDING) continue;  // кадр пропущен
+                    client.degraded = false;
+                    client.sentFull = false;  // догнал: дальше — полный снимок
+                }
+                uint64_t mask = client.sentFull ? telemetryDiffFields(client.last, rec.snapshot) : allFields;
+                if (mask == 0) continue;
+                buildStreamEvent(rec, mask);
+                server.sendStream(entry.first, streamEvent, streamEventSize);
+                client.last = rec.snapshot;
+                client.sentFull = true;
             }
         }
+        if (n < streamBatch.size()) break;
     }
 }
 
-// Функция для обработки HTTP запросов
-void handleHttpRequest(int clientSocket, const std::string& request) {
-    std::stringstream ss(request);
-    std::string method, path, version;
-    ss >> method >> path >> version;
+// История /api/telemetry/history: кадры из истории crsf_io_rpi копятся в пирамиде агрегатов
+// (libs/telemetry_pyramid.h), запрос отдаёт min/max/avg готовых корзин подходящего уровня.
+// Пирамида и буферы ответа выделяются при запуске сервера
+static const size_t HISTORY_BATCH = 64;
+static const size_t HISTORY_MAX_POINTS = 1000;
+static const size_t HISTORY_DEFAULT_POINTS = 300;
+static const size_t HISTORY_MAX_COLUMNS = 32;
+
+struct HistoryState {
+    TelemetryPyramid pyramid{TELEMETRY_PYRAMID_BASE_MS * 1000000ull, TELEMETRY_PYRAMID_FACTOR,
+                             TELEMETRY_PYRAMID_LEVELS, TELEMETRY_PYRAMID_CAPACITY};
+    bool started = false;
+    uint64_t cursor = 0;
+    TelemetryHistoryRecord batch[HISTORY_BATCH];
+    uint16_t columns[HISTORY_MAX_COLUMNS];
+    uint64_t times[HISTORY_MAX_POINTS];
+    uint32_t counts[HISTORY_MAX_POINTS];
+    TelemetryPyramidStats stats[HISTORY_MAX_POINTS * HISTORY_MAX_COLUMNS];
+    char json[1 << 20];
+};
+static std::unique_ptr<HistoryState> history;
+
+// Перенести новые кадры истории crsf_io_rpi в пирамиду (вызывается из цикла сервера)
+static void ingestHistory() {
+    if (!history || !openCrsfSegments()) return;
+    if (!history->started) {
+        history->cursor = crsfHistory.tail();  // всё, что ещё хранит кольцо
+        history->started = true;
+    }
+    size_t n;
+    do {
+        n = crsfHistory.read(history->cursor, history->batch, HISTORY_BATCH, &history->cursor);
+        for (size_t i = 0; i < n; ++i) {
+            history->pyramid.add(history->batch[i].timestampNs, history->batch[i].snapshot);
+        }
+    } while (n == HISTORY_BATCH);
+}
+
+// Значение параметра строки запроса с декодированием %XX; false — параметра нет
+static bool queryParam(const std::string& query, const char* name, std::string* value) {
+    size_t nameLen = strlen(name);
+    size_t pos = 0;
+    while (pos < query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        if (end - pos > nameLen && query.compare(pos, nameLen, name) == 0 && query[pos + nameLen] == '=') {
+            value->clear();
+            for (size_t i = pos + nameLen + 1; i < end; ++i) {
+                char c = query[i];
+                if (c == '%' && i + 2 < end && isxdigit(static_cast<unsigned char>(query[i + 1])) &&
+                    isxdigit(static_cast<unsigned char>(query[i + 2]))) {
+                    char hex[3] = {query[i + 1], query[i + 2], '\0'};
+                    c = static_cast<char>(strtol(hex, nullptr, 16));
+                    i += 2;
+                }
+                value->push_back(c);
+            }
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+// GET /api/telemetry/history?since=&fields=&max_points=
+//   since — время кадра в нс (timestampNs, как в /api/stream), отрицательное — секунд назад
+//   fields — поля через запятую ("voltage,channels[2]"; поле-массив — все элементы)
+//   max_points — не больше точек (по умолчанию HISTORY_DEFAULT_POINTS)
+static void handleHistory(HttpServer& server, int conn, const HttpRequest& request) {
+    if (!history) {
+        server.respond(conn, 503, "application/json", std::string("{\"error\":\"history unavailable\"}"));
+        return;
+    }
+    ingestHistory();
+    TelemetryPyramid& pyramid = history->pyramid;
+    
+    std::string value;
+    uint64_t sinceNs = 0;
+    if (queryParam(request.query, "since", &value)) {
+        char* end = nullptr;
+        long long since = strtoll(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0') {
+            server.respond(conn, 400, "application/json", std::string("{\"error\":\"since\"}"));
+            return;
+        }
+        if (since >= 0) {
+            sinceNs = static_cast<uint64_t>(since);
+        } else {
+            // Секунды назад без переполнения: отрицание в беззнаковых (верно и для LLONG_MIN),
+            // глубже начала отсчёта rpi_nanos() — вся история
+            uint64_t backSec = 0ull - static_cast<uint64_t>(since);
+            uint64_t now = rpi_nanos();
+            sinceNs = backSec <= now / 1000000000ull ? now - backSec * 1000000000ull : 0;
+        }
+    }
+    size_t maxPoints = HISTORY_DEFAULT_POINTS;
+    if (queryParam(request.query, "max_points", &value)) {
+        long points = 0;
+        if (!parseInt(value, 1, static_cast<long>(HISTORY_MAX_POINTS), &points)) {
+            server.respond(conn, 400, "application/json", std::string("{\"error\":\"max_points\"}"));
+            return;
+        }
+        maxPoints = static_cast<size_t>(points);
+    }
+    size_t ncolumns = 0;
+    if (!queryParam(request.query, "fields", &value) || value.empty()) {
+        server.respond(conn, 400, "application/json", std::string("{\"error\":\"fields\"}"));
+        return;
+    }
+    for (size_t pos = 0; pos <= value.size();) {
+        size_t end = value.find(',', pos);
+        if (end == std::string::npos) end = value.size();
+        size_t found = pyramid.findColumns(value.c_str() + pos, end - pos, history->columns + ncolumns,
+                                           HISTORY_MAX_COLUMNS - ncolumns);
+        if (found == 0 || ncolumns + found > HISTORY_MAX_COLUMNS) {
+            server.respond(conn, 400, "application/json", std::string("{\"error\":\"fields\"}"));
+            return;
+        }
+        ncolumns += found;
+        pos = end + 1;
+    }
+    
+    uint64_t resolutionNs = 0;
+    size_t points = pyramid.query(sinceNs, maxPoints, history->columns, ncolumns, history->times,
+                                  history->counts, history->stats, &resolutionNs);
+    
+    JsonWriter json(history->json, sizeof(history->json));
+    json.beginObject();
+    json.key("resolutionNs"); json.uintValue(resolutionNs);
+    json.key("firstNs"); json.uintValue(pyramid.firstNs());
+    json.key("lastNs"); json.uintValue(pyramid.lastNs());
+    json.key("points"); json.uintValue(points);
+    json.key("t");
+    json.beginArray();
+    for (size_t p = 0; p < points; ++p) json.uintValue(history->times[p]);
+    json.endArray();
+    json.key("count");
+    json.beginArray();
+    for (size_t p = 0; p < points; ++p) json.uintValue(history->counts[p]);
+    json.endArray();
+    json.key("fields");
+    json.beginObject();
+    for (size_t c = 0; c < ncolumns; ++c) {
+        json.key(pyramid.columnName(history->columns[c]));
+        json.beginObject();
+        json.key("min");
+        json.beginArray();
+        for (size_t p = 0; p < points; ++p) json.floatValue(history->stats[p * ncolumns + c].min);
+        json.endArray();
+        json.key("max");
+        json.beginArray();
+        for (size_t p = 0; p < points; ++p) json.floatValue(history->stats[p * ncolumns + c].max);
+        json.endArray();
+        json.key("avg");
+        json.beginArray();
+        for (size_t p = 0; p < points; ++p) json.floatValue(history->stats[p * ncolumns + c].avg);
+        json.endArray();
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+    
+    if (!json.ok()) {
+        server.respond(conn, 413, "application/json", std::string("{\"error\":\"reduce max_points or fields\"}"));
+        return;
+    }
+    server.respond(conn, 200, "application/json", json.data(), json.size());
+}
+
+// Метрики стека CRSF (сегмент CRSF_METRICS_SHM_NAME) и самого сервера в формате Prometheus
+static TelemetryShm crsfMetricsShm;
+static char metricsText[65536];
+
+static void writeLatencyHistogram(PrometheusWriter& out, const char* name, const char* labels,
+                                  const CrsfMetricsHistogram& h) {
+    double bounds[CRSF_METRICS_BUCKETS];
+    for (unsigned i = 0; i < CRSF_METRICS_BUCKETS; ++i) bounds[i] = CRSF_METRICS_BOUNDS_US[i] / 1e6;
+    out.histogram(name, labels, bounds, h.cumulative, CRSF_METRICS_BUCKETS, h.count, h.sumNs / 1e9);
+}
+
+static size_t formatMetrics(const HttpServer& server) {
+    PrometheusWriter out(metricsText, sizeof(metricsText));
+    
+    if (!crsfMetricsShm.isOpen()) {
+        crsfMetricsShm.open(CRSF_METRICS_SHM_NAME, sizeof(CrsfMetrics), CRSF_METRICS_VERSION);
+    }
+    static CrsfMetrics m;
+    bool up = crsfMetricsShm.isOpen() && crsfMetricsShm.read(&m);
+    out.family("crsf_up", "gauge", "Metrics of crsf_io_rpi are available");
+    out.sample("crsf_up", nullptr, up ? 1u : 0u);
+    
+    if (up) {
+        out.family("crsf_rx_bytes_total", "counter", "Bytes received from the CRSF UART");
+        out.sample("crsf_rx_bytes_total", nullptr, m.rxBytes);
+        out.family("crsf_rx_frames_total", "counter", "CRSF frames with a valid CRC by frame type");
+        for (unsigned t = 0; t < 256; ++t) {
+            if (m.framesByType[t] == 0) continue;
+            char label[16];
+            snprintf(label, sizeof(label), "type=\"0x%02X\"", t);
+            out.sample("crsf_rx_frames_total", label, m.framesByType[t]);
+        }
+        out.family("crsf_rx_crc_errors_total", "counter", "CRSF frames dropped because of a CRC mismatch");
+        out.sample("crsf_rx_crc_errors_total", nullptr, m.crcErrors);
+        out.family("crsf_rx_resyncs_total", "counter", "Parser shifts while searching for a frame start");
+        out.sample("crsf_rx_resyncs_total", nullptr, m.resyncs);
+        
+        out.family("crsf_tx_queue_bytes", "gauge", "Bytes waiting in the UART driver output queue (-1 unknown)");
+        out.sampleInt("crsf_tx_queue_bytes", nullptr, m.txQueueBytes);
+        out.family("crsf_command_queue_depth", "gauge", "Commands waiting in the shared memory command ring");
+        out.sample("crsf_command_queue_depth", nullptr, m.commandQueueDepth);
+        out.family("crsf_commands_applied_total", "counter", "Commands applied by the CRSF loop");
+        out.sample("crsf_commands_applied_total", nullptr, m.commandsApplied);
+        out.family("crsf_commands_rejected_total", "counter", "Commands rejected because the ring was full");
+        out.sample("crsf_commands_rejected_total", nullptr, m.commandsRejected);
+        
+        out.family("crsf_rc_period_seconds", "gauge", "Configured RC frame period");
+        out.sampleDouble("crsf_rc_period_seconds", nullptr, m.rcPeriodUs / 1e6);
+        out.family("crsf_rc_ticks_total", "counter", "RC scheduler ticks");
+        out.sample("crsf_rc_ticks_total", nullptr, m.rcTicks);
+        out.family("crsf_rc_overruns_total", "counter", "RC scheduler ticks that missed the next deadline");
+        out.sample("crsf_rc_overruns_total", nullptr, m.rcOverruns);
+        out.family("crsf_rc_jitter_seconds", "histogram", "Lateness of RC scheduler ticks");
+        writeLatencyHistogram(out, "crsf_rc_jitter_seconds", nullptr, m.rcJitter);
+        
+        out.family("crsf_command_latency_seconds", "histogram", "Command to UART write latency by stage");
+        writeLatencyHistogram(out, "crsf_command_latency_seconds", "stage=\"ipc\"", m.latIpc);
+        writeLatencyHistogram(out, "crsf_command_latency_seconds", "stage=\"queue\"", m.latQueue);
+        writeLatencyHistogram(out, "crsf_command_latency_seconds", "stage=\"write\"", m.latWrite);
+        writeLatencyHistogram(out, "crsf_command_latency_seconds", "stage=\"total\"", m.latTotal);
+    }
+    
+    out.family("telemetry_server_connections", "gauge", "Open HTTP connections");
+    out.sample("telemetry_server_connections", nullptr, server.connectionCount());
+    out.family("telemetry_server_stream_clients", "gauge", "Subscribers of /api/stream");
+    out.sample("telemetry_server_stream_clients", nullptr, streamClients.size());
+    out.family("telemetry_server_stream_degraded_total", "counter",
+               "Stream subscribers switched to latest-value mode because they fell behind");
+    out.sample("telemetry_server_stream_degraded_total", nullptr, streamDegradedTotal);
+    out.family("telemetry_server_slow_clients_closed_total", "counter",
+               "Connections closed because the client did not read responses");
+    out.sample("telemetry_server_slow_clients_closed_total", nullptr, server.slowClientsClosed());
+    out.family("telemetry_server_rate_limited_total", "counter", "Requests rejected with 429");
+    out.sample("telemetry_server_rate_limited_total", nullptr, server.requestsRateLimited());
+    return out.size();
+}
+
+// UDP: датаграмма "schema" — дескриптор схемы, любая другая — последний бинарный пакет.
+// Ответ уходит отправителю запроса, только если он не длиннее запроса (адрес отправителя
+// UDP не проверен — без этого порт усиливал бы трафик): клиент дополняет запрос нулями до
+// TELEMETRY_WIRE_SIZE или, для схемы, до SCHEMA_MAX_SIZE. Без crsf_io_rpi снимок не отправляется
+static void onUdpRequest(int fd, void*) {
+    static uint8_t request[SCHEMA_MAX_SIZE];
+    uint8_t packet[TELEMETRY_WIRE_SIZE];
+    for (;;) {
+        struct sockaddr_storage from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(fd, request, sizeof(request), 0, reinterpret_cast<struct sockaddr*>(&from), &fromLen);
+        if (n < 0) return;  // EAGAIN — очередь пуста
+        const void* reply = packet;
+        size_t replyLen;
+        if (n >= 6 && memcmp(request, "schema", 6) == 0) {
+            reply = telemetrySchema(&replyLen);
+        } else {
+            replyLen = encodeLatestWire(packet);
+        }
+        if (replyLen > 0 && replyLen <= static_cast<size_t>(n)) {
+            sendto(fd, reply, replyLen, MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&from), fromLen);
+        }
+    }
+}
+
+static int openUdpSocket(const char* bindAddress, int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bindAddress, &addr.sin_addr) != 1) return -1;
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void onConnectionClosed(HttpServer&, int conn, void*) {
+    streamClients.erase(conn);
+}
+
+// Открыть сегменты crsf_io_rpi и подключить уведомитель к циклу сервера (один раз)
+static bool openStreamSources(HttpServer& server) {
+    if (streamNotifier.isRunning()) return true;
+    if (!openCrsfSegments()) return false;
+    if (!streamNotifier.start(crsfShm)) return false;
+    if (!server.watchFd(streamNotifier.fd(), &onTelemetryPublished)) {
+        streamNotifier.stop();
+        return false;
+    }
+    streamBatch.resize(STREAM_BATCH);
+    streamCursor = crsfHistory.head();
+    return true;
+}
+
+// types=0x08,0x1E — типы кадров (пусто — все). false — ошибка в списке
+static bool parseStreamTypes(const std::string& query, uint64_t frameTypes[4]) {
+    size_t pos = query.find("types=");
+    while (pos != std::string::npos && pos > 0 && query[pos - 1] != '&') pos = query.find("types=", pos + 1);
+    if (pos == std::string::npos || pos + 6 >= query.size() || query[pos + 6] == '&') {
+        for (int i = 0; i < 4; ++i) frameTypes[i] = ~0ull;
+        return true;
+    }
+    for (int i = 0; i < 4; ++i) frameTypes[i] = 0;
+    const char* p = query.c_str() + pos + 6;
+    for (;;) {
+        char* end = nullptr;
+        long type = strtol(p, &end, 0);
+        if (end == p || type < 0 || type > 255) return false;
+        frameTypes[type >> 6] |= 1ull << (type & 63);
+        if (*end == ',') {
+            p = end + 1;
+        } else if (strncmp(end, "%2C", 3) == 0 || strncmp(end, "%2c", 3) == 0) {
+            p = end + 3;
+        } else {
+            return *end == '\0' || *end == '&';
+        }
+    }
+}
+
+// Обработчик HTTP запросов (вызывается из цикла HttpServer, ответ — до возврата)
+static void handleHttpRequest(HttpServer& server, int conn, const HttpRequest& request, void*) {
+    const std::string& path = request.path;
     
     if (path == "/" || path == "/index.html") {
         // Простая информационная страница
-        std::string html = R"(<!DOCTYPE html>
+        static const std::string html = R"(<!DOCTYPE html>
 <html><head><title>CRSF API</title></head>
 <body>
 <h1>CRSF Телеметрия API</h1>
@@ -250,106 +728,145 @@ void handleHttpRequest(int clientSocket, const std::string& request) {
 <ul>
 <li><a href="/api/telemetry">/api/telemetry</a> - JSON данные телеметрии</li>
 <li><a href="/api/command">/api/command</a> - Команды управления</li>
+<li>POST /api/channels - Все каналы одним запросом (JSON или 16 x uint16 LE)</li>
+<li><a href="/api/telemetry.bin">/api/telemetry.bin</a> - Бинарный снимок (заголовок + TelemetrySnapshot)</li>
+<li><a href="/api/telemetry/history?since=-60&fields=voltage,current">/api/telemetry/history</a> - История полей: min/max/avg (?since=&fields=&max_points=)</li>
+<li><a href="/api/telemetry/schema">/api/telemetry/schema</a> - Дескриптор схемы бинарного снимка</li>
+<li><a href="/metrics">/metrics</a> - Метрики стека CRSF (Prometheus)</li>
+<li><a href="/api/stream">/api/stream</a> - Поток кадров (Server-Sent Events, ?types=0x08,0x1E)</li>
 </ul>
 </body></html>)";
-        sendHttpResponse(clientSocket, html);
+        server.respond(conn, 200, "text/html", html);
     } else if (path == "/api/telemetry") {
-        // API для получения телеметрии
-        std::string json = createTelemetryJson();
-        sendHttpResponse(clientSocket, json, "application/json");
-    } else if (path.find("/api/command") == 0) {
-        // API для команд управления
-        size_t pos = path.find("?");
-        if (pos != std::string::npos) {
-            std::string query = path.substr(pos + 1);
-            size_t cmdPos = query.find("cmd=");
-            size_t valPos = query.find("&value=");
-            
-            if (cmdPos != std::string::npos && valPos != std::string::npos) {
-                std::string command = query.substr(cmdPos + 4, valPos - cmdPos - 4);
-                std::string value = query.substr(valPos + 7);
-                handleCommand(command, value);
-            }
+        // API для получения телеметрии: сериализация одна на версию данных
+        refreshTelemetryJson();
+        if (telemetryNotModified(request)) {
+            server.respond(conn, 304, "application/json", "", 0, telemetryHeaders);
+        } else {
+            server.respond(conn, 200, "application/json", telemetryJson, telemetryJsonSize, telemetryHeaders);
         }
+    } else if (path == "/api/telemetry.bin") {
+        // Бинарный снимок для машинных клиентов: без сериализации, номер публикации в заголовке
+        uint8_t packet[TELEMETRY_WIRE_SIZE];
+        size_t len = encodeLatestWire(packet);
+        if (len == 0) {
+            server.respond(conn, 503, "application/json", std::string("{\"error\":\"telemetry unavailable\"}"));
+        } else {
+            server.respond(conn, 200, "application/octet-stream", reinterpret_cast<const char*>(packet), len);
+        }
+    } else if (path == "/api/telemetry/history") {
+        handleHistory(server, conn, request);
+    } else if (path == "/api/telemetry/schema") {
+        size_t len = 0;
+        const char* schema = telemetrySchema(&len);
+        server.respond(conn, 200, "application/json", schema, len);
+    } else if (path == "/metrics") {
+        size_t len = formatMetrics(server);
+        server.respond(conn, 200, "text/plain; version=0.0.4; charset=utf-8", metricsText, len);
+    } else if (path == "/api/stream") {
+        StreamClient client = {};
+        if (!parseStreamTypes(request.query, client.frameTypes)) {
+            server.respond(conn, 400, "application/json", std::string("{\"error\":\"types\"}"));
+        } else if (!openStreamSources(server)) {
+            server.respond(conn, 503, "application/json", std::string("{\"error\":\"telemetry unavailable\"}"));
+        } else {
+            server.beginStream(conn, "text/event-stream");
+            server.sendStream(conn, "retry: 1000\n\n", 13);
+            streamClients[conn] = client;
+        }
+    } else if (path == "/api/command") {
+        // API для команд управления
+        const std::string& query = request.query;
+        size_t cmdPos = query.find("cmd=");
+        size_t valPos = query.find("&value=");
         
-        sendHttpResponse(clientSocket, "{\"status\":\"ok\"}", "application/json");
+        CommandStatus status = COMMAND_INVALID;
+        int64_t seq = -1;
+        if (cmdPos != std::string::npos && valPos != std::string::npos) {
+            std::string command = query.substr(cmdPos + 4, valPos - cmdPos - 4);
+            std::string value = query.substr(valPos + 7);
+            status = handleCommand(command, value, &seq);
+        }
+        respondCommand(server, conn, status, seq);
+    } else if (path == "/api/channels") {
+        handleChannels(server, conn, request);
     } else {
-        // 404 Not Found
-        std::string response = "HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\n\r\n<h1>404 Not Found</h1>";
-        send(clientSocket, response.c_str(), response.length(), 0);
+        server.respond(conn, 404, "text/html", "<h1>404 Not Found</h1>", 22);
     }
 }
 
-// Функция для обработки клиентских подключений
-void handleClient(int clientSocket) {
-    char buffer[4096];
-    int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytesReceived > 0) {
-        buffer[bytesReceived] = '\0';
-        std::string request(buffer);
-        handleHttpRequest(clientSocket, request);
+// Сервер работает на своём потоке: один цикл epoll, keep-alive.
+// Телеметрия обновляется в том же цикле между ожиданиями событий
+static HttpServer httpServer;
+static std::thread serverThread;
+static std::atomic<bool> serverStop(false);
+static int udpSocket = -1;
+
+static void serverLoop(int updateIntervalMs) {
+    uint64_t intervalNs = static_cast<uint64_t>(updateIntervalMs) * 1000000ull;
+    uint64_t nextUpdateNs = rpi_nanos();
+    uint64_t nextPingNs = nextUpdateNs + STREAM_PING_NS;
+    while (!serverStop.load(std::memory_order_relaxed)) {
+        uint64_t now = rpi_nanos();
+        if (now >= nextUpdateNs) {
+            updateTelemetry();
+            ingestHistory();
+            nextUpdateNs = now + intervalNs;
+        }
+        if (now >= nextPingNs) {
+            // Комментарий SSE держит соединение живым через прокси без кадров от полётника
+            for (auto& entry : streamClients) httpServer.sendStream(entry.first, ": ping\n\n", 8);
+            nextPingNs = now + STREAM_PING_NS;
+        }
+        int waitMs = static_cast<int>((nextUpdateNs - now + 999999ull) / 1000000ull);
+        httpServer.poll(waitMs);
     }
-    
-    close(clientSocket);
 }
 
-// Основная функция веб-сервера
-void startTelemetryServer(CrsfSerial* crsf, int port = 8080, int updateIntervalMs = 10) {
+bool startTelemetryServer(int port, int updateIntervalMs, const char* bindAddress) {
+    if (serverThread.joinable()) return false;
     std::cout << "🌐 Запуск веб-сервера телеметрии (реалтайм " << updateIntervalMs << "мс)..." << std::endl;
-    crsfInstance = crsf;
+    serverEpochNs = rpi_nanos();
+    history.reset(new HistoryState());
     
-    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
-        std::cerr << "Ошибка создания сокета" << std::endl;
-        return;
-    }
-    
-    int opt = 1;
-    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
-    struct sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-    
-    if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        std::cerr << "❌ Ошибка привязки к порту " << port << std::endl;
-        close(serverSocket);
-        return;
+    if (!httpServer.start(port, &handleHttpRequest, &httpServer, TELEMETRY_SERVER_MAX_CONNECTIONS, bindAddress)) {
+        std::cerr << "❌ Ошибка запуска веб-сервера на " << bindAddress << ":" << port << std::endl;
+        return false;
     }
     
-    if (listen(serverSocket, 5) < 0) {
-        std::cerr << "❌ Ошибка прослушивания порта" << std::endl;
-        close(serverSocket);
-        return;
+    std::cout << "🌐 Веб-сервер телеметрии запущен на " << bindAddress << ":" << port << std::endl;
+    httpServer.setCloseHandler(&onConnectionClosed);
+    httpServer.setRateLimit(TELEMETRY_SERVER_RATE_LIMIT, TELEMETRY_SERVER_RATE_BURST);
+    httpServer.setMaxOutput(TELEMETRY_SERVER_MAX_OUTPUT);
+    httpServer.setWriteTimeoutMs(TELEMETRY_SERVER_WRITE_TIMEOUT_MS);
+    
+    if (TELEMETRY_UDP_PORT > 0) {
+        udpSocket = openUdpSocket(bindAddress, TELEMETRY_UDP_PORT);
+        if (udpSocket >= 0 && httpServer.watchFd(udpSocket, &onUdpRequest)) {
+            std::cout << "📡 Бинарная телеметрия по UDP на " << bindAddress << ":"
+                      << TELEMETRY_UDP_PORT << std::endl;
+        } else {
+            std::cerr << "❌ UDP порт " << TELEMETRY_UDP_PORT << " недоступен" << std::endl;
+        }
     }
     
-    std::cout << "🌐 Веб-сервер телеметрии запущен на порту " << port << std::endl;
-    std::cout << "📱 Откройте браузер: http://localhost:" << port << std::endl;
-    
-    // Запускаем поток для обновления телеметрии (реалтайм)
-    std::thread telemetryThread([updateIntervalMs]() {
-        while (true) {
-            updateTelemetry();
-            std::this_thread::sleep_for(std::chrono::milliseconds(updateIntervalMs));
-        }
-    });
-    telemetryThread.detach();
+    std::cout << "📱 Откройте браузер: http://localhost:" << httpServer.port() << std::endl;
     
-    // Основной цикл сервера
-    while (true) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket < 0) {
-            continue;
-        }
-        
-        std::thread clientThread(handleClient, clientSocket);
-        clientThread.detach();
+    serverStop.store(false);
+    serverThread = std::thread(serverLoop, updateIntervalMs);
+    return true;
+}
+
+void stopTelemetryServer() {
+    if (!serverThread.joinable()) return;
+    serverStop.store(true);
+    serverThread.join();
+    streamNotifier.stop();
+    streamClients.clear();
+    httpServer.stop();
+    history.reset();
+    if (udpSocket >= 0) {
+        close(udpSocket);
+        udpSocket = -1;
     }
-    
-    close(serverSocket);
 }
@@ -1,13 +1,17 @@
 #ifndef TELEMETRY_SERVER_H
 #define TELEMETRY_SERVER_H
 
-#include "libs/crsf/CrsfSerial.h"
-#include <string>
+// Веб-сервер телеметрии — необязательная подсистема crsf_io_rpi (--http-port).
+// Работает на своём потоке с обычным приоритетом и не обращается к CrsfSerial: данные читает
+// только из сегментов разделяемой памяти без блокировок (снимок, история, метрики), команды
+// ставит в кольцо команд. Поэтому медленный клиент или ошибка запроса не задерживают
+// и не портят главный цикл RX/TX
 
-// Запуск веб-сервера телеметрии
-void startTelemetryServer(CrsfSerial* crsf, int port = 8080, int updateIntervalMs = 50);
-
-// Получить текущий режим работы
-std::string getWorkMode();
+// Запустить веб-сервер на порту port адреса bindAddress (IPv4, по умолчанию только loopback),
+// телеметрия обновляется раз в updateIntervalMs. UDP-сокет TELEMETRY_UDP_PORT — на том же адресе.
+// false — адрес или порт недоступен, или сервер уже запущен
+bool startTelemetryServer(int port = 8080, int updateIntervalMs = 50, const char* bindAddress = "127.0.0.1");
+// Остановить поток сервера и закрыть соединения
+void stopTelemetryServer();
 
 #endif // TELEMETRY_SERVER_H
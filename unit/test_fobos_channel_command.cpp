@@ -0,0 +1,117 @@
+/**
+ * @file test_fobos_channel_command.cpp
+ * @brief Unit тесты для разбора пакетной установки каналов (POST /api/channels)
+ *
+ * Тесты проверяют:
+ * - Бинарное тело: значения uint16 little-endian, 0 — канал не меняется
+ * - JSON: массив каналов с null, пробелы
+ * - Отказ всего запроса при любой ошибке формата или значения
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include "../libs/channel_command.h"
+
+/**
+ * @test Бинарное тело: 16 каналов одной командой, нули пропускаются
+ */
+TEST(ChannelCommandTest, ParseBinary_AllChannels_SingleCommand) {
+    // Arrange
+    uint8_t body[32];
+    for (int i = 0; i < 16; ++i) {
+        uint16_t value = static_cast<uint16_t>(1000 + i * 50);
+        if (i == 5) value = 0;
+        body[2 * i] = static_cast<uint8_t>(value & 0xFF);
+        body[2 * i + 1] = static_cast<uint8_t>(value >> 8);
+    }
+    CrsfCommand cmd = {};
+
+    // Act
+    bool ok = channelCommandParseBinary(body, sizeof(body), &cmd);
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(cmd.type, CRSF_CMD_SET_CHANNELS);
+    EXPECT_EQ(cmd.mask, 0xFFDFu);
+    EXPECT_EQ(cmd.values[0], 1000);
+    EXPECT_EQ(cmd.values[5], 0);
+    EXPECT_EQ(cmd.values[15], 1750);
+
+    // Первые каналы: короткое тело
+    EXPECT_TRUE(channelCommandParseBinary(body, 4, &cmd));
+    EXPECT_EQ(cmd.mask, 0x0003u);
+}
+
+/**
+ * @test Бинарное тело: нечётная или слишком большая длина, значение вне диапазона, все нули
+ */
+TEST(ChannelCommandTest, ParseBinary_Invalid_Rejected) {
+    uint8_t body[34] = {};
+    CrsfCommand cmd = {};
+    cmd.type = 0xAA;
+
+    EXPECT_FALSE(channelCommandParseBinary(body, 0, &cmd));
+    EXPECT_FALSE(channelCommandParseBinary(body, 3, &cmd));
+    EXPECT_FALSE(channelCommandParseBinary(body, 34, &cmd));
+    EXPECT_FALSE(channelCommandParseBinary(body, 32, &cmd));  // ни одного канала
+
+    body[0] = 0xD0;  // 2000
+    body[1] = 0x07;
+    body[2] = 0xD1;  // 2001
+    body[3] = 0x07;
+    EXPECT_FALSE(channelCommandParseBinary(body, 4, &cmd));
+    EXPECT_EQ(cmd.type, 0xAA);  // при отказе команда не меняется
+    EXPECT_TRUE(channelCommandParseBinary(body, 2, &cmd));
+}
+
+/**
+ * @test JSON: значения и null по позициям каналов, пробелы между лексемами
+ */
+TEST(ChannelCommandTest, ParseJson_ChannelsArray) {
+    const std::string body = " {\"channels\": [1500, null,1000 ,\n2000]} ";
+    CrsfCommand cmd = {};
+
+    ASSERT_TRUE(channelCommandParseJson(body.data(), body.size(), &cmd));
+    EXPECT_EQ(cmd.type, CRSF_CMD_SET_CHANNELS);
+    EXPECT_EQ(cmd.mask, 0x000Du);
+    EXPECT_EQ(cmd.values[0], 1500);
+    EXPECT_EQ(cmd.values[2], 1000);
+    EXPECT_EQ(cmd.values[3], 2000);
+
+    std::string full = "{\"channels\":[";
+    for (int i = 0; i < 16; ++i) full += (i ? ",1500" : "1500");
+    full += "]}";
+    ASSERT_TRUE(channelCommandParseJson(full.data(), full.size(), &cmd));
+    EXPECT_EQ(cmd.mask, 0xFFFFu);
+}
+
+/**
+ * @test JSON: любая ошибка формата или значения отклоняет весь запрос
+ */
+TEST(ChannelCommandTest, ParseJson_Invalid_Rejected) {
+    const char* bodies[] = {
+        "",
+        "[1500]",
+        "{\"channel\":[1500]}",
+        "{\"channels\":[1500}",
+        "{\"channels\":[1500,]}",
+        "{\"channels\":[999]}",
+        "{\"channels\":[2001]}",
+        "{\"channels\":[-1500]}",
+        "{\"channels\":[1500.5]}",
+        "{\"channels\":[01500]}",
+        "{\"channels\":[\"1500\"]}",
+        "{\"channels\":[null,null]}",
+        "{\"channels\":[]}",
+        "{\"channels\":[1500]} x",
+        "{\"channels\":[1500],\"send\":true}",
+        "{\"channels\":[1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500,1500]}",
+    };
+    for (const char* body : bodies) {
+        CrsfCommand cmd = {};
+        EXPECT_FALSE(channelCommandParseJson(body, strlen(body), &cmd)) << body;
+    }
+}
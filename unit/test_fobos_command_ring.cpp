@@ -0,0 +1,222 @@
+/**
+ * @file test_fobos_command_ring.cpp
+ * @brief Unit тесты для кольца команд в разделяемой памяти
+ *
+ * Тесты проверяют:
+ * - Порядок FIFO и номера команд
+ * - Отказ писателю при полном кольце
+ * - Номер последней выполненной команды
+ * - Сброс команд прошлого запуска при повторном создании
+ * - Несколько писателей одновременно с одним читателем
+ * - Права сегмента: только владелец, даже если сегмент остался открытым для всех
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../libs/command_ring.h"
+
+/**
+ * @class CommandRingTest
+ * @brief Фикстура: читатель создаёт кольцо, писатель открывает его по имени
+ */
+class CommandRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name = "/crsf_commands_test_" + std::to_string(getpid());
+        CommandRing::unlink(name.c_str());
+    }
+
+    void TearDown() override {
+        CommandRing::unlink(name.c_str());
+    }
+
+    static CrsfCommand setChannel(uint8_t ch, int32_t value) {
+        CrsfCommand cmd = {};
+        cmd.type = CRSF_CMD_SET_CHANNEL;
+        cmd.channel = ch;
+        cmd.value = value;
+        return cmd;
+    }
+
+    std::string name;
+};
+
+/**
+ * @test Команды выходят в порядке постановки с возрастающими номерами
+ */
+TEST_F(CommandRingTest, PushPop_Fifo_AssignsSequence) {
+    // Arrange
+    CommandRing reader;
+    CommandRing writer;
+    ASSERT_TRUE(reader.create(name.c_str(), 8));
+    ASSERT_TRUE(writer.open(name.c_str()));
+    EXPECT_EQ(writer.capacity(), 8u);
+
+    // Act
+    EXPECT_EQ(writer.push(setChannel(1, 1100)), 0);
+    EXPECT_EQ(writer.push(setChannel(2, 1200)), 1);
+    EXPECT_EQ(writer.depth(), 2u);
+
+    // Assert
+    CrsfCommand cmd;
+    ASSERT_TRUE(reader.pop(cmd));
+    EXPECT_EQ(cmd.channel, 1);
+    EXPECT_EQ(cmd.value, 1100);
+    EXPECT_EQ(cmd.seq, 0u);
+    ASSERT_TRUE(reader.pop(cmd));
+    EXPECT_EQ(cmd.channel, 2);
+    EXPECT_EQ(cmd.seq, 1u);
+    EXPECT_FALSE(reader.pop(cmd));
+    EXPECT_EQ(reader.depth(), 0u);
+}
+
+/**
+ * @test Полное кольцо отказывает писателю, после чтения место освобождается
+ */
+TEST_F(CommandRingTest, Push_FullRing_RejectedUntilDrained) {
+    CommandRing reader;
+    ASSERT_TRUE(reader.create(name.c_str(), 4));
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_GE(reader.push(setChannel(1, 1000 + i)), 0);
+    }
+    EXPECT_EQ(reader.push(setChannel(1, 1999)), -1);
+    EXPECT_EQ(reader.rejected(), 1u);
+
+    CrsfCommand cmd;
+    ASSERT_TRUE(reader.pop(cmd));
+    EXPECT_EQ(cmd.value, 1000);
+    EXPECT_EQ(reader.push(setChannel(1, 1999)), 4);
+}
+
+/**
+ * @test Номер выполненной команды виден писателю
+ */
+TEST_F(CommandRingTest, MarkApplied_VisibleToWriter) {
+    CommandRing reader;
+    CommandRing writer;
+    ASSERT_TRUE(reader.create(name.c_str(), 8));
+    ASSERT_TRUE(writer.open(name.c_str()));
+
+    int64_t seq = writer.push(setChannel(3, 1500));
+    ASSERT_GE(seq, 0);
+    EXPECT_LE(writer.appliedSeq(), static_cast<uint64_t>(seq));
+
+    CrsfCommand cmd;
+    ASSERT_TRUE(reader.pop(cmd));
+    reader.markApplied(cmd.seq);
+
+    EXPECT_GT(writer.appliedSeq(), static_cast<uint64_t>(seq));
+}
+
+/**
+ * @test Ёмкость не степень двойки и несуществующее кольцо
+ */
+TEST_F(CommandRingTest, CreateOpen_InvalidArguments_Fail) {
+    CommandRing ring;
+    EXPECT_FALSE(ring.create(name.c_str(), 6));
+    EXPECT_FALSE(ring.open(name.c_str()));
+    EXPECT_EQ(ring.push(setChannel(1, 1500)), -1);
+}
+
+/**
+ * @test Сегмент доступен только владельцу; неизвестная группа писателей — отказ
+ */
+TEST_F(CommandRingTest, Create_OwnerOnlyPermissions) {
+    // Сегмент прошлой версии с правами 0666
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+    ASSERT_GE(fd, 0);
+    fchmod(fd, 0666);
+    close(fd);
+
+    CommandRing ring;
+    ASSERT_TRUE(ring.create(name.c_str(), 8));
+    struct stat st;
+    fd = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(fstat(fd, &st), 0);
+    close(fd);
+    EXPECT_EQ(st.st_mode & 0777, 0600u);
+
+    CommandRing other;
+    EXPECT_FALSE(other.create(name.c_str(), 8, "crsf_no_such_group_test"));
+}
+
+/**
+ * @test Повторное создание отбрасывает команды прошлого запуска
+ *
+ * Номера команд продолжаются, чтобы писатель не спутал старый appliedSeq с новым.
+ */
+TEST_F(CommandRingTest, Create_ExistingRing_DropsPendingKeepsNumbering) {
+    CommandRing writer;
+    {
+        CommandRing reader;
+        ASSERT_TRUE(reader.create(name.c_str(), 8));
+        ASSERT_TRUE(writer.open(name.c_str()));
+        writer.push(setChannel(1, 1100));
+        writer.push(setChannel(1, 1200));
+    }
+
+    CommandRing reader2;
+    ASSERT_TRUE(reader2.create(name.c_str(), 8));
+    CrsfCommand cmd;
+    EXPECT_FALSE(reader2.pop(cmd));
+
+    // Писатель со старым отображением продолжает работать
+    EXPECT_EQ(writer.push(setChannel(5, 1300)), 2);
+    ASSERT_TRUE(reader2.pop(cmd));
+    EXPECT_EQ(cmd.channel, 5);
+}
+
+/**
+ * @test Несколько писателей: ни одна команда не теряется, порядок каждого писателя сохраняется
+ */
+TEST_F(CommandRingTest, MultipleProducers_AllCommandsDeliveredInOrder) {
+    CommandRing reader;
+    ASSERT_TRUE(reader.create(name.c_str(), 64));
+
+    const int producers = 4;
+    const int perProducer = 2000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            CommandRing writer;
+            if (!writer.open(name.c_str())) return;
+            for (int i = 0; i < perProducer; ++i) {
+                CrsfCommand cmd = setChannel(static_cast<uint8_t>(p + 1), i);
+                while (writer.push(cmd) < 0) {
+                    std::this_thread::yield(); // кольцо полно — ждём читателя
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        CrsfCommand cmd;
+        if (!reader.pop(cmd)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = cmd.channel - 1;
+        if (cmd.value != next[p]) ordered = false;
+        next[p] = cmd.value + 1;
+        received++;
+    }
+    for (std::thread& t : threads) t.join();
+
+    EXPECT_TRUE(ordered);
+    for (int p = 0; p < producers; ++p) {
+        EXPECT_EQ(next[p], perProducer);
+    }
+}
@@ -8,6 +8,7 @@
  * - Обработка поврежденных данных
  * - Ошибки последовательного порта
  * - Граничные случаи
+ * - Счётчики разбора: кадры по типу, ошибки CRC, сдвиги в поиске начала кадра
  * 
  * @version 4.3
  */
@@ -15,6 +16,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <memory>
+#include <cstring>
+#include <vector>
 #include "../libs/crsf/CrsfSerial.h"
 #include "../libs/crsf/crsf_protocol.h"
 #include "mocks/MockSerialPort.h"
@@ -337,3 +340,44 @@ TEST_F(CrsfErrorHandlingTest, ErrorHandling_MultipleErrors_SystemStable) {
     EXPECT_NO_THROW(crsf->loop());
 }
 
+
+/**
+ * @test Статистика разбора: верный кадр, кадр с неверным CRC и байт с неверной длиной
+ */
+TEST_F(CrsfErrorHandlingTest, ParserStats_CountsFramesCrcErrorsResyncs) {
+    uint8_t payload[10] = {0};
+    Crc8 crc(0xD5);
+    uint8_t good[14];
+    good[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    good[1] = 12;
+    good[2] = CRSF_FRAMETYPE_BATTERY_SENSOR;
+    memcpy(&good[3], payload, 10);
+    good[13] = crc.calc(&good[2], 11);
+
+    uint8_t bad[14];
+    memcpy(bad, good, sizeof(bad));
+    bad[13] ^= 0xFF;
+
+    // Мусорный байт с неверной длиной (0) перед кадрами
+    std::vector<uint8_t> stream = {CRSF_ADDRESS_FLIGHT_CONTROLLER, 0};
+    stream.insert(stream.end(), good, good + 14);
+    stream.insert(stream.end(), bad, bad + 14);
+
+    InSequence seq;
+    for (uint8_t b : stream) {
+        EXPECT_CALL(*mockSerial, readByte(_))
+            .WillOnce(DoAll(::testing::SetArgReferee<0>(b), Return(1)));
+    }
+    EXPECT_CALL(*mockSerial, readByte(_))
+        .WillRepeatedly(Return(0));
+
+    while (crsf->loop() > 0) {
+    }
+
+    const CrsfParserStats& stats = crsf->getParserStats();
+    EXPECT_EQ(stats.bytes, stream.size());
+    EXPECT_EQ(stats.frames, 1u);
+    EXPECT_EQ(stats.framesByType[CRSF_FRAMETYPE_BATTERY_SENSOR], 1u);
+    EXPECT_EQ(stats.crcErrors, 1u);
+    EXPECT_GE(stats.resyncs, 1u);
+}
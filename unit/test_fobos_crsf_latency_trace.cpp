@@ -0,0 +1,125 @@
+/**
+ * @file test_fobos_crsf_latency_trace.cpp
+ * @brief Unit тесты для трассировки задержки команд каналов до UART (crsf/crsf.cpp)
+ *
+ * Тесты проверяют:
+ * - Команда с отметкой клиента даёт одно измерение ipc/queue/total на отправленный кадр
+ * - Внутренние записи каналов без отметки в гистограммы не попадают
+ * - Запись без отметки поверх ожидающей команды отменяет её измерение
+ * - Неподвижный джойстик не пишет каналы: нет пустых измерений, команда кольца не затёрта
+ *
+ * Порты CRSF в тестах не открыты: write() в UART завершается ошибкой, трассировка работает
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <linux/joystick.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../crsf/crsf.h"
+#include "../libs/joystick.h"
+
+/**
+ * @class CrsfLatencyTraceTest
+ * @brief Фикстура: пустые гистограммы и каналы без ожидающих команд
+ */
+class CrsfLatencyTraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        crsfSendChannels();
+        crsfResetLatencyTrace();
+    }
+
+    static const CrsfLatencyTrace& trace() { return crsfGetLatencyTrace(); }
+};
+
+/**
+ * @test Команда с отметкой: одно измерение на кадр, следующий кадр её не учитывает
+ */
+TEST_F(CrsfLatencyTraceTest, StampedCommand_TracedOnce) {
+    // Act
+    crsfSetChannelStamped(2, 1600, rpi_nanos());
+    crsfSendChannels();
+    crsfSendChannels();
+
+    // Assert
+    EXPECT_EQ(trace().ipc.count(), 1u);
+    EXPECT_EQ(trace().queue.count(), 1u);
+    EXPECT_EQ(trace().total.count(), 1u);
+    EXPECT_EQ(trace().write.count(), 2u);
+}
+
+/**
+ * @test Внутренние записи без отметки: ни одного измерения команд, кадры считаются
+ */
+TEST_F(CrsfLatencyTraceTest, UnstampedWrites_NotTraced) {
+    for (int tick = 0; tick < 10; ++tick) {
+        for (unsigned int ch = 1; ch <= 4; ++ch) crsfSetChannel(ch, 1500);
+        crsfSendChannels();
+    }
+
+    EXPECT_EQ(trace().ipc.count(), 0u);
+    EXPECT_EQ(trace().queue.count(), 0u);
+    EXPECT_EQ(trace().total.count(), 0u);
+    EXPECT_EQ(trace().write.count(), 10u);
+}
+
+/**
+ * @test Запись без отметки перезаписала команду до отправки — её значение в UART не ушло
+ */
+TEST_F(CrsfLatencyTraceTest, UnstampedOverwrite_CancelsPendingCommand) {
+    crsfSetChannelStamped(1, 1700, rpi_nanos());
+    crsfSetChannel(1, 1500);
+    crsfSendChannels();
+
+    EXPECT_EQ(trace().total.count(), 0u);
+}
+
+/**
+ * @test Оси джойстика не менялись: каналы 1-4 не пишутся, команда кольца уходит со своей отметкой
+ */
+TEST_F(CrsfLatencyTraceTest, JoystickUnchangedAxes_AddNoSamples) {
+    // Arrange: джойстик старого API через FIFO, начальное положение четырёх осей
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_js_trace_%d", static_cast<int>(getpid()));
+    unlink(path);
+    ASSERT_EQ(mkfifo(path, 0600), 0);
+    ASSERT_TRUE(js_open(path));
+    int writer = open(path, O_WRONLY | O_NONBLOCK);
+    ASSERT_GE(writer, 0);
+
+    js_event init[4] = {};
+    for (int i = 0; i < 4; ++i) {
+        init[i] = {10, static_cast<int16_t>(i * 1000), JS_EVENT_AXIS | JS_EVENT_INIT, static_cast<uint8_t>(i)};
+    }
+    ASSERT_EQ(write(writer, init, sizeof(init)), static_cast<ssize_t>(sizeof(init)));
+    ASSERT_TRUE(js_poll());
+    EXPECT_EQ(js_update_channels(&crsfSetChannelStamped), 4);
+    crsfSendChannels();
+    crsfResetLatencyTrace();
+
+    // Act: команда клиента на канал 1, затем тики движка без движения стиков
+    crsfSetChannelStamped(1, 1700, rpi_nanos());
+    for (int tick = 0; tick < 10; ++tick) {
+        js_poll();
+        EXPECT_EQ(js_update_channels(&crsfSetChannelStamped), 0);
+    }
+    crsfSendChannels();
+
+    // Assert: одно измерение — команды; запись оси поверх отменила бы его
+    EXPECT_EQ(trace().ipc.count(), 1u);
+    EXPECT_EQ(trace().total.count(), 1u);
+
+    // Сдвинулась одна ось — записан только её канал (ось 0 -> канал 4, yaw)
+    js_event move = {20, 5000, JS_EVENT_AXIS, 0};
+    ASSERT_EQ(write(writer, &move, sizeof(move)), static_cast<ssize_t>(sizeof(move)));
+    ASSERT_TRUE(js_poll());
+    EXPECT_EQ(js_update_channels(&crsfSetChannelStamped), 1);
+
+    close(writer);
+    js_close();
+    unlink(path);
+}
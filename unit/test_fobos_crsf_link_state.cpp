@@ -4,7 +4,7 @@
  * 
  * Тесты проверяют:
  * - Переходы состояния связи (link up/down)
- * - Таймаут failsafe (CRSF_FAILSAFE_STAGE1_MS)
+ * - Таймаут failsafe (CRSF_FAILSAFE_STAGE1_MS) на подменённых часах rpi_set_clock_source()
  * - Автоматический вызов onLinkUp/onLinkDown
  * - Обновление статистики связи
  * 
@@ -44,6 +44,10 @@ static void onLinkUpHandler() { g_linkUpCalled = true; }
  */
 static void onLinkDownHandler() { g_linkDownCalled = true; }
 
+// Подменённые часы для тестов таймаутов: время двигается только вручную
+static uint64_t g_fakeNowNs = 0;
+static uint64_t fakeClock() { return g_fakeNowNs; }
+
 /**
  * @class CrsfLinkStateTest
  * @brief Фикстура для тестов состояния связи
@@ -65,6 +69,9 @@ protected:
     }
     
     void TearDown() override {
+        // Возвращаем настоящие часы
+        rpi_set_clock_source(nullptr);
+
         // Очищаем состояние после теста
         if (crsf) {
             crsf->onLinkUp = nullptr;
@@ -305,3 +312,45 @@ TEST_F(CrsfLinkStateTest, LinkState_LinkDown_StatisticsAvailable) {
     EXPECT_NE(stats, nullptr);
 }
 
+
+/**
+ * @test Failsafe по таймауту приёма
+ *
+ * Тест проверяет, что связь остаётся установленной ровно до
+ * CRSF_FAILSAFE_STAGE1_NS без данных и падает сразу после,
+ * с вызовом onLinkDown. Время задаётся подменённым источником rpi_nanos().
+ */
+TEST_F(CrsfLinkStateTest, LinkState_NoDataPastFailsafe_LinkDown) {
+    uint8_t packet[64];
+    uint8_t totalLen;
+    createChannelsPacket(packet, totalLen);
+    g_fakeNowNs = 5000000000ull;
+    rpi_set_clock_source(fakeClock);
+
+    // Устанавливаем связь пакетом каналов
+    {
+        InSequence seq;
+        for (uint8_t i = 0; i < totalLen; i++) {
+            EXPECT_CALL(*mockSerial, readByte(_))
+                .WillOnce(DoAll(::testing::SetArgReferee<0>(packet[i]), Return(1)));
+        }
+        EXPECT_CALL(*mockSerial, readByte(_))
+            .WillRepeatedly(Return(0));
+        crsf->loop();
+    }
+    ASSERT_TRUE(crsf->isLinkUp());
+    EXPECT_EQ(crsf->getLastReceiveNs(), 5000000000ull);
+    EXPECT_EQ(crsf->getLastChannelsPacketNs(), 5000000000ull);
+
+    // Ровно на границе таймаута связь ещё есть
+    g_fakeNowNs += CrsfSerial::CRSF_FAILSAFE_STAGE1_NS;
+    crsf->loop();
+    EXPECT_TRUE(crsf->isLinkUp());
+    EXPECT_FALSE(g_linkDownCalled);
+
+    // Через 1 нс после таймаута — failsafe
+    g_fakeNowNs += 1;
+    crsf->loop();
+    EXPECT_FALSE(crsf->isLinkUp());
+    EXPECT_TRUE(g_linkDownCalled);
+}
@@ -10,6 +10,7 @@
  * - Attitude
  * - Flight Mode
  * - Невалидные пакеты (неверный CRC, длина, адрес)
+ * - Обработчик onFrameDecoded для каждого кадра с верным CRC
  * 
  * @version 4.3
  */
@@ -27,6 +28,14 @@ using ::testing::Return;
 using ::testing::InSequence;
 using ::testing::DoAll;
 
+// Типы кадров, переданные в onFrameDecoded
+static uint8_t g_decodedTypes[8];
+static int g_decodedCount = 0;
+static void onFrameDecodedHandler(const crsf_header_t* frame) {
+    if (g_decodedCount < 8) g_decodedTypes[g_decodedCount] = frame->type;
+    g_decodedCount++;
+}
+
 /**
  * @class CrsfPacketParsingTest
  * @brief Фикстура для тестов парсинга пакетов
@@ -373,3 +382,78 @@ TEST_F(CrsfPacketParsingTest, ParsePacket_FlightMode_ProcessesPacket) {
     EXPECT_NO_THROW(crsf->loop());
 }
 
+/**
+ * @test Парсинг кадра синхронизации RADIO_ID / OPENTX_SYNC
+ * 
+ * TX-модуль сообщает интервал RC-пакетов и сдвиг фазы в единицах 0.1 мкс
+ * (big endian). После парсинга значения доступны в наносекундах,
+ * а счётчик кадров синхронизации увеличивается.
+ */
+TEST_F(CrsfPacketParsingTest, ParsePacket_RadioIdSync_UpdatesSync) {
+    uint8_t packet[64];
+    uint8_t payload[CRSF_FRAME_RADIO_ID_SYNC_PAYLOAD_SIZE] = {
+        CRSF_ADDRESS_RADIO_TRANSMITTER, CRSF_ADDRESS_CRSF_TRANSMITTER, CRSF_FRAMETYPE_OPENTX_SYNC,
+        0x00, 0x00, 0x9C, 0x40,   // rate = 40000 * 0.1 мкс = 4000 мкс (250 Гц)
+        0xFF, 0xFF, 0xFC, 0x18    // offset = -1000 * 0.1 мкс = -100 мкс
+    };
+    
+    uint8_t totalLen;
+    createValidPacket(packet, CRSF_ADDRESS_RADIO_TRANSMITTER, 
+                     CRSF_FRAMETYPE_RADIO_ID, payload, sizeof(payload), totalLen);
+    
+    InSequence seq;
+    for (uint8_t i = 0; i < totalLen; i++) {
+        EXPECT_CALL(*mockSerial, readByte(_))
+            .WillOnce(DoAll(::testing::SetArgReferee<0>(packet[i]), Return(1)));
+    }
+    EXPECT_CALL(*mockSerial, readByte(_))
+        .WillRepeatedly(Return(0));
+    
+    EXPECT_EQ(crsf->getSyncCount(), 0u);
+    crsf->loop();
+    
+    EXPECT_EQ(crsf->getSyncCount(), 1u);
+    EXPECT_EQ(crsf->getSyncIntervalNs(), 4000000u);
+    EXPECT_EQ(crsf->getSyncOffsetNs(), -100000);
+    // Кадр синхронизации не устанавливает связь с полетником
+    EXPECT_FALSE(crsf->isLinkUp());
+}
+
+/**
+ * @test Обработчик каждого разобранного кадра
+ *
+ * Тест проверяет, что onFrameDecoded вызывается один раз на кадр с верным CRC
+ * (с типом кадра) и не вызывается для кадра с испорченным CRC.
+ */
+TEST_F(CrsfPacketParsingTest, ParsePacket_OnFrameDecoded_CalledPerValidFrame) {
+    uint8_t packet[128];
+    uint8_t battery[8] = {0};
+    uint8_t attitude[6] = {0};
+    uint8_t len1, len2, len3;
+    createValidPacket(packet, CRSF_ADDRESS_FLIGHT_CONTROLLER,
+                      CRSF_FRAMETYPE_BATTERY_SENSOR, battery, 8, len1);
+    createValidPacket(packet + len1, CRSF_ADDRESS_FLIGHT_CONTROLLER,
+                      CRSF_FRAMETYPE_ATTITUDE, attitude, 6, len2);
+    createValidPacket(packet + len1 + len2, CRSF_ADDRESS_FLIGHT_CONTROLLER,
+                      CRSF_FRAMETYPE_ATTITUDE, attitude, 6, len3);
+    packet[len1 + len2 + len3 - 1] ^= 0xFF; // третий кадр с неверным CRC
+    uint8_t totalLen = len1 + len2 + len3;
+
+    g_decodedCount = 0;
+    crsf->onFrameDecoded = onFrameDecodedHandler;
+
+    InSequence seq;
+    for (uint8_t i = 0; i < totalLen; i++) {
+        EXPECT_CALL(*mockSerial, readByte(_))
+            .WillOnce(DoAll(::testing::SetArgReferee<0>(packet[i]), Return(1)));
+    }
+    EXPECT_CALL(*mockSerial, readByte(_))
+        .WillRepeatedly(Return(0));
+
+    crsf->loop();
+    crsf->loop();
+
+    ASSERT_EQ(g_decodedCount, 2);
+    EXPECT_EQ(g_decodedTypes[0], CRSF_FRAMETYPE_BATTERY_SENSOR);
+    EXPECT_EQ(g_decodedTypes[1], CRSF_FRAMETYPE_ATTITUDE);
+}
@@ -0,0 +1,473 @@
+/**
+ * @file test_fobos_http_server.cpp
+ * @brief Unit тесты для однопоточного HTTP сервера на epoll
+ *
+ * Тесты проверяют:
+ * - Разбор запроса: строка запроса, заголовки, тело, неполный и ошибочный запрос
+ * - Keep-alive по умолчанию для HTTP/1.1 и Connection: close
+ * - Ответы на конвейерные запросы по порядку в одном соединении, обратное давление без 413
+ * - Ограничение числа соединений, адрес прослушивания
+ * - Потоковый ответ по событию своего дескриптора (eventfd) и обработчик закрытия
+ * - Лимит частоты запросов (429) и закрытие медленного клиента: лимит буфера, зависшая запись
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "../libs/http_server.h"
+
+/**
+ * @test Полный запрос: метод, путь, строка запроса, заголовки в нижнем регистре, тело
+ */
+TEST(HttpParseTest, Parse_FullRequest_AllParts) {
+    const std::string raw =
+        "POST /api/command?cmd=setMode&value=manual HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Length: 5\r\n"
+        "X-Test:  value \r\n"
+        "\r\n"
+        "hello";
+    HttpRequest req;
+
+    long used = httpParseRequest(raw.data(), raw.size(), req);
+
+    ASSERT_EQ(used, static_cast<long>(raw.size()));
+    EXPECT_EQ(req.method, "POST");
+    EXPECT_EQ(req.path, "/api/command");
+    EXPECT_EQ(req.query, "cmd=setMode&value=manual");
+    EXPECT_EQ(req.versionMinor, 1);
+    EXPECT_TRUE(req.keepAlive);
+    ASSERT_NE(req.header("x-test"), nullptr);
+    EXPECT_EQ(*req.header("x-test"), "value");
+    EXPECT_EQ(req.body, "hello");
+}
+
+/**
+ * @test Неполный запрос (нет конца заголовков или тела) — 0, мусор — -1
+ */
+TEST(HttpParseTest, Parse_PartialOrMalformed) {
+    HttpRequest req;
+    const std::string partial = "GET /api/telemetry HTTP/1.1\r\nHost: x\r\n";
+    EXPECT_EQ(httpParseRequest(partial.data(), partial.size(), req), 0);
+
+    const std::string partialBody = "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\nabc";
+    EXPECT_EQ(httpParseRequest(partialBody.data(), partialBody.size(), req), 0);
+
+    const std::string garbage = "HELLO\r\n\r\n";
+    EXPECT_EQ(httpParseRequest(garbage.data(), garbage.size(), req), -1);
+
+    const std::string badVersion = "GET / HTTP/2.0\r\n\r\n";
+    EXPECT_EQ(httpParseRequest(badVersion.data(), badVersion.size(), req), -1);
+}
+
+/**
+ * @test Keep-alive: HTTP/1.1 по умолчанию, Connection: close, HTTP/1.0
+ */
+TEST(HttpParseTest, Parse_KeepAliveRules) {
+    HttpRequest req;
+    const std::string close11 = "GET / HTTP/1.1\r\nConnection: Close\r\n\r\n";
+    ASSERT_GT(httpParseRequest(close11.data(), close11.size(), req), 0);
+    EXPECT_FALSE(req.keepAlive);
+
+    const std::string plain10 = "GET / HTTP/1.0\r\n\r\n";
+    ASSERT_GT(httpParseRequest(plain10.data(), plain10.size(), req), 0);
+    EXPECT_FALSE(req.keepAlive);
+
+    const std::string keep10 = "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n";
+    ASSERT_GT(httpParseRequest(keep10.data(), keep10.size(), req), 0);
+    EXPECT_TRUE(req.keepAlive);
+}
+
+/**
+ * @class HttpServerTest
+ * @brief Фикстура: сервер на свободном порту, цикл poll() в отдельном потоке
+ */
+class HttpServerTest : public ::testing::Test {
+protected:
+    void startServer(int maxConnections) {
+        ASSERT_TRUE(server.start(0, &echoPath, nullptr, maxConnections));
+        runLoop();
+    }
+
+    void runLoop() {
+        running = true;
+        loop = std::thread([this]() {
+            while (running.load()) server.poll(10);
+        });
+    }
+
+    void TearDown() override {
+        running = false;
+        if (loop.joinable()) loop.join();
+        server.stop();
+    }
+
+    // Ответ — путь запроса
+    static void echoPath(HttpServer& s, int conn, const HttpRequest& req, void*) {
+        s.respond(conn, 200, "text/plain", req.path);
+    }
+
+    int connectClient() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(server.port()));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        struct timeval tv = {2, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Читать, пока в ответе не встретится expect (или таймаут/закрытие)
+    static std::string readUntil(int fd, const std::string& expect) {
+        std::string data;
+        char buf[1024];
+        while (data.find(expect) == std::string::npos) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            data.append(buf, static_cast<size_t>(n));
+        }
+        return data;
+    }
+
+    HttpServer server;
+    std::atomic<bool> running{false};
+    std::thread loop;
+};
+
+/**
+ * @test Два конвейерных запроса в одном пакете — два ответа по порядку, соединение открыто
+ */
+TEST_F(HttpServerTest, Pipelined_RequestsAnsweredInOrder_KeepAlive) {
+    startServer(4);
+    int fd = connectClient();
+    ASSERT_GE(fd, 0);
+
+    const std::string two = "GET /first HTTP/1.1\r\nHost: x\r\n\r\nGET /second HTTP/1.1\r\nHost: x\r\n\r\n";
+    ASSERT_EQ(send(fd, two.data(), two.size(), 0), static_cast<ssize_t>(two.size()));
+    std::string resp = readUntil(fd, "/second");
+
+    size_t first = resp.find("/first");
+    size_t second = resp.find("/second");
+    ASSERT_NE(first, std::string::npos);
+    ASSERT_NE(second, std::string::npos);
+    EXPECT_LT(first, second);
+    EXPECT_NE(resp.find("Connection: keep-alive"), std::string::npos);
+
+    // То же соединение обслуживает следующий запрос
+    const std::string third = "GET /third HTTP/1.1\r\n\r\n";
+    send(fd, third.data(), third.size(), 0);
+    EXPECT_NE(readUntil(fd, "/third").find("/third"), std::string::npos);
+    close(fd);
+}
+
+/**
+ * @test Connection: close — ответ и закрытие соединения сервером
+ */
+TEST_F(HttpServerTest, ConnectionClose_ServerClosesAfterResponse) {
+    startServer(4);
+    int fd = connectClient();
+    ASSERT_GE(fd, 0);
+
+    const std::string req = "GET /bye HTTP/1.1\r\nConnection: close\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    std::string resp = readUntil(fd, "\x01");  // до закрытия
+    EXPECT_NE(resp.find("200 OK"), std::string::npos);
+    EXPECT_NE(resp.find("/bye"), std::string::npos);
+    close(fd);
+}
+
+/**
+ * @test Соединение сверх лимита получает 503
+ */
+TEST_F(HttpServerTest, ConnectionLimit_ExtraClientGets503) {
+    startServer(1);
+    int first = connectClient();
+    ASSERT_GE(first, 0);
+    const std::string req = "GET /one HTTP/1.1\r\n\r\n";
+    send(first, req.data(), req.size(), 0);
+    ASSERT_NE(readUntil(first, "/one").find("/one"), std::string::npos);
+
+    int second = connectClient();
+    ASSERT_GE(second, 0);
+    std::string resp = readUntil(second, "\x01");
+    EXPECT_NE(resp.find("503"), std::string::npos);
+    close(second);
+    close(first);
+}
+
+/**
+ * @test Адрес прослушивания: не IPv4 — ошибка запуска, loopback принимает соединения
+ */
+TEST_F(HttpServerTest, Start_BindAddress_InvalidRejected) {
+    EXPECT_FALSE(server.start(0, &echoPath, nullptr, 4, "localhost"));
+    EXPECT_FALSE(server.start(0, &echoPath, nullptr, 4, nullptr));
+    EXPECT_FALSE(server.isRunning());
+
+    ASSERT_TRUE(server.start(0, &echoPath, nullptr, 4, "127.0.0.1"));
+    runLoop();
+    int fd = connectClient();
+    ASSERT_GE(fd, 0);
+    const std::string req = "GET /bound HTTP/1.1\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    EXPECT_NE(readUntil(fd, "/bound").find("/bound"), std::string::npos);
+    close(fd);
+}
+
+/**
+ * @class StreamContext
+ * @brief Состояние теста потокового ответа: eventfd-источник событий и открытый поток
+ */
+struct StreamContext {
+    int eventFd = -1;
+    int streamConn = -1;
+    HttpServer* server = nullptr;
+    std::atomic<int> closed{0};
+};
+
+static void startStream(HttpServer& s, int conn, const HttpRequest& req, void* context) {
+    StreamContext* ctx = static_cast<StreamContext*>(context);
+    if (req.path == "/stream") {
+        s.beginStream(conn, "text/event-stream");
+        ctx->streamConn = conn;
+    } else {
+        s.respond(conn, 404, "text/plain", "no\n", 3);
+    }
+}
+
+static void onStreamClosed(HttpServer&, int conn, void* context) {
+    StreamContext* ctx = static_cast<StreamContext*>(context);
+    if (conn == ctx->streamConn) ctx->closed++;
+}
+
+/**
+ * @test Событие eventfd в том же epoll дописывает данные в открытый поток; закрытие видно обработчику
+ */
+TEST_F(HttpServerTest, Stream_WatchedFdPushesEvents_CloseHandlerCalled) {
+    StreamContext ctx;
+    ctx.eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(ctx.eventFd, 0);
+    ctx.server = &server;
+    ASSERT_TRUE(server.start(0, &startStream, &ctx, 4));
+    server.setCloseHandler(&onStreamClosed);
+    ASSERT_TRUE(server.watchFd(ctx.eventFd, [](int fd, void* context) {
+        StreamContext* c = static_cast<StreamContext*>(context);
+        uint64_t value = 0;
+        if (read(fd, &value, sizeof(value)) != sizeof(value)) return;
+        c->server->sendStream(c->streamConn, "data: tick\n\n", 12);
+    }));
+    runLoop();
+
+    int fd = connectClient();
+    ASSERT_GE(fd, 0);
+    const std::string req = "GET /stream HTTP/1.1\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    std::string head = readUntil(fd, "\r\n\r\n");
+    EXPECT_NE(head.find("text/event-stream"), std::string::npos);
+    EXPECT_EQ(head.find("Content-Length"), std::string::npos);
+
+    uint64_t one = 1;
+    ASSERT_EQ(write(ctx.eventFd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+    EXPECT_NE(readUntil(fd, "tick").find("data: tick"), std::string::npos);
+
+    close(fd);
+    for (int i = 0; i < 200 && ctx.closed.load() == 0; ++i) usleep(5000);
+    EXPECT_EQ(ctx.closed.load(), 1);
+    running = false;
+    loop.join();
+    server.stop();
+    close(ctx.eventFd);
+}
+
+/**
+ * @test Запросы сверх лимита частоты получают 429 с Retry-After, соединение остаётся открытым
+ */
+TEST_F(HttpServerTest, RateLimit_ExcessRequestsGet429) {
+    server.setRateLimit(1, 2);
+    startServer(4);
+    int fd = connectClient();
+    ASSERT_GE(fd, 0);
+
+    const std::string three =
+        "GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\n\r\nGET /c HTTP/1.1\r\n\r\n";
+    send(fd, three.data(), three.size(), 0);
+    std::string resp = readUntil(fd, "Too Many Requests\n");
+
+    EXPECT_NE(resp.find("/a"), std::string::npos);
+    EXPECT_NE(resp.find("/b"), std::string::npos);
+    EXPECT_EQ(resp.find("/c"), std::string::npos);
+    EXPECT_NE(resp.find("HTTP/1.1 429 Too Many Requests"), std::string::npos);
+    EXPECT_NE(resp.find("Retry-After: 1"), std::string::npos);
+    close(fd);
+
+    running = false;
+    loop.join();
+    EXPECT_EQ(server.requestsRateLimited(), 1u);
+}
+
+// Клиент с маленьким приёмным буфером, который не читает поток
+static int connectSlowClient(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int rcvbuf = 4096;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    const std::string req = "GET /stream HTTP/1.1\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    return fd;
+}
+
+// Событие eventfd — 64 КБ в поток
+static void pushChunk(int fd, void* context) {
+    StreamContext* c = static_cast<StreamContext*>(context);
+    uint64_t value = 0;
+    if (read(fd, &value, sizeof(value)) != sizeof(value) || c->streamConn < 0) return;
+    static const std::string chunk(65536, 'x');
+    c->server->sendStream(c->streamConn, chunk.data(), chunk.size());
+}
+
+/**
+ * @test Нечитающий клиент: выходной буфер упирается в maxOutput — соединение закрывается
+ */
+TEST_F(HttpServerTest, SlowClient_OutputLimit_Disconnected) {
+    StreamContext ctx;
+    ctx.eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ctx.server = &server;
+    ASSERT_TRUE(server.start(0, &startStream, &ctx, 4));
+    server.setCloseHandler(&onStreamClosed);
+    server.setMaxOutput(262144);
+    ASSERT_TRUE(server.watchFd(ctx.eventFd, &pushChunk));
+    runLoop();
+
+    int fd = connectSlowClient(server.port());
+    ASSERT_GE(fd, 0);
+    uint64_t one = 1;
+    for (int i = 0; i < 1000 && ctx.closed.load() == 0; ++i) {
+        ASSERT_EQ(write(ctx.eventFd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+        usleep(2000);
+    }
+
+    EXPECT_EQ(ctx.closed.load(), 1);
+    running = false;
+    loop.join();
+    EXPECT_EQ(server.slowClientsClosed(), 1u);
+    server.stop();
+    close(fd);
+    close(ctx.eventFd);
+}
+
+/**
+ * @test Неотправленные данные без продвижения дольше writeTimeout — потоковое соединение закрывается
+ */
+TEST_F(HttpServerTest, SlowClient_WriteStall_Disconnected) {
+    StreamContext ctx;
+    ctx.eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ctx.server = &server;
+    ASSERT_TRUE(server.start(0, &startStream, &ctx, 4));
+    server.setCloseHandler(&onStreamClosed);
+    server.setMaxOutput(static_cast<size_t>(1) << 30);
+    server.setWriteTimeoutMs(100);
+    ASSERT_TRUE(server.watchFd(ctx.eventFd, &pushChunk));
+    runLoop();
+
+    int fd = connectSlowClient(server.port());
+    ASSERT_GE(fd, 0);
+    for (int i = 0; i < 200 && ctx.streamConn < 0; ++i) usleep(5000);
+    // 6 МБ — больше, чем вместят буферы сокетов: остаток ждёт в выходном буфере сервера
+    uint64_t one = 1;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(write(ctx.eventFd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+        usleep(1000);
+    }
+    for (int i = 0; i < 600 && ctx.closed.load() == 0; ++i) usleep(5000);
+
+    EXPECT_EQ(ctx.closed.load(), 1);
+    running = false;
+    loop.join();
+    EXPECT_EQ(server.slowClientsClosed(), 1u);
+    server.stop();
+    close(fd);
+    close(ctx.eventFd);
+}
+
+// Ответ 4 КБ: несколько десятков таких ответов заполняют MAX_PENDING_OUTPUT
+static void respond4k(HttpServer& s, int conn, const HttpRequest&, void*) {
+    static const std::string body(4096, 'x');
+    s.respond(conn, 200, "text/plain", body);
+}
+
+/**
+ * @test Конвейер больше лимита запроса у нечитающего клиента: чтение приостанавливается,
+ *       когда клиент начинает читать — все ответы приходят, 413 нет
+ */
+TEST_F(HttpServerTest, Pipelined_ClientNotReading_BackpressureWithout413) {
+    ASSERT_TRUE(server.start(0, &respond4k, nullptr, 4));
+    runLoop();
+    int fd = connectSlowClient(server.port());
+    ASSERT_GE(fd, 0);
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    // Arrange: запросов больше HTTP_MAX_HEADER_SIZE + HTTP_MAX_BODY_SIZE, отправка блокируется,
+    // пока сервер не читает
+    const size_t count = 6000;
+    std::string requests;
+    for (size_t i = 0; i < count; ++i) requests += "GET /4k HTTP/1.1\r\n\r\n";
+    ASSERT_GT(requests.size(), HTTP_MAX_HEADER_SIZE + HTTP_MAX_BODY_SIZE);
+    std::thread writer([fd, &requests]() {
+        size_t sent = 0;
+        while (sent < requests.size()) {
+            ssize_t n = send(fd, requests.data() + sent, requests.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+    });
+    usleep(200000);  // клиент не читает: ответы копятся, сервер перестаёт читать запросы
+
+    // Act
+    std::string tail;  // непросмотренный конец: строка статуса может разорваться между recv
+    size_t responses = 0;
+    size_t ok = 0;
+    char buf[65536];
+    while (responses < count) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        tail.append(buf, static_cast<size_t>(n));
+        size_t pos = 0;
+        while ((pos = tail.find("HTTP/1.1 ", pos)) != std::string::npos && pos + 12 <= tail.size()) {
+            responses++;
+            if (tail.compare(pos + 9, 3, "200") == 0) ok++;
+            pos += 12;
+        }
+        tail.erase(0, pos != std::string::npos ? pos : (tail.size() > 11 ? tail.size() - 11 : 0));
+    }
+    writer.join();
+
+    // Assert
+    EXPECT_EQ(responses, count);
+    EXPECT_EQ(ok, count);
+    EXPECT_EQ(server.slowClientsClosed(), 0u);
+    close(fd);
+}
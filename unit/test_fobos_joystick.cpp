@@ -0,0 +1,97 @@
+/**
+ * @file test_fobos_joystick.cpp
+ * @brief Unit тесты для обёртки джойстика Linux (evdev и старый joystick API)
+ *
+ * Тесты проверяют:
+ * - Нормировку оси evdev по диапазону EVIOCGABS: центр, края, мёртвая зона flat
+ * - Пачку событий старого API за один опрос: оси, кнопки, число по номерам из событий
+ * - Отметка ядра недоступна для старого API, дескриптор для epoll
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <linux/joystick.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../libs/joystick.h"
+
+/**
+ * @test Нормировка: несимметричный диапазон 0..255 (геймпад), -512..511, вырожденный диапазон
+ */
+TEST(JoystickTest, NormalizeAbs_RangeAndCenter) {
+    EXPECT_EQ(js_normalize_abs(0, 0, 255, 0), -32767);
+    EXPECT_EQ(js_normalize_abs(255, 0, 255, 0), 32767);
+    EXPECT_EQ(js_normalize_abs(-512, -512, 511, 0), -32767);
+    EXPECT_EQ(js_normalize_abs(511, -512, 511, 0), 32767);
+    EXPECT_NEAR(js_normalize_abs(128, 0, 255, 0), 0, 129);
+    EXPECT_NEAR(js_normalize_abs(64, 0, 256, 0), -16384, 1);
+
+    // За пределами диапазона — насыщение, пустой диапазон — 0
+    EXPECT_EQ(js_normalize_abs(300, 0, 255, 0), 32767);
+    EXPECT_EQ(js_normalize_abs(5, 10, 10, 0), 0);
+}
+
+/**
+ * @test Мёртвая зона flat: внутри — 0, за ней шкала начинается с 0 и доходит до края
+ */
+TEST(JoystickTest, NormalizeAbs_FlatDeadZone) {
+    EXPECT_EQ(js_normalize_abs(15, -1000, 1000, 16), 0);
+    EXPECT_EQ(js_normalize_abs(-16, -1000, 1000, 16), 0);
+    EXPECT_GT(js_normalize_abs(17, -1000, 1000, 16), 0);
+    EXPECT_LT(js_normalize_abs(17, -1000, 1000, 16), 40);
+    EXPECT_EQ(js_normalize_abs(1000, -1000, 1000, 16), 32767);
+    EXPECT_EQ(js_normalize_abs(-1000, -1000, 1000, 16), -32767);
+}
+
+/**
+ * @test Старый API через FIFO: пачка событий за один опрос, состояние и число осей/кнопок
+ */
+TEST(JoystickTest, LegacyPoll_BatchOfEvents) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_js_%d", static_cast<int>(getpid()));
+    unlink(path);
+    ASSERT_EQ(mkfifo(path, 0600), 0);
+
+    ASSERT_TRUE(js_open(path));
+    int writer = open(path, O_WRONLY | O_NONBLOCK);
+    ASSERT_GE(writer, 0);
+    EXPECT_GE(js_fd(), 0);
+    EXPECT_FALSE(js_is_evdev());
+    EXPECT_FALSE(js_poll());
+
+    // Arrange: начальное состояние (JS_EVENT_INIT) и 100 движений одной оси
+    js_event events[103] = {};
+    events[0] = {10, 1200, JS_EVENT_AXIS | JS_EVENT_INIT, 0};
+    events[1] = {10, -300, JS_EVENT_AXIS | JS_EVENT_INIT, 3};
+    events[2] = {10, 1, JS_EVENT_BUTTON | JS_EVENT_INIT, 5};
+    for (int i = 0; i < 100; ++i) {
+        events[3 + i] = {static_cast<uint32_t>(20 + i), static_cast<int16_t>(i * 100), JS_EVENT_AXIS, 0};
+    }
+    ASSERT_EQ(write(writer, events, sizeof(events)), static_cast<ssize_t>(sizeof(events)));
+
+    // Act
+    EXPECT_TRUE(js_poll());
+
+    // Assert
+    int16_t value = 0;
+    bool pressed = false;
+    EXPECT_EQ(js_num_axes(), 4);
+    EXPECT_EQ(js_num_buttons(), 6);
+    ASSERT_TRUE(js_get_axis(0, value));
+    EXPECT_EQ(value, 9900);
+    ASSERT_TRUE(js_get_axis(3, value));
+    EXPECT_EQ(value, -300);
+    EXPECT_FALSE(js_get_axis(4, value));
+    ASSERT_TRUE(js_get_button(5, pressed));
+    EXPECT_TRUE(pressed);
+    EXPECT_EQ(js_axis_time_ns(0), 0u);  // в старом API нет отметки ядра
+
+    close(writer);
+    js_close();
+    EXPECT_EQ(js_fd(), -1);
+    EXPECT_EQ(js_num_axes(), 0);
+    unlink(path);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_fobos_json_writer.cpp
+ * @brief Unit тесты для записи JSON в заранее выделенный буфер
+ *
+ * Тесты проверяют:
+ * - Запятые между элементами объектов и массивов любой вложенности
+ * - Числа через to_chars: целые со знаком, double без потерь, NaN как null
+ * - Экранирование строк
+ * - Обрезку при нехватке буфера
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "../libs/json_writer.h"
+
+/**
+ * @test Вложенные объекты и массивы: запятые только между элементами
+ */
+TEST(JsonWriterTest, Nesting_CommasBetweenElements) {
+    char buf[256];
+    JsonWriter json(buf, sizeof(buf));
+
+    json.beginObject();
+    json.key("a"); json.uintValue(1);
+    json.key("list");
+    json.beginArray();
+    json.intValue(-2);
+    json.beginObject();
+    json.key("b"); json.boolValue(true);
+    json.endObject();
+    json.beginArray();
+    json.endArray();
+    json.endArray();
+    json.key("c"); json.nullValue();
+    json.endObject();
+
+    EXPECT_TRUE(json.ok());
+    EXPECT_EQ(std::string(json.data(), json.size()), "{\"a\":1,\"list\":[-2,{\"b\":true},[]],\"c\":null}");
+
+    // reset() — новый документ в том же буфере
+    json.reset();
+    json.beginArray();
+    json.uintValue(7);
+    json.endArray();
+    EXPECT_EQ(std::string(json.data(), json.size()), "[7]");
+}
+
+/**
+ * @test Числа: границы целых, double читается обратно без потерь, NaN и бесконечность — null
+ */
+TEST(JsonWriterTest, Numbers_RoundTripAndNonFinite) {
+    char buf[256];
+    JsonWriter json(buf, sizeof(buf));
+
+    json.beginArray();
+    json.uintValue(UINT64_MAX);
+    json.intValue(INT64_MIN);
+    json.doubleValue(55.755812345678);
+    json.doubleValue(0.1);
+    json.doubleValue(NAN);
+    json.doubleValue(-INFINITY);
+    json.floatValue(12.6f);
+    json.floatValue(NAN);
+    json.endArray();
+
+    std::string out(json.data(), json.size());
+    EXPECT_EQ(out, "[18446744073709551615,-9223372036854775808,55.755812345678,0.1,null,null,12.6,null]");
+}
+
+/**
+ * @test Кавычки, обратная косая черта и управляющие символы экранируются
+ */
+TEST(JsonWriterTest, String_EscapesSpecialCharacters) {
+    char buf[128];
+    JsonWriter json(buf, sizeof(buf));
+
+    json.stringValue("a\"b\\c\nd\x01" "e");
+
+    EXPECT_EQ(std::string(json.data(), json.size()), "\"a\\\"b\\\\c\\nd\\u0001e\"");
+}
+
+/**
+ * @test Буфер кончился: запись обрезана по границе буфера, ok() == false
+ */
+TEST(JsonWriterTest, Overflow_TruncatesAndReportsError) {
+    char buf[8];
+    JsonWriter json(buf, sizeof(buf));
+
+    json.beginArray();
+    json.uintValue(123456);
+    json.uintValue(789);
+    json.endArray();
+
+    EXPECT_FALSE(json.ok());
+    EXPECT_EQ(json.size(), sizeof(buf));
+    EXPECT_EQ(std::string(json.data(), json.size()), "[123456,");
+}
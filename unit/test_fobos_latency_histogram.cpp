@@ -0,0 +1,122 @@
+/**
+ * @file test_fobos_latency_histogram.cpp
+ * @brief Unit тесты для гистограммы задержек
+ *
+ * Тесты проверяют:
+ * - Точные корзины для малых значений и монотонность корзин
+ * - Относительную ошибку верхней границы корзины (<= 1/SUB_BUCKETS)
+ * - Перцентили, минимум, максимум и среднее
+ * - Сброс статистики
+ * - Накопленные счётчики для внешних границ (экспорт в Prometheus)
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include "../libs/latency_histogram.h"
+
+/**
+ * @test Корзины для малых значений точные, для больших — упорядочены
+ */
+TEST(LatencyHistogramTest, BucketOf_SmallValuesExact_LargeMonotonic) {
+    for (uint64_t v = 0; v < LatencyHistogram::SUB_BUCKETS; ++v) {
+        EXPECT_EQ(LatencyHistogram::bucketOf(v), v);
+        EXPECT_EQ(LatencyHistogram::bucketUpperNs(LatencyHistogram::bucketOf(v)), v);
+    }
+
+    unsigned prev = 0;
+    for (uint64_t v = 1; v < (1ull << 40); v = v * 3 / 2 + 1) {
+        unsigned b = LatencyHistogram::bucketOf(v);
+        EXPECT_GE(b, prev);
+        EXPECT_LT(b, LatencyHistogram::BUCKETS);
+        prev = b;
+    }
+    EXPECT_EQ(LatencyHistogram::bucketOf(UINT64_MAX), LatencyHistogram::BUCKETS - 1);
+    EXPECT_EQ(LatencyHistogram::bucketUpperNs(LatencyHistogram::BUCKETS - 1), UINT64_MAX);
+}
+
+/**
+ * @test Верхняя граница корзины не меньше значения и не дальше 12.5%
+ */
+TEST(LatencyHistogramTest, BucketUpper_WithinRelativeError) {
+    const uint64_t values[] = {9, 100, 1000, 12345, 999999, 4000000, 123456789};
+    for (uint64_t v : values) {
+        uint64_t upper = LatencyHistogram::bucketUpperNs(LatencyHistogram::bucketOf(v));
+        EXPECT_GE(upper, v);
+        EXPECT_LE(upper - v, v / LatencyHistogram::SUB_BUCKETS);
+    }
+}
+
+/**
+ * @test Перцентили на равномерном наборе 1..100 мкс
+ */
+TEST(LatencyHistogramTest, Percentile_UniformSamples_WithinBucketError) {
+    // Arrange
+    LatencyHistogram h;
+    for (uint64_t us = 1; us <= 100; ++us) {
+        h.record(us * 1000);
+    }
+
+    // Assert: перцентиль не меньше точного значения и не больше его на 12.5%
+    EXPECT_EQ(h.count(), 100u);
+    EXPECT_EQ(h.minNs(), 1000u);
+    EXPECT_EQ(h.maxNs(), 100000u);
+    EXPECT_EQ(h.meanNs(), 50500u);
+    EXPECT_GE(h.percentileNs(50.0), 50000u);
+    EXPECT_LE(h.percentileNs(50.0), 56250u);
+    EXPECT_GE(h.percentileNs(99.0), 99000u);
+    EXPECT_EQ(h.percentileNs(100.0), 100000u);
+}
+
+/**
+ * @test Одиночный выброс виден только в хвосте
+ */
+TEST(LatencyHistogramTest, Percentile_SingleOutlier_OnlyInTail) {
+    // Arrange: 999 измерений по 200 мкс и одно 15 мс
+    LatencyHistogram h;
+    for (int i = 0; i < 999; ++i) h.record(200000);
+    h.record(15000000);
+
+    // Assert
+    EXPECT_LE(h.percentileNs(99.0), 225000u);
+    EXPECT_EQ(h.percentileNs(100.0), 15000000u);
+    EXPECT_EQ(h.maxNs(), 15000000u);
+}
+
+/**
+ * @test Пустая гистограмма и сброс
+ */
+TEST(LatencyHistogramTest, Reset_ClearsAllStats) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.percentileNs(50.0), 0u);
+    EXPECT_EQ(h.minNs(), 0u);
+
+    h.record(5000);
+    h.record(7000);
+    h.reset();
+
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.maxNs(), 0u);
+    EXPECT_EQ(h.meanNs(), 0u);
+    EXPECT_EQ(h.percentileNs(99.0), 0u);
+}
+
+/**
+ * @test Накопленные счётчики по внешним границам и сумма измерений
+ */
+TEST(LatencyHistogramTest, CumulativeCounts_ExternalBounds) {
+    LatencyHistogram h;
+    for (int i = 0; i < 100; ++i) h.record(10000);     // 10 мкс
+    for (int i = 0; i < 10; ++i) h.record(1000000);    // 1 мс
+    h.record(50000000);                                // 50 мс
+
+    const uint64_t bounds[] = {5000, 50000, 2000000, 100000000};
+    uint64_t out[4];
+    h.cumulativeCounts(bounds, 4, out);
+
+    EXPECT_EQ(out[0], 0u);
+    EXPECT_EQ(out[1], 100u);
+    EXPECT_EQ(out[2], 110u);
+    EXPECT_EQ(out[3], 111u);
+    EXPECT_EQ(h.sumNs(), 100u * 10000 + 10u * 1000000 + 50000000u);
+}
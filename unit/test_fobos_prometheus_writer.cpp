@@ -0,0 +1,70 @@
+/**
+ * @file test_fobos_prometheus_writer.cpp
+ * @brief Unit тесты для записи метрик в текстовом формате Prometheus
+ *
+ * Тесты проверяют:
+ * - Заголовок семейства и строки значений с метками и без
+ * - Гистограмму: корзины с le, +Inf, _sum и _count
+ * - Обрезку при нехватке буфера
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "../libs/prometheus_writer.h"
+
+/**
+ * @test Семейство счётчиков: # HELP, # TYPE и строки с метками
+ */
+TEST(PrometheusWriterTest, FamilyAndSamples_TextFormat) {
+    char buf[512];
+    PrometheusWriter out(buf, sizeof(buf));
+
+    out.family("crsf_rx_frames_total", "counter", "Frames by type");
+    out.sample("crsf_rx_frames_total", "type=\"0x08\"", 12);
+    out.sample("crsf_rx_frames_total", nullptr, 3);
+    out.sampleInt("crsf_tx_queue_bytes", nullptr, -1);
+    out.sampleDouble("crsf_rc_period_seconds", "", 0.004);
+
+    EXPECT_TRUE(out.ok());
+    EXPECT_EQ(std::string(out.data(), out.size()),
+              "# HELP crsf_rx_frames_total Frames by type\n"
+              "# TYPE crsf_rx_frames_total counter\n"
+              "crsf_rx_frames_total{type=\"0x08\"} 12\n"
+              "crsf_rx_frames_total 3\n"
+              "crsf_tx_queue_bytes -1\n"
+              "crsf_rc_period_seconds 0.004\n");
+}
+
+/**
+ * @test Гистограмма: накопленные корзины, +Inf равна count, метки объединяются с le
+ */
+TEST(PrometheusWriterTest, Histogram_BucketsSumCount) {
+    char buf[1024];
+    PrometheusWriter out(buf, sizeof(buf));
+    const double bounds[] = {0.0005, 0.001};
+    const uint64_t cumulative[] = {4, 9};
+
+    out.histogram("lat_seconds", "stage=\"ipc\"", bounds, cumulative, 2, 10, 0.0125);
+
+    EXPECT_EQ(std::string(out.data(), out.size()),
+              "lat_seconds_bucket{stage=\"ipc\",le=\"0.0005\"} 4\n"
+              "lat_seconds_bucket{stage=\"ipc\",le=\"0.001\"} 9\n"
+              "lat_seconds_bucket{stage=\"ipc\",le=\"+Inf\"} 10\n"
+              "lat_seconds_sum{stage=\"ipc\"} 0.0125\n"
+              "lat_seconds_count{stage=\"ipc\"} 10\n");
+}
+
+/**
+ * @test Буфер кончился: ok() == false, запись не выходит за буфер
+ */
+TEST(PrometheusWriterTest, Overflow_ReportsError) {
+    char buf[16];
+    PrometheusWriter out(buf, sizeof(buf));
+
+    out.family("a_long_metric_name", "gauge", "help");
+
+    EXPECT_FALSE(out.ok());
+    EXPECT_EQ(out.size(), sizeof(buf));
+}
@@ -0,0 +1,205 @@
+/**
+ * @file test_fobos_rc_scheduler.cpp
+ * @brief Unit тесты для планировщика отправки RC-кадров
+ *
+ * Тесты проверяют:
+ * - Допустимый диапазон периода (50..1000 Гц)
+ * - Сдвиг дедлайна по сетке без накопления дрейфа
+ * - Учёт опоздания пробуждения (jitter)
+ * - Учёт пропущенных дедлайнов (overruns)
+ * - Фазовую подстройку по кадрам OPENTX_SYNC
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include "../libs/rc_scheduler.h"
+
+/**
+ * @test Проверка диапазона периода
+ *
+ * Период вне 1000..20000 мкс отклоняется, текущий период при этом не меняется.
+ */
+TEST(RcSchedulerTest, SetPeriod_OutOfRange_Rejected) {
+    // Arrange: планировщик на 250 Гц
+    RcScheduler sched(4000);
+
+    // Act & Assert: граничные и недопустимые значения
+    EXPECT_EQ(sched.getPeriodUs(), 4000u);
+    EXPECT_FALSE(sched.setPeriodUs(999));
+    EXPECT_FALSE(sched.setPeriodUs(20001));
+    EXPECT_EQ(sched.getPeriodUs(), 4000u);
+    EXPECT_TRUE(sched.setPeriodUs(RcScheduler::MIN_PERIOD_US));
+    EXPECT_TRUE(sched.setPeriodUs(RcScheduler::MAX_PERIOD_US));
+    EXPECT_EQ(sched.getPeriodUs(), RcScheduler::MAX_PERIOD_US);
+}
+
+/**
+ * @test Дедлайны идут по сетке независимо от опоздания
+ *
+ * Опоздание пробуждения не должно сдвигать следующий дедлайн:
+ * иначе реальный период дрейфует на величину опоздания каждого тика.
+ */
+TEST(RcSchedulerTest, OnWake_LateWakeup_DeadlineStaysOnGrid) {
+    // Arrange: 500 Гц, сетка от текущего момента
+    RcScheduler sched(2000);
+    sched.start();
+    uint64_t first = sched.nextDeadlineNs();
+
+    // Act: просыпаемся с опозданием 300 мкс
+    sched.onWake(first + 300000);
+
+    // Assert: следующий дедлайн ровно через период от предыдущего
+    EXPECT_EQ(sched.nextDeadlineNs(), first + 2000000);
+    EXPECT_EQ(sched.getStats().ticks, 1u);
+    EXPECT_EQ(sched.getStats().overruns, 0u);
+    EXPECT_EQ(sched.getStats().jitterLastNs, 300000);
+}
+
+/**
+ * @test Учёт статистики опоздания
+ *
+ * Минимум, максимум и сумма опозданий считаются по всем тикам.
+ */
+TEST(RcSchedulerTest, OnWake_MultipleTicks_TracksJitterMinMax) {
+    // Arrange
+    RcScheduler sched(1000);
+    sched.start();
+
+    // Act: три тика с разным опозданием
+    const int64_t lates[] = {50000, 10000, 120000};
+    for (int64_t late : lates) {
+        sched.onWake(sched.nextDeadlineNs() + late);
+    }
+
+    // Assert
+    const RcSchedulerStats& st = sched.getStats();
+    EXPECT_EQ(st.ticks, 3u);
+    EXPECT_EQ(st.jitterMinNs, 10000);
+    EXPECT_EQ(st.jitterMaxNs, 120000);
+    EXPECT_EQ(st.jitterSumNs, 180000u);
+}
+
+/**
+ * @test Пропуск дедлайнов при долгой задержке
+ *
+ * Если цикл простоял несколько периодов, пропущенные тики учитываются
+ * как overruns, а следующий дедлайн выбирается в будущем на той же сетке
+ * (без серии отправок подряд для "догоняния").
+ */
+TEST(RcSchedulerTest, OnWake_MissedPeriods_CountsOverrunsAndSkips) {
+    // Arrange: 250 Гц
+    RcScheduler sched(4000);
+    sched.start();
+    uint64_t first = sched.nextDeadlineNs();
+
+    // Act: просыпаемся через 2.5 периода после дедлайна
+    sched.onWake(first + 10000000);
+
+    // Assert: пропущено 2 дедлайна, следующий — третий по сетке после first
+    EXPECT_EQ(sched.getStats().overruns, 2u);
+    EXPECT_EQ(sched.nextDeadlineNs(), first + 3 * 4000000ull);
+    EXPECT_GT(sched.nextDeadlineNs(), first + 10000000);
+}
+
+/**
+ * @test Реальный сон до абсолютного дедлайна
+ *
+ * waitNext() не возвращается раньше дедлайна.
+ */
+TEST(RcSchedulerTest, WaitNext_SleepsUntilDeadline) {
+    // Arrange: 1000 Гц
+    RcScheduler sched(1000);
+    sched.start();
+    uint64_t deadline = sched.nextDeadlineNs();
+
+    // Act
+    sched.waitNext();
+
+    // Assert: проснулись не раньше дедлайна
+    EXPECT_GE(RcScheduler::nowNs(), deadline);
+    EXPECT_EQ(sched.getStats().ticks, 1u);
+}
+
+/**
+ * @test Подстройка периода и фазы по кадру синхронизации
+ *
+ * Интервал модуля заменяет настроенный период, а положительный сдвиг
+ * (RC-кадр пришёл слишком рано) переносит следующий дедлайн позже
+ * на половину сдвига.
+ */
+TEST(RcSchedulerTest, ApplySync_PositiveOffset_DelaysDeadline) {
+    // Arrange: настроено 100 Гц, модуль работает на 250 Гц
+    RcScheduler sched(10000);
+    sched.start();
+    uint64_t deadline = sched.nextDeadlineNs();
+
+    // Act: модуль сообщает интервал 4 мс и сдвиг +400 мкс
+    sched.applySync(4000000, 400000, deadline - 1000000);
+
+    // Assert
+    EXPECT_EQ(sched.getPeriodNs(), 4000000u);
+    EXPECT_EQ(sched.nextDeadlineNs(), deadline + 200000);
+    EXPECT_TRUE(sched.getStats().syncActive);
+    EXPECT_EQ(sched.getStats().syncFrames, 1u);
+    EXPECT_EQ(sched.getStats().syncOffsetNs, 400000);
+}
+
+/**
+ * @test Ограничение сдвига фазы полупериодом
+ *
+ * Одиночный выброс в кадре синхронизации не должен сдвигать сетку
+ * больше чем на половину периода.
+ */
+TEST(RcSchedulerTest, ApplySync_LargeNegativeOffset_ClampedToHalfPeriod) {
+    // Arrange
+    RcScheduler sched(2000);
+    sched.start();
+    uint64_t deadline = sched.nextDeadlineNs();
+
+    // Act: сдвиг -10 мс при интервале 2 мс
+    sched.applySync(2000000, -10000000, deadline);
+
+    // Assert: сдвиг ограничен -1 мс
+    EXPECT_EQ(sched.nextDeadlineNs(), deadline - 1000000);
+}
+
+/**
+ * @test Интервал вне диапазона игнорируется
+ */
+TEST(RcSchedulerTest, ApplySync_IntervalOutOfRange_Ignored) {
+    // Arrange
+    RcScheduler sched(4000);
+    sched.start();
+    uint64_t deadline = sched.nextDeadlineNs();
+
+    // Act: 40 мс (25 Гц) — ниже поддерживаемого диапазона
+    sched.applySync(40000000, 100000, deadline);
+
+    // Assert: ничего не изменилось
+    EXPECT_EQ(sched.getPeriodUs(), 4000u);
+    EXPECT_EQ(sched.nextDeadlineNs(), deadline);
+    EXPECT_FALSE(sched.getStats().syncActive);
+}
+
+/**
+ * @test Возврат к настроенному периоду при потере синхронизации
+ *
+ * Если кадры синхронизации перестали приходить дольше SYNC_TIMEOUT_NS,
+ * планировщик возвращается к периоду из конфигурации.
+ */
+TEST(RcSchedulerTest, OnWake_SyncTimeout_RestoresBasePeriod) {
+    // Arrange: синхронизировались на 500 Гц
+    RcScheduler sched(4000);
+    sched.start();
+    uint64_t t0 = sched.nextDeadlineNs();
+    sched.applySync(2000000, 0, t0);
+    ASSERT_EQ(sched.getPeriodNs(), 2000000u);
+
+    // Act: тик спустя больше таймаута без новых кадров
+    sched.onWake(t0 + RcScheduler::SYNC_TIMEOUT_NS + 1);
+
+    // Assert
+    EXPECT_FALSE(sched.getStats().syncActive);
+    EXPECT_EQ(sched.getPeriodUs(), 4000u);
+}
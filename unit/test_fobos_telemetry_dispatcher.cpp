@@ -0,0 +1,156 @@
+/**
+ * @file test_fobos_telemetry_dispatcher.cpp
+ * @brief Unit тесты для пакетной доставки кадров телеметрии
+ *
+ * Тесты проверяют:
+ * - Доставку кадров одной пачкой по заполнению и по максимальной задержке
+ * - Фильтр по подписанным типам кадров
+ * - Запуск без открытых сегментов
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../libs/telemetry_dispatcher.h"
+
+/**
+ * @class TelemetryDispatcherTest
+ * @brief Фикстура: снимок и история одного писателя, обработчик собирает пачки
+ */
+class TelemetryDispatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        shmName = "/crsf_dispatcher_test_" + std::to_string(getpid());
+        historyName = "/crsf_dispatcher_history_test_" + std::to_string(getpid());
+        TelemetryShm::unlink(shmName.c_str());
+        TelemetryHistory::unlink(historyName.c_str());
+        ASSERT_TRUE(shm.create(shmName.c_str(), sizeof(TelemetrySnapshot)));
+        ASSERT_TRUE(history.create(historyName.c_str(), 64));
+    }
+
+    void TearDown() override {
+        dispatcher.stop();
+        TelemetryShm::unlink(shmName.c_str());
+        TelemetryHistory::unlink(historyName.c_str());
+    }
+
+    // Кадр как в главном цикле: запись в историю, затем публикация снимка
+    void frame(uint32_t frameType, uint32_t n) {
+        TelemetrySnapshot s = {};
+        s.lastReceive = n;
+        history.append(s, frameType, n);
+        shm.publish(&s, frameType, n);
+    }
+
+    static void onBatch(const TelemetryHistoryRecord* records, size_t count, void* context) {
+        TelemetryDispatcherTest* self = static_cast<TelemetryDispatcherTest*>(context);
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->batches.emplace_back(records, records + count);
+        self->delivered += count;
+    }
+
+    // Дождаться доставки count кадров
+    bool waitDelivered(size_t count, int timeoutMs) {
+        for (int i = 0; i < timeoutMs && delivered.load() < count; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return delivered.load() >= count;
+    }
+
+    std::string shmName;
+    std::string historyName;
+    TelemetryShm shm;
+    TelemetryHistory history;
+    TelemetryDispatcher dispatcher;
+    std::mutex mutex;
+    std::vector<std::vector<TelemetryHistoryRecord>> batches;
+    std::atomic<size_t> delivered{0};
+};
+
+/**
+ * @test Заполненная пачка доставляется одним вызовом, не дожидаясь задержки
+ */
+TEST_F(TelemetryDispatcherTest, FullBatch_DeliveredInOneCall) {
+    // Arrange
+    dispatcher.setFrameType(TelemetryShm::ANY_FRAME, true);
+    dispatcher.setMaxBatch(8);
+    dispatcher.setMaxLatencyNs(10000000000ull);  // 10 с: доставка только по заполнению
+    ASSERT_TRUE(dispatcher.start(shm, history, &onBatch, this));
+
+    // Act
+    for (uint32_t i = 0; i < 8; ++i) {
+        frame(0x08, i);
+    }
+
+    // Assert
+    ASSERT_TRUE(waitDelivered(8, 2000));
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(batches.size(), 1u);
+    ASSERT_EQ(batches[0].size(), 8u);
+    EXPECT_EQ(batches[0][0].snapshot.lastReceive, 0u);
+    EXPECT_EQ(batches[0][7].snapshot.lastReceive, 7u);
+}
+
+/**
+ * @test Неполная пачка доставляется по истечении максимальной задержки
+ */
+TEST_F(TelemetryDispatcherTest, PartialBatch_DeliveredAfterMaxLatency) {
+    dispatcher.setFrameType(TelemetryShm::ANY_FRAME, true);
+    dispatcher.setMaxBatch(64);
+    dispatcher.setMaxLatencyNs(20000000ull);  // 20 мс
+    ASSERT_TRUE(dispatcher.start(shm, history, &onBatch, this));
+
+    auto begin = std::chrono::steady_clock::now();
+    frame(0x08, 1);
+    frame(0x1E, 2);
+    frame(0x08, 3);
+
+    ASSERT_TRUE(waitDelivered(3, 2000));
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(15));
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(batches.size(), 1u);
+}
+
+/**
+ * @test В пачку попадают только подписанные типы кадров
+ */
+TEST_F(TelemetryDispatcherTest, FrameTypeFilter_SkipsUnsubscribed) {
+    dispatcher.setFrameType(0x1E, true);
+    dispatcher.setMaxLatencyNs(5000000ull);
+    ASSERT_TRUE(dispatcher.start(shm, history, &onBatch, this));
+
+    frame(0x08, 1);
+    frame(0x1E, 2);
+    frame(0x14, 3);
+    frame(0x1E, 4);
+
+    ASSERT_TRUE(waitDelivered(2, 2000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(delivered.load(), 2u);
+    for (const auto& batch : batches) {
+        for (const TelemetryHistoryRecord& r : batch) {
+            EXPECT_EQ(r.frameType, 0x1Eu);
+        }
+    }
+}
+
+/**
+ * @test Без открытых сегментов или обработчика не запускается
+ */
+TEST_F(TelemetryDispatcherTest, Start_InvalidArguments_Fail) {
+    TelemetryShm closedShm;
+    TelemetryHistory closedHistory;
+    EXPECT_FALSE(dispatcher.start(closedShm, history, &onBatch, this));
+    EXPECT_FALSE(dispatcher.start(shm, closedHistory, &onBatch, this));
+    EXPECT_FALSE(dispatcher.start(shm, history, nullptr, this));
+    EXPECT_FALSE(dispatcher.isRunning());
+}
@@ -0,0 +1,135 @@
+/**
+ * @file test_fobos_telemetry_fanout.cpp
+ * @brief Unit тесты для рассылки телеметрии по UDP
+ *
+ * Тесты проверяют:
+ * - Разбор адресатов "адрес:порт" и лимит адресатов
+ * - Датаграмму telemetry_wire на каждую запись истории каждому адресату
+ * - Отказ отправки без открытого сокета
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../libs/telemetry_fanout.h"
+
+/**
+ * @class TelemetryFanoutTest
+ * @brief Фикстура: два приёмника UDP на 127.0.0.1 со свободными портами
+ */
+class TelemetryFanoutTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 2; ++i) {
+            rx[i] = socket(AF_INET, SOCK_DGRAM, 0);
+            ASSERT_GE(rx[i], 0);
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            ASSERT_EQ(bind(rx[i], reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+            socklen_t len = sizeof(addr);
+            getsockname(rx[i], reinterpret_cast<sockaddr*>(&addr), &len);
+            port[i] = ntohs(addr.sin_port);
+            timeval tv = {1, 0};
+            setsockopt(rx[i], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        }
+    }
+
+    void TearDown() override {
+        for (int fd : rx) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    std::string dest(int i) const {
+        return "127.0.0.1:" + std::to_string(port[i]);
+    }
+
+    int rx[2] = {-1, -1};
+    uint16_t port[2] = {0, 0};
+};
+
+/**
+ * @test Адресаты: IPv4 и порт принимаются, ошибки разбора и лишние адресаты — нет
+ */
+TEST_F(TelemetryFanoutTest, AddDestination_ParsesAndLimits) {
+    TelemetryFanout fanout;
+
+    EXPECT_TRUE(fanout.addDestination("127.0.0.1:5600"));
+    EXPECT_TRUE(fanout.addDestination("239.255.0.1:5601"));
+    EXPECT_FALSE(fanout.addDestination("127.0.0.1"));
+    EXPECT_FALSE(fanout.addDestination("127.0.0.1:0"));
+    EXPECT_FALSE(fanout.addDestination("127.0.0.1:70000"));
+    EXPECT_FALSE(fanout.addDestination("127.0.0.1:56x"));
+    EXPECT_FALSE(fanout.addDestination("groundstation:5600"));
+    EXPECT_FALSE(fanout.addDestination(":5600"));
+    EXPECT_EQ(fanout.destinationCount(), 2u);
+
+    while (fanout.destinationCount() < TelemetryFanout::MAX_DESTINATIONS) {
+        ASSERT_TRUE(fanout.addDestination("127.0.0.1:5600"));
+    }
+    EXPECT_FALSE(fanout.addDestination("127.0.0.1:5602"));
+}
+
+/**
+ * @test Каждая запись истории уходит каждому адресату отдельной датаграммой
+ */
+TEST_F(TelemetryFanoutTest, Send_Loopback_DatagramPerRecordPerDestination) {
+    // Arrange
+    TelemetryFanout fanout;
+    ASSERT_TRUE(fanout.addDestination(dest(0).c_str()));
+    ASSERT_TRUE(fanout.addDestination(dest(1).c_str()));
+    ASSERT_TRUE(fanout.open());
+    TelemetryHistoryRecord records[3] = {};
+    for (uint32_t i = 0; i < 3; ++i) {
+        records[i].pos = 100 + i;
+        records[i].timestampNs = 5000 + i;
+        records[i].frameType = 0x08 + i;
+        records[i].snapshot.channels[0] = static_cast<uint16_t>(1000 + i);
+    }
+
+    // Act
+    size_t sent = fanout.send(records, 3);
+
+    // Assert
+    EXPECT_EQ(sent, 6u);
+    EXPECT_EQ(fanout.sent(), 6u);
+    EXPECT_EQ(fanout.dropped(), 0u);
+    for (int r = 0; r < 2; ++r) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            uint8_t packet[TELEMETRY_WIRE_SIZE + 16];
+            ssize_t n = recv(rx[r], packet, sizeof(packet), 0);
+            ASSERT_EQ(n, static_cast<ssize_t>(TELEMETRY_WIRE_SIZE));
+            TelemetryWireHeader header;
+            TelemetrySnapshot snap;
+            ASSERT_TRUE(telemetryWireDecode(packet, static_cast<size_t>(n), &header, &snap));
+            EXPECT_EQ(header.seq, 100u + i);
+            EXPECT_EQ(header.timestampNs, 5000u + i);
+            EXPECT_EQ(header.frameType, 0x08u + i);
+            EXPECT_EQ(snap.channels[0], 1000 + i);
+        }
+    }
+}
+
+/**
+ * @test Без open() или без адресатов ничего не отправляется
+ */
+TEST_F(TelemetryFanoutTest, Send_NotOpenOrNoDestinations_SendsNothing) {
+    TelemetryHistoryRecord record = {};
+    TelemetryFanout fanout;
+    EXPECT_EQ(fanout.send(&record, 1), 0u);
+
+    ASSERT_TRUE(fanout.open());
+    EXPECT_EQ(fanout.send(&record, 1), 0u);
+
+    ASSERT_TRUE(fanout.addDestination(dest(0).c_str()));
+    EXPECT_EQ(fanout.send(&record, 1), 1u);
+    fanout.close();
+    EXPECT_FALSE(fanout.isOpen());
+    EXPECT_EQ(fanout.send(&record, 1), 0u);
+}
@@ -0,0 +1,255 @@
+/**
+ * @file test_fobos_telemetry_history.cpp
+ * @brief Unit тесты для истории телеметрии в разделяемой памяти
+ *
+ * Тесты проверяют:
+ * - Чтение всех записей после курсора одной пачкой
+ * - Пропуск вытесненных записей при отставании читателя
+ * - Продолжение позиций при повторном создании, пересоздание при смене ёмкости
+ * - Согласованность записей при одновременной записи и чтении
+ * - Прямой доступ к записям кольца по метке stamp
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../libs/telemetry_history.h"
+
+/**
+ * @class TelemetryHistoryTest
+ * @brief Фикстура: уникальное имя сегмента на процесс, удаление после теста
+ */
+class TelemetryHistoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name = "/crsf_history_test_" + std::to_string(getpid());
+        TelemetryHistory::unlink(name.c_str());
+    }
+
+    void TearDown() override {
+        TelemetryHistory::unlink(name.c_str());
+    }
+
+    // Снимок, все каналы и lastReceive которого равны номеру кадра — так видно "рваное" чтение
+    static TelemetrySnapshot frame(uint32_t n) {
+        TelemetrySnapshot s = {};
+        s.lastReceive = n;
+        for (uint16_t& ch : s.channels) ch = static_cast<uint16_t>(n);
+        return s;
+    }
+
+    std::string name;
+};
+
+/**
+ * @test Все записи после курсора читаются одной пачкой, курсор продвигается
+ */
+TEST_F(TelemetryHistoryTest, Read_SinceCursor_ReturnsBatch) {
+    // Arrange
+    TelemetryHistory writer;
+    TelemetryHistory reader;
+    ASSERT_TRUE(writer.create(name.c_str(), 16));
+    ASSERT_TRUE(reader.open(name.c_str()));
+
+    // Act
+    for (uint32_t i = 0; i < 5; ++i) {
+        writer.append(frame(i), 0x08 + i, 1000 + i);
+    }
+    TelemetryHistoryRecord out[16];
+    uint64_t next = 0;
+    uint64_t dropped = 1;
+    size_t n = reader.read(0, out, 16, &next, &dropped);
+
+    // Assert
+    ASSERT_EQ(n, 5u);
+    EXPECT_EQ(next, 5u);
+    EXPECT_EQ(dropped, 0u);
+    EXPECT_EQ(out[3].pos, 3u);
+    EXPECT_EQ(out[3].frameType, 0x0Bu);
+    EXPECT_EQ(out[3].timestampNs, 1003u);
+    EXPECT_EQ(out[3].snapshot.channels[7], 3);
+
+    // Новых записей нет — пустая пачка, курсор на месте
+    EXPECT_EQ(reader.read(next, out, 16, &next), 0u);
+    EXPECT_EQ(next, 5u);
+    EXPECT_EQ(reader.head(), 5u);
+}
+
+/**
+ * @test Отставший читатель получает только доступные записи и число пропущенных
+ */
+TEST_F(TelemetryHistoryTest, Read_ReaderOverrun_CountsDropped) {
+    TelemetryHistory writer;
+    ASSERT_TRUE(writer.create(name.c_str(), 8));
+    for (uint32_t i = 0; i < 20; ++i) {
+        writer.append(frame(i), 0x14, i);
+    }
+
+    TelemetryHistoryRecord out[8];
+    uint64_t next = 0;
+    uint64_t dropped = 0;
+    size_t n = writer.read(0, out, 8, &next, &dropped);
+
+    EXPECT_EQ(writer.tail(), 12u);
+    ASSERT_EQ(n, 8u);
+    EXPECT_EQ(dropped, 12u);
+    EXPECT_EQ(out[0].pos, 12u);
+    EXPECT_EQ(out[0].snapshot.lastReceive, 12u);
+    EXPECT_EQ(next, 20u);
+}
+
+/**
+ * @test Пачка ограничена maxRecords, остаток читается следующим вызовом
+ */
+TEST_F(TelemetryHistoryTest, Read_MaxRecords_ContinuesFromCursor) {
+    TelemetryHistory writer;
+    ASSERT_TRUE(writer.create(name.c_str(), 16));
+    for (uint32_t i = 0; i < 10; ++i) {
+        writer.append(frame(i), 0x08, i);
+    }
+
+    TelemetryHistoryRecord out[4];
+    uint64_t next = 0;
+    EXPECT_EQ(writer.read(0, out, 4, &next), 4u);
+    EXPECT_EQ(next, 4u);
+    EXPECT_EQ(writer.read(next, out, 4, &next), 4u);
+    EXPECT_EQ(out[0].pos, 4u);
+    EXPECT_EQ(writer.read(next, out, 4, &next), 2u);
+    EXPECT_EQ(next, 10u);
+}
+
+/**
+ * @test Повторное создание продолжает позиции, старые записи недоступны
+ */
+TEST_F(TelemetryHistoryTest, Create_ExistingSegment_KeepsPositions) {
+    {
+        TelemetryHistory writer;
+        ASSERT_TRUE(writer.create(name.c_str(), 8));
+        writer.append(frame(1), 0x08, 1);
+        writer.append(frame(2), 0x08, 2);
+    }
+
+    TelemetryHistory writer2;
+    ASSERT_TRUE(writer2.create(name.c_str(), 8));
+    EXPECT_EQ(writer2.head(), 2u);
+
+    TelemetryHistoryRecord out[8];
+    uint64_t next = 0;
+    uint64_t dropped = 0;
+    EXPECT_EQ(writer2.read(0, out, 8, &next, &dropped), 0u);
+    EXPECT_EQ(next, 2u);
+
+    writer2.append(frame(3), 0x08, 3);
+    ASSERT_EQ(writer2.read(next, out, 8, &next), 1u);
+    EXPECT_EQ(out[0].pos, 2u);
+    EXPECT_EQ(out[0].snapshot.lastReceive, 3u);
+}
+
+/**
+ * @test Смена ёмкости пересоздаёт сегмент: старый читатель не видит уменьшения, новый — с позиции 0
+ */
+TEST_F(TelemetryHistoryTest, Create_CapacityChanged_RecreatesSegment) {
+    TelemetryHistory reader;
+    {
+        TelemetryHistory writer;
+        ASSERT_TRUE(writer.create(name.c_str(), 16));
+        for (uint32_t i = 0; i < 5; ++i) writer.append(frame(i), 0x08, i);
+        ASSERT_TRUE(reader.open(name.c_str()));
+    }
+
+    TelemetryHistory writer2;
+    ASSERT_TRUE(writer2.create(name.c_str(), 8));
+    EXPECT_EQ(writer2.head(), 0u);
+    writer2.append(frame(7), 0x08, 7);
+
+    // Старое отображение цело: все 16 слотов доступны, новые записи туда не попадают
+    TelemetryHistoryRecord out[16];
+    uint64_t next = 0;
+    EXPECT_EQ(reader.read(0, out, 16, &next), 5u);
+    EXPECT_EQ(out[4].snapshot.lastReceive, 4u);
+    EXPECT_EQ(reader.head(), 5u);
+
+    TelemetryHistory reader2;
+    ASSERT_TRUE(reader2.open(name.c_str()));
+    ASSERT_EQ(reader2.read(0, out, 16, &next), 1u);
+    EXPECT_EQ(out[0].snapshot.lastReceive, 7u);
+}
+
+/**
+ * @test Ёмкость не степень двойки, отсутствующий сегмент
+ */
+TEST_F(TelemetryHistoryTest, CreateOpen_InvalidArguments_Fail) {
+    TelemetryHistory history;
+    EXPECT_FALSE(history.create(name.c_str(), 12));
+    EXPECT_FALSE(history.open(name.c_str()));
+
+    TelemetryHistoryRecord out[1];
+    uint64_t next = 7;
+    EXPECT_EQ(history.read(0, out, 1, &next), 0u);
+}
+
+/**
+ * @test Одновременная запись и чтение: каждая прочитанная запись целая, позиции возрастают
+ */
+TEST_F(TelemetryHistoryTest, ConcurrentAppend_ReaderSeesConsistentRecords) {
+    TelemetryHistory writer;
+    TelemetryHistory reader;
+    ASSERT_TRUE(writer.create(name.c_str(), 64));
+    ASSERT_TRUE(reader.open(name.c_str()));
+
+    const uint32_t total = 200000;
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < total; ++i) {
+            writer.append(frame(i), 0x08, i);
+        }
+    });
+
+    std::vector<TelemetryHistoryRecord> out(64);
+    uint64_t cursor = 0;
+    uint64_t received = 0;
+    uint64_t droppedTotal = 0;
+    bool consistent = true;
+    while (cursor < total) {
+        uint64_t dropped = 0;
+        size_t n = reader.read(cursor, out.data(), out.size(), &cursor, &dropped);
+        droppedTotal += dropped;
+        for (size_t i = 0; i < n; ++i) {
+            const TelemetryHistoryRecord& r = out[i];
+            if (r.snapshot.lastReceive != r.pos || r.timestampNs != r.pos ||
+                r.snapshot.channels[15] != static_cast<uint16_t>(r.pos)) {
+                consistent = false;
+            }
+        }
+        received += n;
+    }
+    producer.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(received + droppedTotal, total);
+}
+
+/**
+ * @test Прямой доступ к кольцу: запись позиции pos лежит в слоте pos & (capacity-1) с меткой 2*pos+2
+ */
+TEST_F(TelemetryHistoryTest, Entries_RawRing_StampMarksPosition) {
+    TelemetryHistory writer;
+    TelemetryHistory reader;
+    ASSERT_TRUE(writer.create(name.c_str(), 4));
+    ASSERT_TRUE(reader.open(name.c_str()));
+    for (uint32_t i = 0; i < 6; ++i) {
+        writer.append(frame(i), 0x1E, 100 + i);
+    }
+
+    const TelemetryHistoryEntry* entries = reader.entries();
+    ASSERT_NE(entries, nullptr);
+    EXPECT_EQ(entries[1].stamp.load(), 2u * 5 + 2);  // позиция 5 вытеснила позицию 1
+    EXPECT_EQ(entries[1].snapshot.lastReceive, 5u);
+    EXPECT_EQ(entries[1].timestampNs, 105u);
+    EXPECT_EQ(entries[2].stamp.load(), 2u * 2 + 2);
+    EXPECT_EQ(entries[2].frameType, 0x1Eu);
+}
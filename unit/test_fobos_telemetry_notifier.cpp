@@ -0,0 +1,96 @@
+/**
+ * @file test_fobos_telemetry_notifier.cpp
+ * @brief Unit тесты для уведомлений о публикациях телеметрии через eventfd
+ *
+ * Тесты проверяют:
+ * - Дескриптор становится читаемым после публикации и сбрасывается drain()
+ * - Фильтр по типу кадра
+ * - Запуск без открытого сегмента и остановку
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <poll.h>
+#include <unistd.h>
+#include "../libs/telemetry_notifier.h"
+
+/**
+ * @class TelemetryNotifierTest
+ * @brief Фикстура: писатель и читатель одного сегмента, уникальное имя на процесс
+ */
+class TelemetryNotifierTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name = "/crsf_notifier_test_" + std::to_string(getpid());
+        TelemetryShm::unlink(name.c_str());
+        ASSERT_TRUE(writer.create(name.c_str(), sizeof(payload)));
+        ASSERT_TRUE(reader.open(name.c_str(), sizeof(payload)));
+    }
+
+    void TearDown() override {
+        TelemetryShm::unlink(name.c_str());
+    }
+
+    // Дождаться готовности дескриптора к чтению
+    static bool readable(int fd, int timeoutMs) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        return poll(&pfd, 1, timeoutMs) == 1 && (pfd.revents & POLLIN);
+    }
+
+    std::string name;
+    uint64_t payload[4] = {};
+    TelemetryShm writer;
+    TelemetryShm reader;
+};
+
+/**
+ * @test Публикация делает дескриптор читаемым, drain() сбрасывает его
+ */
+TEST_F(TelemetryNotifierTest, Publish_MakesFdReadable_DrainResets) {
+    // Arrange
+    TelemetryNotifier notifier;
+    ASSERT_TRUE(notifier.start(reader));
+    ASSERT_GE(notifier.fd(), 0);
+    EXPECT_FALSE(readable(notifier.fd(), 0));
+
+    // Act
+    writer.publish(payload, 0x08, 1);
+
+    // Assert
+    ASSERT_TRUE(readable(notifier.fd(), 1000));
+    EXPECT_GE(notifier.drain(), 1u);
+    EXPECT_FALSE(readable(notifier.fd(), 0));
+    EXPECT_EQ(notifier.drain(), 0u);
+}
+
+/**
+ * @test Уведомитель по типу кадра не просыпается от кадров других типов
+ */
+TEST_F(TelemetryNotifierTest, FrameTypeFilter_IgnoresOtherFrames) {
+    TelemetryNotifier notifier;
+    ASSERT_TRUE(notifier.start(reader, 0x1E));
+
+    writer.publish(payload, 0x08, 1);
+    EXPECT_FALSE(readable(notifier.fd(), 50));
+
+    writer.publish(payload, 0x1E, 2);
+    EXPECT_TRUE(readable(notifier.fd(), 1000));
+}
+
+/**
+ * @test Без открытого сегмента не запускается; stop() закрывает дескриптор
+ */
+TEST_F(TelemetryNotifierTest, StartStop_Lifecycle) {
+    TelemetryShm closed;
+    TelemetryNotifier notifier;
+    EXPECT_FALSE(notifier.start(closed));
+    EXPECT_EQ(notifier.fd(), -1);
+
+    ASSERT_TRUE(notifier.start(reader));
+    EXPECT_TRUE(notifier.isRunning());
+    notifier.stop();
+    EXPECT_FALSE(notifier.isRunning());
+    EXPECT_EQ(notifier.fd(), -1);
+}
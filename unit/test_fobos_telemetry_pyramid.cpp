@@ -0,0 +1,145 @@
+/**
+ * @file test_fobos_telemetry_pyramid.cpp
+ * @brief Unit тесты для многоуровневой истории телеметрии веб-сервера
+ *
+ * Тесты проверяют:
+ * - Столбцы из схемы снимка: элементы массивов, поиск поля по имени
+ * - min/max/avg по корзинам подробного уровня
+ * - Ограничение числа точек: объединение корзин и переход на грубый уровень
+ * - Запрос старше подробного уровня читает грубый уровень
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include "../libs/telemetry_pyramid.h"
+
+/**
+ * @class TelemetryPyramidTest
+ * @brief Фикстура: корзины 10 нс, 3 уровня (10, 40, 160 нс) по 16 корзин
+ */
+class TelemetryPyramidTest : public ::testing::Test {
+protected:
+    TelemetryPyramidTest() : pyramid(10, 4, 3, 16) {}
+
+    // Снимок с напряжением v и первым каналом 1000 + v
+    static TelemetrySnapshot sample(double v) {
+        TelemetrySnapshot s = {};
+        s.voltage = v;
+        s.channels[0] = static_cast<uint16_t>(1000 + v);
+        return s;
+    }
+
+    uint16_t column(const char* name) const {
+        uint16_t c = 0;
+        EXPECT_EQ(pyramid.findColumns(name, strlen(name), &c, 1), 1u) << name;
+        return c;
+    }
+
+    TelemetryPyramid pyramid;
+    uint64_t times[64];
+    uint32_t counts[64];
+    TelemetryPyramidStats stats[64 * 2];
+};
+
+/**
+ * @test Столбцы: элемент массива — отдельный столбец, reserved* пропущены, поиск по имени
+ */
+TEST_F(TelemetryPyramidTest, Columns_FromSchema_FindByName) {
+    uint16_t cols[32];
+
+    EXPECT_EQ(pyramid.findColumns("channels", 8, cols, 32), 16u);
+    EXPECT_STREQ(pyramid.columnName(cols[3]), "channels[3]");
+    EXPECT_EQ(pyramid.findColumns("channels[3]", 11, cols, 32), 1u);
+    EXPECT_EQ(pyramid.findColumns("voltage", 7, cols, 32), 1u);
+    EXPECT_EQ(pyramid.findColumns("volt", 4, cols, 32), 0u);
+    EXPECT_EQ(pyramid.findColumns("reserved1", 9, cols, 32), 0u);
+    EXPECT_EQ(pyramid.columnCount(), TELEMETRY_FIELD_COUNT - 2 - 1 + 16);
+}
+
+/**
+ * @test Подробный уровень: min/max/avg и количество кадров по корзинам, пустые корзины пропущены
+ */
+TEST_F(TelemetryPyramidTest, Query_FineLevel_MinMaxAvg) {
+    // Arrange: корзина [100, 110) — 3 кадра, [110, 120) — пусто, [120, 130) — 1 кадр
+    pyramid.add(101, sample(10));
+    pyramid.add(104, sample(14));
+    pyramid.add(109, sample(12));
+    pyramid.add(125, sample(20));
+    uint16_t cols[2] = {column("voltage"), column("channels[0]")};
+    uint64_t resolution = 0;
+
+    // Act
+    size_t n = pyramid.query(0, 64, cols, 2, times, counts, stats, &resolution);
+
+    // Assert
+    ASSERT_EQ(n, 2u);
+    EXPECT_EQ(resolution, 10u);
+    EXPECT_EQ(times[0], 100u);
+    EXPECT_EQ(counts[0], 3u);
+    EXPECT_FLOAT_EQ(stats[0].min, 10.0f);
+    EXPECT_FLOAT_EQ(stats[0].max, 14.0f);
+    EXPECT_FLOAT_EQ(stats[0].avg, 12.0f);
+    EXPECT_FLOAT_EQ(stats[1].max, 1014.0f);
+    EXPECT_EQ(times[1], 120u);
+    EXPECT_EQ(counts[1], 1u);
+    EXPECT_FLOAT_EQ(stats[2].avg, 20.0f);
+
+    // since отсекает старые корзины
+    EXPECT_EQ(pyramid.query(115, 64, cols, 2, times, counts, stats, &resolution), 1u);
+    EXPECT_EQ(times[0], 120u);
+}
+
+/**
+ * @test Точек больше maxPoints: соседние корзины объединяются, при кратности — грубый уровень
+ */
+TEST_F(TelemetryPyramidTest, Query_MaxPoints_MergesAndUsesCoarserLevel) {
+    for (uint64_t t = 0; t < 160; ++t) {
+        pyramid.add(1000 + t, sample(static_cast<double>(t)));
+    }
+    uint16_t col = column("voltage");
+    uint64_t resolution = 0;
+
+    // 16 корзин по 10 нс в 8 точек: по 2 корзины на точку, уровень 0
+    size_t n = pyramid.query(0, 8, &col, 1, times, counts, stats, &resolution);
+    ASSERT_EQ(n, 8u);
+    EXPECT_EQ(resolution, 20u);
+    EXPECT_EQ(counts[0], 20u);
+    EXPECT_FLOAT_EQ(stats[0].min, 0.0f);
+    EXPECT_FLOAT_EQ(stats[0].max, 19.0f);
+    EXPECT_FLOAT_EQ(stats[7].avg, 149.5f);
+
+    // 4 точки — по 4 корзины, ровно корзина уровня 1 (40 нс)
+    n = pyramid.query(0, 4, &col, 1, times, counts, stats, &resolution);
+    ASSERT_EQ(n, 4u);
+    EXPECT_EQ(resolution, 40u);
+    uint32_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += counts[i];
+    EXPECT_EQ(total, 160u);
+    EXPECT_FLOAT_EQ(stats[3].max, 159.0f);
+}
+
+/**
+ * @test Начало запроса вытеснено из подробного уровня — ответ с грубого уровня
+ */
+TEST_F(TelemetryPyramidTest, Query_SinceOlderThanFineLevel_ReadsCoarseLevel) {
+    // 64 корзины уровня 0 при ёмкости 16: подробно хранятся только последние 160 нс
+    for (uint64_t t = 0; t < 640; t += 5) {
+        pyramid.add(t, sample(1.0));
+    }
+    uint16_t col = column("voltage");
+    uint64_t resolution = 0;
+
+    size_t n = pyramid.query(0, 64, &col, 1, times, counts, stats, &resolution);
+
+    EXPECT_EQ(resolution, 40u);
+    ASSERT_EQ(n, 16u);
+    EXPECT_EQ(times[0], 0u);
+    EXPECT_EQ(counts[0], 8u);
+
+    // Последние 100 нс есть в подробном уровне
+    n = pyramid.query(540, 64, &col, 1, times, counts, stats, &resolution);
+    EXPECT_EQ(resolution, 10u);
+    EXPECT_EQ(n, 10u);
+}
@@ -0,0 +1,227 @@
+/**
+ * @file test_fobos_telemetry_shm.cpp
+ * @brief Unit тесты для сегмента телеметрии в разделяемой памяти
+ *
+ * Тесты проверяют:
+ * - Публикацию и чтение снимка с метаданными
+ * - Отказ читателя при несовпадении размера снимка, хеша схемы или отсутствии сегмента
+ * - Чётность seqlock после публикации
+ * - Согласованность снимков при одновременной записи и чтении
+ * - Ожидание публикации кадра нужного типа (futex) и таймаут
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "../libs/telemetry_shm.h"
+
+// Тестовый снимок: все слова равны номеру публикации — так видно "рваное" чтение
+struct TestSnapshot {
+    uint64_t words[32];
+};
+
+/**
+ * @class TelemetryShmTest
+ * @brief Фикстура: уникальное имя сегмента на процесс, удаление после теста
+ */
+class TelemetryShmTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name = "/crsf_telemetry_test_" + std::to_string(getpid());
+        TelemetryShm::unlink(name.c_str());
+    }
+
+    void TearDown() override {
+        TelemetryShm::unlink(name.c_str());
+    }
+
+    static void fill(TestSnapshot& s, uint64_t v) {
+        for (uint64_t& w : s.words) w = v;
+    }
+
+    std::string name;
+};
+
+/**
+ * @test Публикация и чтение снимка
+ */
+TEST_F(TelemetryShmTest, PublishRead_RoundTrip_WithMeta) {
+    // Arrange
+    TelemetryShm writer;
+    TelemetryShm reader;
+    ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot)));
+    ASSERT_TRUE(reader.open(name.c_str(), sizeof(TestSnapshot)));
+
+    // Act
+    TestSnapshot in;
+    fill(in, 42);
+    writer.publish(&in, 0x1E, 123456789ull);
+
+    TestSnapshot out;
+    TelemetryShmMeta meta;
+    ASSERT_TRUE(reader.read(&out, &meta));
+
+    // Assert
+    EXPECT_EQ(out.words[0], 42u);
+    EXPECT_EQ(out.words[31], 42u);
+    EXPECT_EQ(meta.frameType, 0x1Eu);
+    EXPECT_EQ(meta.publishCount, 1u);
+    EXPECT_EQ(meta.publishNs, 123456789ull);
+    EXPECT_EQ(reader.sequence() % 2, 0u);
+}
+
+/**
+ * @test Читатель отклоняет сегмент с другим размером снимка
+ */
+TEST_F(TelemetryShmTest, Open_PayloadSizeMismatch_Rejected) {
+    TelemetryShm writer;
+    ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot)));
+
+    TelemetryShm reader;
+    EXPECT_FALSE(reader.open(name.c_str(), sizeof(TestSnapshot) + 8));
+    EXPECT_FALSE(reader.isOpen());
+}
+
+/**
+ * @test Читатель отклоняет сегмент другой схемы снимка (другая сборка писателя)
+ */
+TEST_F(TelemetryShmTest, Open_SchemaHashMismatch_Rejected) {
+    TelemetryShm writer;
+    ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot), 0x1111));
+
+    TelemetryShm reader;
+    EXPECT_FALSE(reader.open(name.c_str(), sizeof(TestSnapshot), 0x2222));
+    EXPECT_TRUE(reader.open(name.c_str(), sizeof(TestSnapshot), 0x1111));
+}
+
+/**
+ * @test Отсутствующий сегмент не открывается, чтение закрытого — false
+ */
+TEST_F(TelemetryShmTest, Open_MissingSegment_ReturnsFalse) {
+    TelemetryShm reader;
+    TestSnapshot out;
+    EXPECT_FALSE(reader.open(name.c_str(), sizeof(TestSnapshot)));
+    EXPECT_FALSE(reader.read(&out));
+}
+
+/**
+ * @test Повторное создание сегмента продолжает seqlock
+ *
+ * Читатель, открывший сегмент до перезапуска писателя, видит новые данные.
+ */
+TEST_F(TelemetryShmTest, Create_ExistingSegment_ReaderSeesNewWriter) {
+    TestSnapshot snap;
+    TelemetryShm reader;
+    {
+        TelemetryShm writer;
+        ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot)));
+        fill(snap, 1);
+        writer.publish(&snap, 0, 1);
+        ASSERT_TRUE(reader.open(name.c_str(), sizeof(TestSnapshot)));
+    }
+    uint32_t seqBefore = reader.sequence();
+
+    TelemetryShm writer2;
+    ASSERT_TRUE(writer2.create(name.c_str(), sizeof(TestSnapshot)));
+    fill(snap, 7);
+    writer2.publish(&snap, 0, 2);
+
+    TestSnapshot out;
+    ASSERT_TRUE(reader.read(&out));
+    EXPECT_EQ(out.words[5], 7u);
+    EXPECT_GT(reader.sequence(), seqBefore);
+}
+
+/**
+ * @test Одновременная запись и чтение не дают смешанных снимков
+ */
+TEST_F(TelemetryShmTest, ConcurrentPublish_ReaderNeverSeesTornSnapshot) {
+    TelemetryShm writer;
+    TelemetryShm reader;
+    ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot)));
+    ASSERT_TRUE(reader.open(name.c_str(), sizeof(TestSnapshot)));
+
+    std::atomic<bool> stop(false);
+    std::thread producer([&]() {
+        TestSnapshot s;
+        for (uint64_t v = 1; !stop.load(); ++v) {
+            fill(s, v);
+            writer.publish(&s, 0, v);
+        }
+    });
+
+    int torn = 0;
+    int reads = 0;
+    for (int i = 0; i < 20000; ++i) {
+        TestSnapshot out;
+        TelemetryShmMeta meta;
+        if (!reader.read(&out, &meta)) continue;
+        reads++;
+        for (uint64_t w : out.words) {
+            if (w != out.words[0]) { torn++; break; }
+        }
+        if (out.words[0] != meta.publishNs) torn++;
+    }
+    stop.store(true);
+    producer.join();
+
+    EXPECT_GT(reads, 0);
+    EXPECT_EQ(torn, 0);
+}
+
+/**
+ * @test Ожидание просыпается на публикации кадра нужного типа из другого потока
+ */
+TEST_F(TelemetryShmTest, WaitFrame_PublishMatchingType_WakesWaiter) {
+    TelemetryShm writer;
+    TelemetryShm reader;
+    ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot)));
+    ASSERT_TRUE(reader.open(name.c_str(), sizeof(TestSnapshot)));
+
+    uint32_t since = reader.frameCounter(0x08);
+    std::thread publisher([&]() {
+        TestSnapshot s;
+        fill(s, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writer.publish(&s, 0x14, 100);  // другой тип — ждущего не будит
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writer.publish(&s, 0x08, 200);
+    });
+
+    uint32_t counter = 0;
+    bool woke = reader.waitFrame(0x08, since, 5000000000ull, &counter);
+    publisher.join();
+
+    EXPECT_TRUE(woke);
+    EXPECT_EQ(counter, since + 1);
+    EXPECT_EQ(reader.frameCounter(0x14), 1u);
+    EXPECT_EQ(reader.frameCounter(TelemetryShm::ANY_FRAME), 2u);
+}
+
+/**
+ * @test Без публикации ожидание завершается по таймауту, изменённый счётчик — сразу
+ */
+TEST_F(TelemetryShmTest, WaitFrame_NoPublish_TimesOut) {
+    TelemetryShm writer;
+    ASSERT_TRUE(writer.create(name.c_str(), sizeof(TestSnapshot)));
+
+    uint32_t since = writer.frameCounter(TelemetryShm::ANY_FRAME);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(writer.waitFrame(TelemetryShm::ANY_FRAME, since, 20000000ull));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    TestSnapshot s;
+    fill(s, 1);
+    writer.publish(&s, 0, 1);
+    uint32_t counter = 0;
+    EXPECT_TRUE(writer.waitFrame(TelemetryShm::ANY_FRAME, since, 0, &counter));
+    EXPECT_EQ(counter, since + 1);
+
+    TelemetryShm closed;
+    EXPECT_FALSE(closed.waitFrame(TelemetryShm::ANY_FRAME, 0, 1000000ull));
+}
@@ -0,0 +1,97 @@
+/**
+ * @file test_fobos_telemetry_snapshot.cpp
+ * @brief Unit тесты для единой схемы снимка телеметрии
+ *
+ * Тесты проверяют:
+ * - Описание полей схемы: смещения, размеры, поиск по имени
+ * - Отсутствие перекрытий и выход полей за пределы снимка
+ * - Заполнение снимка из CrsfSerial
+ * - Маску изменившихся полей
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <cstring>
+#include "../libs/telemetry_snapshot.h"
+#include "../libs/crsf/CrsfSerial.h"
+#include "mocks/MockSerialPort.h"
+
+// Хеш схемы вычисляется при компиляции
+static_assert(TELEMETRY_SCHEMA_HASH != 0, "хеш схемы телеметрии");
+
+/**
+ * @test Поиск поля по имени возвращает смещение и размер из раскладки структуры
+ */
+TEST(TelemetrySnapshotTest, FindField_KnownFields_MatchLayout) {
+    const TelemetryFieldInfo* channels = telemetryFindField("channels");
+    ASSERT_NE(channels, nullptr);
+    EXPECT_EQ(channels->offset, offsetof(TelemetrySnapshot, channels));
+    EXPECT_EQ(channels->count, 16);
+    EXPECT_EQ(channels->type, TELEMETRY_U16);
+    EXPECT_EQ(channels->elemSize, 2);
+
+    const TelemetryFieldInfo* voltage = telemetryFindField("voltage");
+    ASSERT_NE(voltage, nullptr);
+    EXPECT_EQ(voltage->offset, offsetof(TelemetrySnapshot, voltage));
+    EXPECT_EQ(voltage->type, TELEMETRY_F64);
+
+    EXPECT_EQ(telemetryFindField("noSuchField"), nullptr);
+}
+
+/**
+ * @test Поля идут по возрастанию смещений, не перекрываются и лежат внутри снимка
+ */
+TEST(TelemetrySnapshotTest, Fields_OrderedWithoutOverlap) {
+    size_t end = 0;
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        const TelemetryFieldInfo& field = TELEMETRY_FIELDS[f];
+        EXPECT_GE(field.offset, end) << field.name;
+        EXPECT_EQ(field.offset % field.elemSize, 0u) << field.name;
+        end = field.offset + static_cast<size_t>(field.count) * field.elemSize;
+    }
+    EXPECT_LE(end, sizeof(TelemetrySnapshot));
+    EXPECT_EQ(sizeof(TelemetrySnapshot) % 64, 0u);
+}
+
+/**
+ * @test Заполнение снимка из CrsfSerial: связь, каналы, батарея
+ */
+TEST(TelemetrySnapshotTest, FillFrame_FromCrsfSerial_CopiesState) {
+    MockSerialPort serial;
+    CrsfSerial crsf(serial, 420000);
+    crsf.setChannel(1, 1500);
+    crsf.setChannel(16, 2000);
+
+    TelemetrySnapshot snapshot = {};
+    telemetryFillFrame(snapshot, crsf);
+
+    EXPECT_EQ(snapshot.channels[0], 1500);
+    EXPECT_EQ(snapshot.channels[15], 2000);
+    EXPECT_EQ(snapshot.linkUp, crsf.isLinkUp() ? 1 : 0);
+    EXPECT_DOUBLE_EQ(snapshot.voltage, crsf.getBatteryVoltage());
+    EXPECT_EQ(snapshot.remaining, crsf.getBatteryRemaining());
+}
+
+/**
+ * @test Маска изменений: только изменённые поля, одинаковые снимки — пустая маска
+ */
+TEST(TelemetrySnapshotTest, DiffFields_MarksChangedFieldsOnly) {
+    TelemetrySnapshot a = {};
+    TelemetrySnapshot b = {};
+    EXPECT_EQ(telemetryDiffFields(a, b), 0u);
+
+    b.voltage = 12.6;
+    b.channels[15] = 1500;
+    uint64_t mask = telemetryDiffFields(a, b);
+
+    uint64_t expected = 0;
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        if (strcmp(TELEMETRY_FIELDS[f].name, "voltage") == 0 || strcmp(TELEMETRY_FIELDS[f].name, "channels") == 0) {
+            expected |= 1ull << f;
+        }
+    }
+    EXPECT_EQ(mask, expected);
+    EXPECT_EQ(__builtin_popcountll(mask), 2);
+}
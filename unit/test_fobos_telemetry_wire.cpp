@@ -0,0 +1,83 @@
+/**
+ * @file test_fobos_telemetry_wire.cpp
+ * @brief Unit тесты для бинарного пакета телеметрии и дескриптора схемы
+ *
+ * Тесты проверяют:
+ * - Сборку и разбор пакета: заголовок и снимок без изменений
+ * - Отказ в разборе короткого пакета и пакета другой схемы
+ * - Дескриптор схемы: все поля со смещениями и типами
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include "../libs/telemetry_wire.h"
+
+/**
+ * @test Пакет: заголовок с номером публикации и снимок байт в байт
+ */
+TEST(TelemetryWireTest, EncodeDecode_RoundTrip) {
+    TelemetrySnapshot snap = {};
+    snap.voltage = 12.6;
+    snap.channels[3] = 1750;
+    snap.rcSyncOffsetUs = -42;
+    uint8_t packet[TELEMETRY_WIRE_SIZE];
+
+    size_t len = telemetryWireEncode(packet, snap, 1234, 987654321, 0x08);
+
+    ASSERT_EQ(len, TELEMETRY_WIRE_SIZE);
+    EXPECT_EQ(memcmp(packet + sizeof(TelemetryWireHeader), &snap, sizeof(snap)), 0);
+    TelemetryWireHeader header;
+    TelemetrySnapshot decoded;
+    ASSERT_TRUE(telemetryWireDecode(packet, len, &header, &decoded));
+    EXPECT_EQ(header.magic, TELEMETRY_WIRE_MAGIC);
+    EXPECT_EQ(header.schemaHash, TELEMETRY_SCHEMA_HASH);
+    EXPECT_EQ(header.seq, 1234u);
+    EXPECT_EQ(header.timestampNs, 987654321u);
+    EXPECT_EQ(header.frameType, 0x08u);
+    EXPECT_EQ(header.payloadSize, sizeof(TelemetrySnapshot));
+    EXPECT_EQ(decoded.channels[3], 1750);
+    EXPECT_EQ(decoded.voltage, 12.6);
+    EXPECT_EQ(decoded.rcSyncOffsetUs, -42);
+}
+
+/**
+ * @test Короткий пакет и пакет с другим хешем схемы не разбираются
+ */
+TEST(TelemetryWireTest, Decode_ShortOrForeignSchema_Rejected) {
+    TelemetrySnapshot snap = {};
+    uint8_t packet[TELEMETRY_WIRE_SIZE];
+    telemetryWireEncode(packet, snap, 1, 1, 0);
+
+    EXPECT_FALSE(telemetryWireDecode(packet, TELEMETRY_WIRE_SIZE - 1, nullptr, nullptr));
+
+    TelemetryWireHeader header;
+    memcpy(&header, packet, sizeof(header));
+    header.schemaHash ^= 1;
+    memcpy(packet, &header, sizeof(header));
+    EXPECT_FALSE(telemetryWireDecode(packet, TELEMETRY_WIRE_SIZE, nullptr, nullptr));
+}
+
+/**
+ * @test Дескриптор схемы перечисляет поля со смещениями, количеством и типами numpy
+ */
+TEST(TelemetryWireTest, SchemaJson_DescribesAllFields) {
+    char buf[8192];
+
+    size_t len = telemetrySchemaJson(buf, sizeof(buf));
+
+    ASSERT_GT(len, 0u);
+    std::string schema(buf, len);
+    EXPECT_NE(schema.find("\"snapshotSize\":256"), std::string::npos);
+    EXPECT_NE(schema.find("\"headerSize\":40"), std::string::npos);
+    EXPECT_NE(schema.find("{\"name\":\"channels\",\"offset\":8,\"count\":16,\"type\":\"uint16\"}"), std::string::npos);
+    EXPECT_NE(schema.find("{\"name\":\"latitude\",\"offset\":64,\"count\":1,\"type\":\"float64\"}"), std::string::npos);
+    for (size_t f = 0; f < TELEMETRY_FIELD_COUNT; ++f) {
+        EXPECT_NE(schema.find(std::string("\"") + TELEMETRY_FIELDS[f].name + "\""), std::string::npos);
+    }
+
+    // Буфер мал — 0, а не обрезанный JSON
+    EXPECT_EQ(telemetrySchemaJson(buf, 64), 0u);
+}